@@ -410,6 +410,45 @@ void lib_matrLXeqBMatCpx(int i_dim, fftw_complex **i_mat, fftw_complex **x_mat,
   }
 }
 
+/*FUNC*****************************************************************
+DESCRIPTION:
+
+Solves the set of i_dim linear equations L * x = b for complex numbers,
+where L is the Cholesky factor from 'lib_matrCholCpx'. Only forward
+substitution is done, as in lib_matrLXeqBMatCpx.
+
+Since A = L * L(adjoint), the quadratic form b(adjoint) * A^-1 * c equals
+(L^-1 b)(adjoint) * (L^-1 c), so the backward substitution of
+lib_matrAxeqbCpx may be avoided when only such products are needed.
+
+HOW TO USE THE FUNCTION:
+lib_matrLxeqbCpx(i_dim, i_mat, x_vec);
+
+SIDE-EFFECTS: The input-vector b is destroyed on output.
+
+RETURN VALUE: void.
+
+************************************************************************/
+
+void lib_matrLxeqbCpx(int i_dim, fftw_complex **i_mat, fftw_complex *x_vec)
+{
+  int l_i, l_j;
+  fftw_complex l_x;
+  float help;
+
+  for (l_i = 0; l_i < i_dim; l_i++) {
+    l_x.re = x_vec[l_i].re;
+    l_x.im = x_vec[l_i].im;
+    for (l_j = 0; l_j < l_i; l_j++) {
+      l_x.re -= (x_vec[l_j].re * i_mat[l_i][l_j].re - x_vec[l_j].im * i_mat[l_i][l_j].im);
+      l_x.im -= (x_vec[l_j].im * i_mat[l_i][l_j].re + x_vec[l_j].re * i_mat[l_i][l_j].im);
+    }
+    help = (i_mat[l_i][l_i].re*i_mat[l_i][l_i].re+i_mat[l_i][l_i].im*i_mat[l_i][l_i].im);
+    x_vec[l_i].re = (l_x.re*i_mat[l_i][l_i].re+l_x.im*i_mat[l_i][l_i].im)/help;
+    x_vec[l_i].im = (l_x.im*i_mat[l_i][l_i].re-l_x.re*i_mat[l_i][l_i].im)/help;
+  }
+}
+
 void lib_matrLXeqMatR(
                     int i_dim, /*The dimension of the equation system to solve. */
                     double **i_mat, /*The LU-decomp. of the A-matrix in the equation-system.*/
@@ -541,6 +580,37 @@ void lib_matrProdAdjointCpx(fftw_complex **mat1, fftw_complex **mat2, int n1,
     }
 }
 
+/*
+Calculate the n2 x n2 hermitian matrix product of the adjoint of a n1 x n2
+complex matrix with itself. Only the lower triangle is computed, the upper
+triangle is filled in by symmetry.
+*/
+void lib_matrProdAdjointSelfCpx(fftw_complex **mat, int n1, int n2, fftw_complex **outmat)
+{
+  int i, j, k;
+  fftw_complex x;
+  for(i=0;i<n2;i++)
+    for(j=0;j<=i;j++)
+    {
+      x.re = 0.0;
+      x.im = 0.0;
+      for(k=0;k<n1;k++)
+      {
+        x.re += mat[k][i].re*mat[k][j].re + mat[k][i].im*mat[k][j].im;
+        x.im += mat[k][i].re*mat[k][j].im - mat[k][i].im*mat[k][j].re;
+      }
+      outmat[i][j].re =  x.re;
+      outmat[j][i].re =  x.re;
+      if(i == j)
+        outmat[i][j].im = 0.0;
+      else
+      {
+        outmat[i][j].im =  x.im;
+        outmat[j][i].im = -x.im;
+      }
+    }
+}
+
 /*
 Calculate matrix product of a n1 x n2 and n2 x n3 complex matrix
 */
@@ -826,6 +896,27 @@ void lib_matrCopyCpx(fftw_complex **mat, int n1, int n2, fftw_complex **outmat)
 
 }
 
+/*
+Allocate a n1 x n2 complex matrix with all rows in one contiguous block,
+so that small matrices used in inner loops stay together in cache.
+Free with lib_matrFreeCpx.
+*/
+fftw_complex ** lib_matrAllocCpx(int n1, int n2)
+{
+  int i;
+  fftw_complex ** mat = (fftw_complex **) malloc(sizeof(fftw_complex *)*n1);
+  mat[0] = (fftw_complex *) malloc(sizeof(fftw_complex)*n1*n2);
+  for(i=1;i<n1;i++)
+    mat[i] = mat[0] + i*n2;
+  return(mat);
+}
+
+void lib_matrFreeCpx(fftw_complex **mat)
+{
+  free(mat[0]);
+  free(mat);
+}
+
 void lib_matrFillOnesVecCpx(fftw_complex* v1, int n1)
 {
   int i;
@@ -17,6 +17,7 @@ extern "C"
   extern void lib_matrAxeqbCpx(int i_dim, fftw_complex **i_mat,fftw_complex *x_vec);
   extern void lib_matrAXeqBMatCpx(int i_dim, fftw_complex **i_mat, fftw_complex **x_mat, int n);
   extern void lib_matrLXeqBMatCpx(int i_dim, fftw_complex **i_mat, fftw_complex **x_mat, int n);
+  extern void lib_matrLxeqbCpx(int i_dim, fftw_complex **i_mat, fftw_complex *x_vec);
   extern void lib_matrLXeqMatR(int i_dim, double **i_mat, double **x_mat, int n);
 
   extern void lib_matrProdCholVec(int n, fftw_complex ** mat, fftw_complex * vec);
@@ -27,6 +28,7 @@ extern "C"
 
   extern void lib_matrProdCpx(fftw_complex **mat1, fftw_complex **mat2, int n1, int n2, int n3, fftw_complex **outmat);
   extern void lib_matrProdAdjointCpx(fftw_complex **mat1, fftw_complex **mat2, int n1, int n2, int n3, fftw_complex **outmat);
+  extern void lib_matrProdAdjointSelfCpx(fftw_complex **mat, int n1, int n2, fftw_complex **outmat);
   extern void lib_matrProdCpxR(fftw_complex **mat1, float **mat2, int n1, int n2, int n3, fftw_complex **outmat);
   extern void lib_matrProdRCpx(float **mat1, fftw_complex **mat2, int n1, int n2, int n3, fftw_complex **outmat);
   extern void lib_matrProdDiagCpxR(fftw_complex *mat1, float **mat2, int n1,int n2, fftw_complex **outmat);
@@ -48,6 +50,9 @@ extern "C"
   extern void lib_matrSubtMat(double **x, int n1, int n2, double **y);
   extern void lib_matrCopy(double **mat, int n1, int n2, double **outmat);
 
+  extern fftw_complex ** lib_matrAllocCpx(int n1, int n2);
+  extern void lib_matrFreeCpx(fftw_complex **mat);
+
   extern void lib_matrFillOnesVecCpx(fftw_complex* v1, int n1);
   extern void lib_matrFillValueVecCpx(fftw_complex value,fftw_complex* v1, int n1);
 
@@ -26,6 +26,18 @@ RandomGen::RandomGen(const std::string & filename)
   file.close();
 }
 
+//
+// The period of the generator is split in nStreams+1 parts. Stream number i
+// starts at part i, counted from the state of the given generator. The last
+// part is left for the generator itself, see skipStreams().
+//
+RandomGen::RandomGen(const RandomGen & generator, unsigned int stream, unsigned int nStreams)
+{
+  seed_     = generator.seed_;
+  seedfile_ = "";
+  jumpAhead(stream*streamLength(nStreams));
+}
+
 RandomGen::~RandomGen()
 {
   if(seedfile_ != "")
@@ -118,6 +130,32 @@ double RandomGen::unif01()
   return x;
 }
 
+void RandomGen::jumpAhead(unsigned int nSteps)
+{
+  // Compose the step x -> MULTIPLIER*x + SHIFT with itself by repeated squaring.
+  unsigned int aStep = MULTIPLIER;
+  unsigned int cStep = SHIFT;
+  unsigned int aJump = 1;
+  unsigned int cJump = 0;
+  while(nSteps > 0)
+  {
+    if(nSteps & 1)
+    {
+      aJump = aStep*aJump;
+      cJump = aStep*cJump + cStep;
+    }
+    cStep = (aStep + 1)*cStep;
+    aStep = aStep*aStep;
+    nSteps >>= 1;
+  }
+  seed_ = aJump*seed_ + cJump;
+}
+
+void RandomGen::skipStreams(unsigned int nStreams)
+{
+  jumpAhead(nStreams*streamLength(nStreams));
+}
+
 int RandomGen::writeSeedFile(const std::string & filename) const
 {
   FILE *file;
@@ -132,5 +170,3 @@ int RandomGen::writeSeedFile(const std::string & filename) const
   }
   return(error);
 }
-
-unsigned int RandomGen::seed_ = 23665; //Default seed
@@ -18,17 +18,22 @@ class RandomGen{
 public:
   RandomGen(unsigned int seed);
   RandomGen(const std::string & filename); //NB: Validity of filename must be externally checked
+  RandomGen(const RandomGen & generator, unsigned int stream, unsigned int nStreams); //Stream number stream of nStreams disjoint streams from generator
   ~RandomGen();
 
   int writeSeedFile(const std::string & filename) const;
 
-  static double rnorm01();
-  static double unif01();
+  void          jumpAhead(unsigned int nSteps);     // Same as nSteps calls to unif01()
+  void          skipStreams(unsigned int nStreams); // Moves generator past the nStreams streams made from it
+
+  double        rnorm01();
+  double        unif01();
 
 private:
-  static double g(double x);
+  static double       g(double x);
+  static unsigned int streamLength(unsigned int nStreams) { return 0xffffffffu/(nStreams + 1) ;}
 
-  static unsigned int seed_;
+  unsigned int        seed_;      // State is kept per generator, so that generators may be used in parallel
   std::string         seedfile_;
 
 };
@@ -161,8 +161,15 @@ Utils::writeMatrix(double ** matrix,
 void
 Utils::fft(fftw_real* rAmp,fftw_complex* cAmp,int nt)
 {
-  rfftwnd_plan p1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  rfftwnd_plan p1;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  p1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
   rfftwnd_one_real_to_complex(p1, rAmp, cAmp);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   fftwnd_destroy_plan(p1);
 }
 
@@ -170,8 +177,15 @@ Utils::fft(fftw_real* rAmp,fftw_complex* cAmp,int nt)
 void
 Utils::fftInv(fftw_complex* cAmp,fftw_real* rAmp,int nt)
 {
-  rfftwnd_plan p2 = rfftwnd_create_plan(1, &nt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  rfftwnd_plan p2;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  p2 = rfftwnd_create_plan(1, &nt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
   rfftwnd_one_complex_to_real(p2, cAmp, rAmp);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   fftwnd_destroy_plan(p2);
   double sf = 1.0/double(nt);
   for(int i=0;i<nt;i++)
@@ -247,6 +261,37 @@ void
 Utils::ShiftTrace(fftw_real * trace,
                   size_t      n_data,
                   bool        shift_up)
+{
+  int          n_small = static_cast<int>(2*n_data);
+  int          n_large = 2*n_small;
+  rfftwnd_plan fft_plan;
+  rfftwnd_plan fft_inv_plan;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fft_plan     = rfftwnd_create_plan(1, &n_small, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    fft_inv_plan = rfftwnd_create_plan(1, &n_large, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  }
+
+  ShiftTrace(trace, n_data, fft_plan, fft_inv_plan, shift_up);
+
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(fft_plan);
+    fftwnd_destroy_plan(fft_inv_plan);
+  }
+}
+
+
+void
+Utils::ShiftTrace(fftw_real    * trace,
+                  size_t         n_data,
+                  rfftwnd_plan   fft_plan,
+                  rfftwnd_plan   fft_inv_plan,
+                  bool           shift_up)
 {
   size_t n_small   = 2*n_data;
   size_t fft_small = ((n_small / 2) + 1)*2;
@@ -266,14 +311,17 @@ Utils::ShiftTrace(fftw_real * trace,
   for(;i<n_small;i++)
     s_trace[i] = s_trace[0]*static_cast<fftw_real>((1+cos(NRLib::Pi*static_cast<double>(n_small-1-i)/static_cast<double>(n_small-1-change)))); //H
 
-  Utils::fft(&(s_trace[0]), s_trace_c, static_cast<int>(n_small));
+  rfftwnd_one_real_to_complex(fft_plan, &(s_trace[0]), s_trace_c);
 
   std::vector<fftw_real> l_trace(fft_large,0);
   fftw_complex * l_trace_c = reinterpret_cast<fftw_complex*>(&(l_trace[0]));
   for(i=0;i<fft_small;i++)
     l_trace[i] = s_trace[i];
 
-  Utils::fftInv(l_trace_c,&(l_trace[0]), static_cast<int>(n_large));
+  rfftwnd_one_complex_to_real(fft_inv_plan, l_trace_c, &(l_trace[0]));
+  fftw_real sf = static_cast<fftw_real>(1.0/static_cast<double>(n_large));
+  for(i=0;i<n_large;i++)
+    l_trace[i] *= sf;
 
   if(shift_up == true){
     for(i=0;i<n_data;i++)
@@ -9,6 +9,7 @@
 #include "src/definitions.h"
 #include "nrlib/iotools/logkit.hpp"
 #include "fftw.h"
+#include "rfftw.h"
 
 
 class Utils
@@ -73,6 +74,14 @@ public:
                              size_t      n_data,
                              bool        shift_up = true);
 
+  //As above, with plans from rfftwnd_create_plan of length 2*n_data (forward) and 4*n_data (inverse).
+  //Lets a caller shifting many traces of the same length make the plans once.
+  static void     ShiftTrace(fftw_real    * trace,
+                             size_t         n_data,
+                             rfftwnd_plan   fft_plan,
+                             rfftwnd_plan   fft_inv_plan,
+                             bool           shift_up = true);
+
 };
 
 #endif
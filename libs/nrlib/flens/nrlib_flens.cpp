@@ -142,6 +142,39 @@ void NRLib::CholeskyFactorize(SymmetricMatrix & A)
 
 }
 
+void NRLib::CholeskySolveFactorized(const SymmetricMatrix & L,
+                                    const Vector          & b,
+                                    Vector                & x)
+{
+  Matrix B(b.length(), 1);
+  B(flens::_, 0) = b;
+
+  // potrs only reads the factor.
+  int info = flens::potrs(L.upLo(), L.dim(), B.numCols(),
+                          const_cast<double *>(L.data()), L.leadingDimension(),
+                          B.data(), B.leadingDimension());
+  if (info != 0) {
+    std::ostringstream oss;
+    oss << "Internal FLENS/Lapack error: Error in argument " << -info
+        << " of potrs call.";
+    throw Exception(oss.str());
+  }
+
+  x = B(flens::_, 0);
+}
+
+void NRLib::CholeskyForwardSolve(const SymmetricMatrix & L,
+                                 Matrix                & B)
+{
+  // For a lower factor, A = L L^T and the system to solve is L X = B.
+  flens::Transpose trans = (L.upLo() == flens::Upper ? flens::Trans : flens::NoTrans);
+
+  flens::trsm(flens::ColMajor, flens::Left, L.upLo(), trans, flens::NonUnit,
+              B.numRows(), B.numCols(), 1.0,
+              L.data(), L.leadingDimension(),
+              B.data(), B.leadingDimension());
+}
+
 
 
 void NRLib::ComputeEigenVectorsSymmetric(const SymmetricMatrix & A,
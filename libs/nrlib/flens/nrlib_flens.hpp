@@ -96,6 +96,17 @@ namespace NRLib {
 
   void CholeskyFactorize(SymmetricMatrix & A);
 
+  /// \brief Solves Ax = b, where L holds the Cholesky factor of A as
+  ///        returned by CholeskyFactorize.
+  void CholeskySolveFactorized(const SymmetricMatrix & L,
+                               const Vector          & b,
+                               Vector                & x);
+
+  /// \brief Replaces B by X = inv(U^T) B, where L holds the Cholesky factor
+  ///        A = U^T U as returned by CholeskyFactorize. Then B^T inv(A) B = X^T X.
+  void CholeskyForwardSolve(const SymmetricMatrix & L,
+                            Matrix                & B);
+
 
   void ComputeEigenVectors(Matrix & A,
                            Vector & eigen_values,
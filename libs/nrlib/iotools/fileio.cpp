@@ -27,6 +27,7 @@
 #define BOOST_FILESYSTEM_VERSION 2
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <locale>
@@ -336,6 +337,17 @@ NRLib::FindFileSize(const std::string& filename)
 }
 
 
+long long
+NRLib::FindFileModificationTime(const std::string& filename)
+{
+  if ( !boost::filesystem::exists(filename) ) {
+    throw IOError("File " + filename + " does not exist.");
+  }
+
+  return static_cast<long long>(boost::filesystem::last_write_time(filename));
+}
+
+
 int NRLib::FindGridFileType(const std::string& filename )
 {
   unsigned long long length = FindFileSize(filename);
@@ -565,6 +577,64 @@ float NRLib::ReadBinaryFloat(std::istream& stream,
 }
 
 
+static NRLib::Endianess MachineEndianess()
+{
+  FloatAsInt tmp;
+  tmp.ui = 1;
+  const char* bytes = reinterpret_cast<const char*>(&tmp.ui);
+  return (bytes[0] == 1 ? END_LITTLE_ENDIAN : END_BIG_ENDIAN);
+}
+
+
+void NRLib::WriteBinaryFloatBuffer(std::ostream& stream,
+                                   const float* data,
+                                   size_t n,
+                                   Endianess number_representation)
+{
+  if (number_representation == MachineEndianess()) {
+    if (!stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(4*n))) {
+      throw Exception("Error writing to stream.");
+    }
+    return;
+  }
+
+  // Converted through a buffer of bounded size.
+  const size_t chunk = 65536;
+  std::vector<char> buffer(4*std::min(n, chunk));
+  for (size_t first = 0; first < n; first += chunk) {
+    size_t n_chunk = std::min(n - first, chunk);
+    for (size_t i = 0; i < n_chunk; ++i) {
+      if (number_representation == END_BIG_ENDIAN)
+        WriteIEEEFloatBE(&buffer[4*i], data[first + i]);
+      else
+        WriteIEEEFloatLE(&buffer[4*i], data[first + i]);
+    }
+    if (!stream.write(&buffer[0], static_cast<std::streamsize>(4*n_chunk))) {
+      throw Exception("Error writing to stream.");
+    }
+  }
+}
+
+
+void NRLib::ReadBinaryFloatBuffer(std::istream& stream,
+                                  float* data,
+                                  size_t n,
+                                  Endianess number_representation)
+{
+  if (!stream.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(4*n))) {
+    throw Exception("Error reading from stream.");
+  }
+
+  if (number_representation != MachineEndianess()) {
+    char* bytes = reinterpret_cast<char*>(data);
+    for (size_t i = 0; i < n; ++i) {
+      std::swap(bytes[4*i],     bytes[4*i + 3]);
+      std::swap(bytes[4*i + 1], bytes[4*i + 2]);
+    }
+  }
+}
+
+
 void NRLib::WriteBinaryDouble(std::ostream& stream,
                                double d,
                                Endianess file_format)
@@ -77,6 +77,10 @@ namespace NRLib {
   /// \return Size of file in bytes.
   unsigned long long FindFileSize(const std::string & filename);
 
+  /// \brief Finds the last modification time of a file. Throws IOError if file not found.
+  /// \return Seconds since the epoch.
+  long long FindFileModificationTime(const std::string & filename);
+
   /// \brief Find type of file, for 3D grid files.
   /// \todo Move to a suitable place.
   int FindGridFileType(const std::string& filename);
@@ -258,6 +262,22 @@ namespace NRLib {
                          size_t n,
                          Endianess number_representation = END_BIG_ENDIAN);
 
+  /// \brief Write n 4-byte floats from contiguous memory on standard IEEE format.
+  /// \note  When the number representation is that of the machine, the memory
+  ///        is written as it is, in a single write.
+  void WriteBinaryFloatBuffer(std::ostream& stream,
+                              const float* data,
+                              size_t n,
+                              Endianess number_representation = END_BIG_ENDIAN);
+
+  /// \brief Read n 4-byte floats on standard IEEE format into contiguous memory.
+  /// \note  When the number representation is that of the machine, the values
+  ///        are read straight into data, in a single read.
+  void ReadBinaryFloatBuffer(std::istream& stream,
+                             float* data,
+                             size_t n,
+                             Endianess number_representation = END_BIG_ENDIAN);
+
   // ---------------------------------
   // 8-byte IEEE floating point number
   // ---------------------------------
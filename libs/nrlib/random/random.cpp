@@ -32,6 +32,7 @@ bool          Random::is_initialized_ = false;
 unsigned long Random::start_seed_     = 0;
 bool          Random::use_seed_file_  = false;
 std::string   Random::seed_file_      = "";
+dsfmt_t     * Random::state_          = &dsfmt_global_data;
 
 void Random::Initialize() {
   unsigned long seed = static_cast<unsigned long>(time(0));
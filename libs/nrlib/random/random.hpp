@@ -25,12 +25,19 @@
 #include <string>
 
 #include "dSFMT.h"
+#include "randomgenerator.hpp"
 
 namespace NRLib {
 
 /// Random generator class based on the Mersenne-Twister random
 /// number generator.
 /// Always initialize before use!
+///
+/// By default all threads draw from one global generator. To get reproducible
+/// numbers from parallel code, give each logical work item its own
+/// RandomGenerator, initialized with Initialize(seed, stream), and draw from it
+/// through a StreamScope. The numbers then depend on the work item only, not on
+/// the thread that happens to run it.
 class Random {
 public:
   ///Initializes with current time
@@ -41,13 +48,13 @@ public:
   static void Initialize(const std::string& seed_file_);
 
   /// \return uniform number in [0,1)
-  static double Unif01()             { return dsfmt_gv_genrand_close_open(); }
+  static double Unif01()             { return dsfmt_genrand_close_open(state_); }
 
   /// \return uniform number in (0,1)
-  static double Unif01Open()             { return dsfmt_gv_genrand_open_open(); }
+  static double Unif01Open()             { return dsfmt_genrand_open_open(state_); }
 
   /// \return unsigned 32-bit integer betwen 0 and 0xFFFFFFFF
-  static unsigned long DrawUint32()  { return dsfmt_gv_genrand_uint32(); }
+  static unsigned long DrawUint32()  { return dsfmt_genrand_uint32(state_); }
 
   /// Marsaglia-Bray's method, see Ripley, p. 84.
   static double Norm01();
@@ -58,6 +65,22 @@ public:
   /// Writes seed to file if seed-file is used.
   static void WriteSeedToFile();
 
+  /// While an object of this class exists, the static draw functions called
+  /// from the constructing thread take their numbers from the given generator
+  /// instead of the global one. Scopes may be nested.
+  class StreamScope {
+  public:
+    explicit StreamScope(RandomGenerator & generator)
+      : previous_(state_) { state_ = &generator.dsfmt; }
+    ~StreamScope()        { state_ = previous_; }
+
+  private:
+    StreamScope(const StreamScope &);
+    StreamScope & operator=(const StreamScope &);
+
+    dsfmt_t * previous_;
+  };
+
 private:
   /// Support function for Norm01
   static double g(double x);
@@ -71,6 +94,13 @@ private:
   static bool use_seed_file_;
 
   static std::string seed_file_;
+
+  /// State drawn from by the calling thread. Points to the global state
+  /// unless a StreamScope is active.
+  static dsfmt_t * state_;
+#ifdef PARALLEL
+#pragma omp threadprivate(state_)
+#endif
 };
 
 }
@@ -58,6 +58,23 @@ RandomGenerator::Initialize(unsigned long int seed)
   InitializeMT(start_seed_);
 }
 
+void
+RandomGenerator::Initialize(unsigned long seed,
+                            unsigned long stream)
+{
+  // The seed and the stream number together make up the initialization key,
+  // which gives well separated generator states for neighbouring streams.
+  uint32_t key[4];
+  key[0] = static_cast<uint32_t>(seed   & 0xffffffffUL);
+  key[1] = static_cast<uint32_t>((seed   >> 16) >> 16);
+  key[2] = static_cast<uint32_t>(stream & 0xffffffffUL);
+  key[3] = static_cast<uint32_t>((stream >> 16) >> 16);
+
+  start_seed_ = seed;
+  is_initialized_ = true;
+  dsfmt_init_by_array(&dsfmt, key, 4);
+}
+
 
 double
 RandomGenerator::Norm01()
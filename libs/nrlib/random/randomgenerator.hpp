@@ -36,6 +36,11 @@ public:
 
   void Initialize(unsigned long seed);
 
+  /// Initializes stream number stream of the given seed. Different streams of
+  /// the same seed are independent, so they can be given to work items that
+  /// are drawn from in parallel.
+  void Initialize(unsigned long seed, unsigned long stream);
+
   /// \return unsigned 32-bit integer betwen 0 and 0xFFFFFFFF
   unsigned long DrawUint32()  { return dsfmt_genrand_uint32(&dsfmt); }
 
@@ -52,6 +57,8 @@ public:
   unsigned long GetStartSeed();
 
 private:
+  friend class Random;
+
   /// RNG state
   dsfmt_t dsfmt;
 
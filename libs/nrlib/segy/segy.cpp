@@ -34,6 +34,10 @@
 #include <list>
 #include <map>
 
+#ifdef PARALLEL
+#include <omp.h>
+#endif
+
 #include "segy.hpp"
 #include "commonheaders.hpp"
 #include "traceheader.hpp"
@@ -49,6 +53,8 @@ const float segyRMISSING = -99999.000;
 
 using namespace NRLib;
 
+bool SegY::use_trace_index_ = false;
+
 
 SegY::SegY(const std::string       & fileName,
            float                     z0,
@@ -319,6 +325,112 @@ SegY::SegY(const std::string       & fileName,
   }
 }
 
+/// Traces of a StormContGrid, sampled regularly in z. Trace t is cell (t % nx, t / nx) of the grid,
+/// and is placed by the geometry.
+class StormTraceSource : public SegY::TraceSource
+{
+public:
+  StormTraceSource(const StormContGrid  * storm_grid,
+                   const SegyGeometry   * geometry,
+                   float                  z0,
+                   float                  dz,
+                   int                    nz,
+                   bool                   is_seismic)
+    : storm_grid_(storm_grid),
+      geometry_(geometry),
+      nx_(storm_grid->GetNI()),
+      ny_(storm_grid->GetNJ()),
+      z0_(z0),
+      dz_(dz),
+      nz_(nz),
+      z_shift_(is_seismic ? 0 : 0.5*dz),
+      max_end_data_(nz)
+  {
+  }
+
+  /// Largest number of samples a trace needed. Larger than nz if data were truncated.
+  int GetMaxEndData() const
+  {
+    return max_end_data_;
+  }
+
+  size_t GetNTraces() const
+  {
+    return nx_*ny_;
+  }
+
+  void GetPosition(size_t t, double & x, double & y) const
+  {
+    float xf, yf;
+    FindPosition(t, xf, yf);
+    x = xf;
+    y = yf;
+  }
+
+  void GetTrace(size_t t, std::vector<float> & data_vec) const
+  {
+    int   k;
+    float x, y, z;
+    FindPosition(t, x, y);
+
+    double z_bot = storm_grid_->GetBotSurface().GetZ(x,y);
+    double z_top = storm_grid_->GetTopSurface().GetZ(x,y);
+
+    if (!storm_grid_->GetTopSurface().IsMissing(z_top) && !storm_grid_->GetBotSurface().IsMissing(z_bot)) {
+      z_bot         -= z0_;
+      z_top         -= z0_;
+      int first_data = static_cast<int>(floor((z_top+z_shift_)/dz_));
+      int end_data   = static_cast<int>(floor((z_bot-z_shift_)/dz_));
+
+      if (end_data > nz_) {
+        // Traces may be made on several threads, so this is reported once by the caller.
+#ifdef PARALLEL
+#pragma omp critical(segy_storm_trace_truncation)
+#endif
+        max_end_data_ = std::max(max_end_data_, end_data);
+        end_data = nz_;
+      }
+      for (k = 0; k < first_data; k++) {
+        data_vec[k] = 0.0;
+      }
+
+      for (k = first_data; k < end_data; k++) {
+        z           = z0_ + k*dz_ + static_cast<float>(z_shift_);
+        data_vec[k] = float(storm_grid_->GetValueZInterpolated(x,y,z));
+      }
+      for (k = end_data; k < nz_; k++) {
+        data_vec[k] = 0.0;
+      }
+    }
+    else {
+      for (k = 0; k < nz_; k++) {
+        data_vec[k] = 0.0;
+      }
+    }
+  }
+
+private:
+  void FindPosition(size_t t, float & x, float & y) const
+  {
+    size_t i  = t % nx_;
+    size_t j  = t / nx_;
+    float  xt = float((i+0.5)*geometry_->GetDx());
+    float  yt = float((j+0.5)*geometry_->GetDy());
+    x = float(geometry_->GetX0()+xt*geometry_->GetCosRot()-yt*geometry_->GetSinRot());
+    y = float(geometry_->GetY0()+yt*geometry_->GetCosRot()+xt*geometry_->GetSinRot());
+  }
+
+  const StormContGrid * storm_grid_;
+  const SegyGeometry  * geometry_;
+  size_t                nx_;
+  size_t                ny_;
+  float                 z0_;
+  float                 dz_;
+  int                   nz_;
+  double                z_shift_;
+  mutable int           max_end_data_;
+};
+
 SegY::SegY(const StormContGrid     * storm_grid,
            const SegyGeometry      * geometry,
            float                     z0,
@@ -328,14 +440,14 @@ SegY::SegY(const StormContGrid     * storm_grid,
            bool                      write_to_file,
            const TraceHeaderFormat & trace_header_format,
            bool                      is_seismic,
-           double                    offset)
+           double                    offset,
+           int                       n_threads)
 {
   rmissing_               = segyRMISSING;
   geometry_               = NULL;
   binary_header_          = NULL;
   sampling_inconsistency_ = false;
 
-  int i,k,j;
   TextualHeader header = TextualHeader::standardHeader();
   int nx = static_cast<int>(storm_grid->GetNI());
   int ny = static_cast<int>(storm_grid->GetNJ());
@@ -358,59 +470,24 @@ SegY::SegY(const StormContGrid     * storm_grid,
   else
     SetGeometry(geometry);
 
+  StormTraceSource source(storm_grid, geometry_, z0, dz, nz, is_seismic);
 
-  std::vector<float> data_vec;
-  data_vec.resize(nz);
-  double z_shift = 0;
-  if(is_seismic == false)
-    z_shift = 0.5*dz_;
-  float x, y, xt, yt, z;
-  for (j = 0; j < ny; j++) {
-    for (i = 0; i < nx; i++) {
-      xt = float((i+0.5)*geometry_->GetDx());
-      yt = float((j+0.5)*geometry_->GetDy());
-      x  = float(geometry_->GetX0()+xt*geometry_->GetCosRot()-yt*geometry_->GetSinRot());
-      y  = float(geometry_->GetY0()+yt*geometry_->GetCosRot()+xt*geometry_->GetSinRot());
-
-      double z_bot = storm_grid->GetBotSurface().GetZ(x,y);
-      double z_top = storm_grid->GetTopSurface().GetZ(x,y);
-
-      if (!storm_grid->GetTopSurface().IsMissing(z_top) && !storm_grid->GetBotSurface().IsMissing(z_bot)) {
-        z_bot         -= z0;
-        z_top         -= z0;
-        int first_data = static_cast<int>(floor((z_top+z_shift)/dz));
-        int end_data   = static_cast<int>(floor((z_bot-z_shift)/dz));
-
-        if (end_data > nz) {
-          printf("Internal warning: SEGY-grid too small (%d, %d needed). Truncating data.\n", nz, end_data);
-          end_data = nz;
-        }
-        for (k = 0; k < first_data; k++) {
-          data_vec[k] = 0.0;
-        }
-
-        for (k = first_data; k < end_data; k++) {
-          z           = z0 + k*dz + static_cast<float>(z_shift);
-          data_vec[k] = float(storm_grid->GetValueZInterpolated(x,y,z));
-        }
-        for (k = end_data; k < nz; k++) {
-          data_vec[k] = 0.0;
-        }
-      }
-      else {
-        for (k = 0; k < nz; k++) {
-          data_vec[k] = 0.0;
-        }
-      }
-
+  if (write_to_file) {
+    WriteTraces(source, 1, offset, n_threads);
+  }
+  else {
+    std::vector<float> data_vec(nz);
+    double x, y;
+    for (size_t t = 0; t < source.GetNTraces(); t++) {
+      source.GetPosition(t, x, y);
+      source.GetTrace(t, data_vec);
       StoreTrace(x, y, data_vec, NULL);
     }
-
   }
 
-  if (write_to_file)
-    WriteAllTracesToFile(1, offset);
-
+  if (source.GetMaxEndData() > nz)
+    LogKit::LogFormatted(LogKit::Warning,"\nInternal warning: SEGY-grid too small (%d, %d needed). Data have been truncated.\n",
+                         nz, source.GetMaxEndData());
 }
 
 SegY::~SegY()
@@ -619,13 +696,27 @@ void
 SegY::ReadAllTraces(const Volume * volume,
                     double         zPad,
                     bool           onlyVolume,
-                    bool           relative_padding)
+                    bool           relative_padding,
+                    int            n_threads,
+                    bool           show_progress)
 {
   single_trace_ = false;
-  traces_.resize(n_traces_);
+  traces_.resize(n_traces_, NULL);
+
+  int format = binary_header_->GetFormat();
+  if (format != 1 && format != 2 && format != 3 && format != 5)
+    throw FileFormatError("Bad format");
+
+  // Trace headers must be read in sequence, since they decide where the next
+  // trace starts and which samples to keep. The samples are read raw into a
+  // batch, and each batch is decoded in parallel.
+  size_t                traceBytes = nz_*datasize_;
+  size_t                batchSize  = std::max(static_cast<size_t>(64*1024*1024)/traceBytes, static_cast<size_t>(1));
+  std::vector<RawTrace> batch;
+  std::vector<char>     samples(batchSize*traceBytes);
+  batch.reserve(batchSize);
 
-  LogKit::LogMessage(LogKit::Low,"\nReading SEGY file " );
-  LogKit::LogMessage(LogKit::Low, file_name_);
+  LogKit::LogMessage(LogKit::Low,"\nReading SEGY file " + file_name_);
 
   bool outsideSurface = false;
   bool duplicateHeader; // Needed for memory allocations.
@@ -633,14 +724,17 @@ SegY::ReadAllTraces(const Volume * volume,
   double outsideTopMax[6]; //Largest lack of data top
   double outsideBotMax[6]; //Largest lack of data bot
 
-  traces_[0] = ReadTrace(volume,
-                         zPad,
-                         duplicateHeader,
-                         onlyVolume,
-                         outsideSurface,
-                         true,
-                         outsideTopBot,
-                         relative_padding);
+  ReadRawTrace(0,
+               volume,
+               zPad,
+               duplicateHeader,
+               onlyVolume,
+               outsideSurface,
+               true,
+               outsideTopBot,
+               relative_padding,
+               batch,
+               samples);
   int k;
   for (k=0;k<6;k++) {
     outsideTopMax[k] = outsideTopBot[k];
@@ -648,9 +742,11 @@ SegY::ReadAllTraces(const Volume * volume,
   }
   double writeInterval = 0.02;
   double nextWrite = writeInterval;
-  LogKit::LogMessage(LogKit::Low,"\n  0%        20%      40%       60%       80%       100%");
-  LogKit::LogMessage(LogKit::Low,"\n  |    |    |    |    |    |    |    |    |    |    |  ");
-  LogKit::LogMessage(LogKit::Low,"\n  ^");
+  if (show_progress) {
+    LogKit::LogMessage(LogKit::Low,"\n  0%        20%      40%       60%       80%       100%");
+    LogKit::LogMessage(LogKit::Low,"\n  |    |    |    |    |    |    |    |    |    |    |  ");
+    LogKit::LogMessage(LogKit::Low,"\n  ^");
+  }
   size_t traceSize = datasize_ * nz_ + 240;
   size_t fSize = 3600 + n_traces_ * traceSize;
   long long bytesRead = 3600+traceSize;
@@ -659,19 +755,26 @@ SegY::ReadAllTraces(const Volume * volume,
     double percentDone = bytesRead/static_cast<double>(fSize);
     if (percentDone > nextWrite)
     {
-      LogKit::LogMessage(LogKit::Low,"^");
+      if (show_progress)
+        LogKit::LogMessage(LogKit::Low,"^");
       nextWrite+=writeInterval;
     }
 
+    if (batch.size() == batchSize)
+      DecodeRawTraces(batch, samples, n_threads);
+
     try {
-      traces_[i] = ReadTrace(volume,
-                             zPad,
-                             duplicateHeader,
-                             onlyVolume,
-                             outsideSurface,
-                             false,
-                             outsideTopBot,
-                             relative_padding);
+      ReadRawTrace(i,
+                   volume,
+                   zPad,
+                   duplicateHeader,
+                   onlyVolume,
+                   outsideSurface,
+                   false,
+                   outsideTopBot,
+                   relative_padding,
+                   batch,
+                   samples);
     }
     catch (EndOfFile& ) {
       break;
@@ -688,7 +791,11 @@ SegY::ReadAllTraces(const Volume * volume,
     if (duplicateHeader)
       bytesRead += 3600;
   }
-  LogKit::LogMessage(LogKit::Low,"^\n");
+  DecodeRawTraces(batch, samples, n_threads);
+  if (show_progress)
+    LogKit::LogMessage(LogKit::Low,"^\n");
+  else
+    LogKit::LogMessage(LogKit::Low,"\nFinished reading SEGY file " + file_name_ + "\n");
   n_traces_ = traces_.size();
 
   if (outsideTopBot[0] > outsideTopMax[0])
@@ -741,6 +848,53 @@ SegY::CheckTopBotError(const double * tE, const double * bE)
 }
 
 
+void
+SegY::ReadRawTrace(size_t                  index,
+                   const Volume          * volume,
+                   double                  zPad,
+                   bool                  & duplicateHeader,
+                   bool                    onlyVolume,
+                   bool                  & outsideSurface,
+                   bool                    writevalues,
+                   double                * outsideTopBot,
+                   bool                    relative_padding,
+                   std::vector<RawTrace> & batch,
+                   std::vector<char>     & samples)
+{
+  RawTrace raw = {index, 0, 0, TraceHeader(trace_header_format_)};
+
+  if (ReadTraceHeader(volume, zPad, duplicateHeader, onlyVolume, outsideSurface, writevalues,
+                      outsideTopBot, relative_padding, raw.header, raw.j0, raw.j1) && file_.eof() == false)
+  {
+    size_t traceBytes = nz_*datasize_;
+    if (!file_.read(&samples[batch.size()*traceBytes], static_cast<std::streamsize>(traceBytes)))
+      throw Exception("Error reading trace samples. Trying to read " + ToString(traceBytes) + " bytes when end-of-file was reached.\n"
+                      "Trace position: IL = " + ToString(raw.header.GetInline()) + ", XL = " + ToString(raw.header.GetCrossline()) + "\n");
+    batch.push_back(raw);
+  }
+}
+
+void
+SegY::DecodeRawTraces(std::vector<RawTrace>   & batch,
+                      const std::vector<char> & samples,
+                      int                       n_threads)
+{
+  size_t traceBytes = nz_*datasize_;
+  int    format     = binary_header_->GetFormat();
+  int    n_batch    = static_cast<int>(batch.size());
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(n_threads)
+#endif
+  for (int b = 0; b < n_batch; b++)
+    traces_[batch[b].index] = new SegYTrace(&samples[b*traceBytes], batch[b].j0, batch[b].j1, format, &batch[b].header);
+
+  batch.clear();
+#ifndef PARALLEL
+  (void) n_threads;
+#endif
+}
+
 SegYTrace *
 SegY::ReadTrace(const Volume * volume,
                 double         zPad,
@@ -752,7 +906,37 @@ SegY::ReadTrace(const Volume * volume,
                 bool           relative_padding)
 {
   TraceHeader traceHeader(trace_header_format_);
+  size_t      j0;
+  size_t      j1;
+
+  if (!ReadTraceHeader(volume, zPad, duplicateHeader, onlyVolume, outsideSurface, writevalues,
+                       outsideTopBot, relative_padding, traceHeader, j0, j1))
+    return(NULL);
 
+  SegYTrace * trace = NULL;
+  if (file_.eof() == false)
+  {
+    // Copy elements from j0 til j1.
+    trace = new SegYTrace(file_, j0, j1,
+                          binary_header_->GetFormat(), nz_,
+                          &traceHeader);
+  }
+  return trace;
+}
+
+bool
+SegY::ReadTraceHeader(const Volume * volume,
+                      double         zPad,
+                      bool         & duplicateHeader,
+                      bool           onlyVolume,
+                      bool         & outsideSurface,
+                      bool           writevalues,
+                      double       * outsideTopBot,
+                      bool           relative_padding,
+                      TraceHeader  & traceHeader,
+                      size_t       & j0,
+                      size_t       & j1)
+{
   duplicateHeader = ReadHeader(traceHeader);
   if (writevalues == 1)
     traceHeader.WriteValues();
@@ -781,15 +965,15 @@ SegY::ReadTrace(const Volume * volume,
                    +ToString(trace_header_format_.GetCoordSys())+")");
   }
 
-  size_t j0 = 0;
-  size_t j1 = nz_-1;
+  j0 = 0;
+  j1 = nz_-1;
   float zTop, zBot;
   if (volume != NULL)
   {
     if (onlyVolume && !volume->IsInside(x,y))
     {
       ReadDummyTrace(file_,binary_header_->GetFormat(),nz_);
-      return(NULL);
+      return(false);
     }
 
     try {
@@ -798,7 +982,7 @@ SegY::ReadTrace(const Volume * volume,
     catch (NRLib::Exception & ) {
       outsideSurface = true;
       ReadDummyTrace(file_,binary_header_->GetFormat(),nz_);
-      return(NULL);
+      return(false);
     }
 
     try {
@@ -807,13 +991,13 @@ SegY::ReadTrace(const Volume * volume,
     catch (NRLib::Exception & ) {
       outsideSurface = true;
       ReadDummyTrace(file_,binary_header_->GetFormat(),nz_);
-      return(NULL);
+      return(false);
     }
 
     if (volume->GetTopSurface().IsMissing(zTop) || volume->GetBotSurface().IsMissing(zBot))
     {
       ReadDummyTrace(file_,binary_header_->GetFormat(),nz_);
-      return(NULL);
+      return(false);
     }
   }
   else {
@@ -856,7 +1040,7 @@ SegY::ReadTrace(const Volume * volume,
   }
   if (outsideTopBot != NULL && (outsideTopBot[0] > 0.0 || outsideTopBot[1] > 0.0)) {
     ReadDummyTrace(file_,binary_header_->GetFormat(),nz_);
-    return(NULL);
+    return(false);
   }
 
   float pad;
@@ -878,15 +1062,7 @@ SegY::ReadTrace(const Volume * volume,
   if (j0 > j1)
     throw Exception(" Lower horizon above SegY region or upper horizon below SegY region");
 
-  SegYTrace * trace = NULL;
-  if (file_.eof() == false)
-  {
-    // Copy elements from j0 til j1.
-    trace = new SegYTrace(file_, j0, j1,
-                          binary_header_->GetFormat(), nz_,
-                          &traceHeader);
-  }
-  return trace;
+  return(true);
 }
 
 bool
@@ -915,10 +1091,10 @@ SegY::ReadHeader(TraceHeader & header)
         if (binary_header_dz == 1.0 || binary_header_dz == 2.0 || binary_header_dz == 4.0) {
           dz_ = static_cast<float>(binary_header_->GetHdt()/1000);
           if (sampling_inconsistency_ == false) {
-            LogKit::LogFormatted(LogKit::Warning,"\n\nWarning: Different sampling densities given:\n");
-            LogKit::LogFormatted(LogKit::Warning," Initial sampling density of "+ToString(dz_)+"ms given in BinaryHeader changed to " + ToString(header.GetDt()/1000.0) + "ms for TraceHeader in trace with XL ");
-            LogKit::LogFormatted(LogKit::Warning," " + ToString(header.GetCrossline()) + " and inline " + ToString(header.GetInline()) + ".\n");
-            LogKit::LogFormatted(LogKit::Warning," " + ToString(dz_) + "ms sampling from BinaryHeader will be used when reading this SegY file.");
+            LogKit::LogMessage(LogKit::Warning,"\n\nWarning: Different sampling densities given:\n"
+                               " Initial sampling density of "+ToString(dz_)+"ms given in BinaryHeader changed to " + ToString(header.GetDt()/1000.0) + "ms for TraceHeader in trace with XL "
+                               " " + ToString(header.GetCrossline()) + " and inline " + ToString(header.GetInline()) + ".\n"
+                               " " + ToString(dz_) + "ms sampling from BinaryHeader will be used when reading this SegY file.");
             sampling_inconsistency_ = true;
           }
         }
@@ -1441,6 +1617,131 @@ SegY::WriteAllTracesToFile(short scalcoinitial, double offset)
   }
 }
 
+/// Output position of a trace in WriteTraces.
+struct TraceKey
+{
+  int    il;
+  int    xl;
+  size_t index;   ///< Index in geometry
+  size_t trace;   ///< Index in source
+  double x;
+  double y;
+};
+
+//Sorting function for WriteTraces, giving the order of SortILXL
+bool SortTraceKey(const TraceKey & k1, const TraceKey & k2)
+{
+  if (k1.il != k2.il)
+    return(k1.il < k2.il);
+  if (k1.xl != k2.xl)
+    return(k1.xl < k2.xl);
+  return(k1.index < k2.index);
+}
+
+void
+SegY::WriteTraces(const TraceSource & source,
+                  short               scalcoinitial,
+                  double              offset,
+                  int                 n_threads)
+{
+  assert(file_);
+  assert(geometry_ != 0);
+
+  size_t n_source = source.GetNTraces();
+  size_t n_cells  = geometry_->GetNx()*geometry_->GetNy();
+
+  // As with StoreTrace, a later trace replaces an earlier one in the same cell.
+  std::vector<TraceKey> keys(n_cells);
+  for (size_t c = 0; c < n_cells; c++)
+    keys[c].trace = n_source;
+
+  for (size_t t = 0; t < n_source; t++) {
+    double x, y;
+    source.GetPosition(t, x, y);
+    if (geometry_->IsInside(x,y) == false)
+      throw Exception(" Coordinates are outside grid.");
+    size_t i, j;
+    geometry_->FindIndex(x, y, i, j);
+    TraceKey & key = keys[i + geometry_->GetNx() * j];
+    geometry_->FindILXL(x, y, key.il, key.xl);
+    key.index = i + geometry_->GetNx() * j;
+    key.trace = t;
+    key.x     = x;
+    key.y     = y;
+  }
+
+  size_t n_keys = 0;
+  for (size_t c = 0; c < n_cells; c++) {
+    if (keys[c].trace < n_source)
+      keys[n_keys++] = keys[c];
+  }
+  keys.resize(n_keys);
+  std::sort(keys.begin(), keys.end(), SortTraceKey);
+
+  // Traces are made in batches of about 8MB, each written with a single call.
+  size_t trace_bytes = 240 + 4*nz_;
+  size_t batch_size  = std::max(static_cast<size_t>(1), static_cast<size_t>(8*1024*1024)/trace_bytes);
+
+  std::vector<char>        buffer;
+  std::vector<std::string> errors;
+
+  for (size_t first = 0; first < n_keys; first += batch_size) {
+    int n_batch = static_cast<int>(std::min(batch_size, n_keys - first));
+    buffer.resize(n_batch*trace_bytes);
+    errors.assign(n_batch, "");
+
+#ifdef PARALLEL
+#pragma omp parallel num_threads(n_threads)
+#endif
+    {
+      std::vector<float> data(nz_);
+#ifdef PARALLEL
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (int b = 0; b < n_batch; b++) {
+        const TraceKey & key = keys[first + b];
+        char           * out = &buffer[b*trace_bytes];
+        try {
+          source.GetTrace(key.trace, data);
+
+          TraceHeader header(trace_header_format_);
+          header.SetNSamples(nz_);
+          header.SetDt(static_cast<unsigned short>(dz_*1000));
+          header.SetScalCo(scalcoinitial);
+          header.SetUtmx(key.x);
+          header.SetUtmy(key.y);
+          header.SetInline(key.il);
+          header.SetCrossline(key.xl);
+          header.SetStartTime(static_cast<short>(z0_));
+          header.SetOffset(offset);
+
+          std::ostringstream header_stream(std::ios::out | std::ios::binary);
+          header.Write(header_stream);
+          const std::string & header_bytes = header_stream.str();
+          memcpy(out, header_bytes.data(), 240);
+
+          for (size_t k = 0; k < nz_; k++)
+            NRLibPrivate::WriteIBMFloatBE(&out[240 + 4*k], data[k]);
+        }
+        catch (Exception & e) {
+          errors[b] = e.what();
+        }
+      }
+    }
+
+    for (int b = 0; b < n_batch; b++) {
+      if (errors[b] != "")
+        throw Exception(errors[b]);
+    }
+
+    if (!file_.write(&buffer[0], static_cast<std::streamsize>(n_batch*trace_bytes)))
+      throw Exception("Error writing to stream.");
+  }
+#ifndef PARALLEL
+  (void) n_threads;
+#endif
+}
+
 size_t
 SegY::FindNumberOfTraces(const std::string       & fileName,
                          const TraceHeaderFormat * traceHeaderFormat)
@@ -1530,6 +1831,12 @@ SegY::FindGridGeometry(bool only_ilxl, bool keep_header)
   if(file_.tellg() != static_cast<std::streampos>(3600))
     throw(Exception("Can not find SegY geometry for a file where traces have already been read.\n"));
 
+  if(use_trace_index_ == true && keep_header == false) {
+    SegyGeometry * geometry = ReadTraceIndex(only_ilxl);
+    if(geometry != NULL)
+      return(geometry);
+  }
+
   TraceHeader traceHeader(trace_header_format_);
 
   std::streampos pos  = 3840;
@@ -1565,9 +1872,139 @@ SegY::FindGridGeometry(bool only_ilxl, bool keep_header)
 
   SegyGeometry * geometry = new SegyGeometry(traces_);
   n_traces_  = static_cast<int>(traces_.size());
+
+  if(use_trace_index_ == true && keep_header == false)
+    WriteTraceIndex(geometry, only_ilxl);
+
   return(geometry);
 }
 
+std::string
+SegY::TraceIndexKey(bool only_ilxl) const
+{
+  std::ostringstream key;
+  key << file_name_
+      << " " << FindFileSize(file_name_)
+      << " " << FindFileModificationTime(file_name_)
+      << " " << nz_
+      << " " << datasize_
+      << " " << (only_ilxl ? 1 : 0)
+      << " " << trace_header_format_.GetScalCoLoc()
+      << " " << trace_header_format_.GetUtmxLoc()
+      << " " << trace_header_format_.GetUtmyLoc()
+      << " " << trace_header_format_.GetInlineLoc()
+      << " " << trace_header_format_.GetCrosslineLoc()
+      << " " << trace_header_format_.GetStartTimeLoc()
+      << " " << trace_header_format_.GetOffsetLoc()
+      << " " << trace_header_format_.GetCoordSys();
+  return(key.str());
+}
+
+SegyGeometry *
+SegY::ReadTraceIndex(bool only_ilxl)
+{
+  //
+  // File layout: Text line with version, text line with key, geometry, and then
+  // IL, XL, x, y, coord1, coord2 and file position for each trace in the geometry.
+  // File position 0 means that there is no trace.
+  //
+  std::string index_name = TraceIndexFileName();
+  if(FileExists(index_name) == false)
+    return(NULL);
+
+  SegyGeometry      * geometry = NULL;
+  size_t              n        = 0;
+  std::vector<int>    il, xl;
+  std::vector<double> x, y, coord1, coord2, pos;
+  try {
+    std::ifstream file;
+    OpenRead(file, index_name, std::ios::in | std::ios::binary);
+
+    std::string version, key;
+    std::getline(file, version);
+    std::getline(file, key);
+    if(version != "NRLib SegY trace index 1" || key != TraceIndexKey(only_ilxl)) {
+      LogKit::LogFormatted(LogKit::High, "\nTrace index " + index_name + " does not match SegY file. Scanning trace headers.\n");
+      return(NULL);
+    }
+
+    geometry = new SegyGeometry(file);
+    n        = static_cast<size_t>(ReadBinaryInt(file));
+    il.resize(n);
+    xl.resize(n);
+    x.resize(n);
+    y.resize(n);
+    coord1.resize(n);
+    coord2.resize(n);
+    pos.resize(n);
+    ReadBinaryIntArray(file, il.begin(), n);
+    ReadBinaryIntArray(file, xl.begin(), n);
+    ReadBinaryDoubleArray(file, x.begin(), n);
+    ReadBinaryDoubleArray(file, y.begin(), n);
+    ReadBinaryDoubleArray(file, coord1.begin(), n);
+    ReadBinaryDoubleArray(file, coord2.begin(), n);
+    ReadBinaryDoubleArray(file, pos.begin(), n);
+  }
+  catch(Exception & e) {
+    LogKit::LogFormatted(LogKit::Warning, "\nWARNING: Could not read trace index " + index_name + ": " + e.what() + "\n");
+    delete geometry;
+    return(NULL);
+  }
+
+  traces_.resize(n, NULL);
+  for(size_t i = 0; i < n; i++) {
+    if(pos[i] > 0.0) {
+      std::streampos file_pos = static_cast<std::streamoff>(pos[i]);
+      traces_[i] = new SegYTrace(x[i], y[i], il[i], xl[i], coord1[i], coord2[i], file_pos);
+      traces_[i]->SetTableIndex(i);
+    }
+  }
+  n_traces_ = n;
+
+  LogKit::LogFormatted(LogKit::High, "\nGeometry and trace positions taken from trace index " + index_name + ".\n");
+  return(geometry);
+}
+
+void
+SegY::WriteTraceIndex(const SegyGeometry * geometry, bool only_ilxl) const
+{
+  std::string index_name = TraceIndexFileName();
+
+  size_t              n = traces_.size();
+  std::vector<int>    il(n, segyIMISSING), xl(n, segyIMISSING);
+  std::vector<double> x(n, 0.0), y(n, 0.0), coord1(n, 0.0), coord2(n, 0.0), pos(n, 0.0);
+  for(size_t i = 0; i < n; i++) {
+    if(traces_[i] != NULL) {
+      il[i]     = traces_[i]->GetInline();
+      xl[i]     = traces_[i]->GetCrossline();
+      x[i]      = traces_[i]->GetX();
+      y[i]      = traces_[i]->GetY();
+      coord1[i] = traces_[i]->GetCoord1();
+      coord2[i] = traces_[i]->GetCoord2();
+      pos[i]    = static_cast<double>(static_cast<std::streamoff>(traces_[i]->GetFilePos()));
+    }
+  }
+
+  try {
+    std::ofstream file;
+    OpenWrite(file, index_name, std::ios::out | std::ios::binary);
+    file << "NRLib SegY trace index 1\n" << TraceIndexKey(only_ilxl) << "\n";
+    geometry->WriteBinary(file);
+    WriteBinaryInt(file, static_cast<int>(n));
+    WriteBinaryIntArray(file, il.begin(), il.end());
+    WriteBinaryIntArray(file, xl.begin(), xl.end());
+    WriteBinaryDoubleArray(file, x.begin(), x.end());
+    WriteBinaryDoubleArray(file, y.begin(), y.end());
+    WriteBinaryDoubleArray(file, coord1.begin(), coord1.end());
+    WriteBinaryDoubleArray(file, coord2.begin(), coord2.end());
+    WriteBinaryDoubleArray(file, pos.begin(), pos.end());
+    file.close();
+  }
+  catch(Exception & e) {
+    LogKit::LogFormatted(LogKit::Warning, "\nWARNING: Could not write trace index " + index_name + ": " + e.what() + "\n");
+  }
+}
+
 void
 SegY::SetBogusILXLUndefined(std::vector<NRLib::SegYTrace*> & traces)
 {
@@ -1728,35 +2165,16 @@ SegY::SetBogusILXLUndefined(std::vector<NRLib::SegYTrace*> & traces)
 
 void SegY::ReadDummyTrace(std::fstream & file, int format, size_t nz)
 {
-std::vector<float> predata;
-  predata.resize(nz);
-
-  if (format==1)
-  {
-    //IBM
-    ReadBinaryIbmFloatArray(file, predata.begin(), nz);
-
-  }
-  else if (format==2)
-  {
-    std::vector<int> b(nz);
-    ReadBinaryIntArray(file, b.begin(), nz);
-
-  }
-  else if (format==3)
-  {
-    std::vector<short> b(nz);
-    ReadBinaryShortArray(file, b.begin(), nz);
-
-  }
-  else if (format==5)
-  {
-    ReadBinaryFloatArray(file, predata.begin(), nz);
-
-  }
+  // Skip the samples without decoding them.
+  size_t bytes;
+  if (format == 1 || format == 2 || format == 5)
+    bytes = 4*nz;
+  else if (format == 3)
+    bytes = 2*nz;
   else
     throw FileFormatError("Bad format");
 
+  file.seekg(static_cast<std::streamoff>(bytes), std::ios_base::cur);
 }
 
 bool
@@ -46,6 +46,17 @@ class TextualHeader;
 class SegY{
 public:
 
+  /// Trace values to write with WriteTraces. GetTrace may be called from several
+  /// threads at once, and must set all GetNz() samples of data, from the top of the cube.
+  class TraceSource
+  {
+  public:
+    virtual        ~TraceSource() {}
+    virtual size_t  GetNTraces()                                      const = 0;
+    virtual void    GetPosition(size_t t, double & x, double & y)     const = 0;
+    virtual void    GetTrace(size_t t, std::vector<float> & data)     const = 0;
+  };
+
   /// Constructor for reading
   /// Read only the headers on top of the file
   /// \param[in] fileName  Name of file to read data from
@@ -88,7 +99,8 @@ public:
       bool                      write_to_file = true,
       const TraceHeaderFormat & trace_header_format = TraceHeaderFormat(TraceHeaderFormat::SEISWORKS),
       bool                      is_seismic = false,
-      double                    offset = 0);
+      double                    offset = 0,
+      int                       n_threads = 1);
 
   ~SegY();
 
@@ -96,7 +108,9 @@ public:
   void                      ReadAllTraces(const NRLib::Volume * volume,
                                           double                zPad,
                                           bool                  onlyVolume       = false,
-                                          bool                  relative_padding = true); ///< Read all traces with header
+                                          bool                  relative_padding = true,
+                                          int                   n_threads        = 1,
+                                          bool                  show_progress    = true); ///< Read all traces with header. Turn progress off when several files are read at once
   float                     GetValue(double x,
                                      double y,
                                      double z,
@@ -125,6 +139,10 @@ public:
   SegyGeometry            * FindGridGeometry(bool only_ilxl = false, bool keep_header = false);        //Note: This and function below also sets all traceheaders with file position.
   void                      FindAndSetGridGeometry(bool only_ilxl = false, bool keep_header = false);
 
+  /// Store geometry and trace positions found above in a sidecar file (fileName.idx), and
+  /// use it instead of scanning the trace headers as long as the SegY file is unchanged.
+  static void               SetUseTraceIndex(bool use) { use_trace_index_ = use ;}
+
   SegYTrace               * GetNextTrace(double                zPad = 0,
                                          const NRLib::Volume * volume = NULL,
                                          bool                  onlyVolume = false);
@@ -172,6 +190,13 @@ public:
 
   void                      WriteAllTracesToFile(short  scalcoinitial = 1,
                                                  double offset        = 0); ///< Use only after writeTrace with x and y as input is used for the whole cube
+
+  /// Write all traces of source in the order of WriteAllTracesToFile, without storing them.
+  /// Traces are made and encoded in parallel in batches, and each batch is written at once.
+  void                      WriteTraces(const TraceSource & source,
+                                        short               scalcoinitial = 1,
+                                        double              offset        = 0,
+                                        int                 n_threads     = 1);
   //<<<End write mode
 
 
@@ -201,8 +226,42 @@ public:
   SegYTrace *              getTrace(int i) {return traces_[i];};
 
 private:
+  /// Samples of a trace that are read, but not yet decoded.
+  struct RawTrace
+  {
+    size_t                  index;                 ///< Index in traces_
+    size_t                  j0;                    ///< First sample to keep
+    size_t                  j1;                    ///< Last sample to keep
+    TraceHeader             header;
+  };
+
   //void                      ebcdicHeader(std::string& outstring);               ///<
   bool                      ReadHeader(TraceHeader & header);                   ///< Trace header
+  bool                      ReadTraceHeader(const NRLib::Volume * volume,
+                                            double                zPad,
+                                            bool                & duplicateHeader,
+                                            bool                  onlyVolume,
+                                            bool                & outsideSurface,
+                                            bool                  writevalues,
+                                            double              * outsideTopBot,
+                                            bool                  relative_padding,
+                                            TraceHeader         & traceHeader,
+                                            size_t              & j0,
+                                            size_t              & j1);             ///< As ReadTrace, but samples are not read. False if trace is skipped.
+  void                      ReadRawTrace(size_t                  index,
+                                         const NRLib::Volume   * volume,
+                                         double                  zPad,
+                                         bool                  & duplicateHeader,
+                                         bool                    onlyVolume,
+                                         bool                  & outsideSurface,
+                                         bool                    writevalues,
+                                         double                * outsideTopBot,
+                                         bool                    relative_padding,
+                                         std::vector<RawTrace> & batch,
+                                         std::vector<char>     & samples);        ///< Read trace into batch without decoding samples
+  void                      DecodeRawTraces(std::vector<RawTrace>   & batch,
+                                            const std::vector<char> & samples,
+                                            int                       n_threads); ///< Decode batch into traces_ and clear it
   SegYTrace               * ReadTrace(const NRLib::Volume * volume,
                                       double                zPad,
                                       bool                & duplicateHeader,
@@ -226,6 +285,12 @@ private:
   void                      FindDeltaILXL(TraceHeader *t1, TraceHeader *t2, TraceHeader *t3, double &dil, double &dxl, bool x);
   void                      CheckTopBotError(const double * tE, const double * bE); ///<Summarizes lack of data at top and bottom.
 
+  std::string               TraceIndexFileName(void) const { return file_name_ + ".idx" ;}
+  std::string               TraceIndexKey(bool only_ilxl) const;                ///< Identifies file, file version and header format
+  SegyGeometry            * ReadTraceIndex(bool only_ilxl);                     ///< Sets traces_. NULL if there is no valid index.
+  void                      WriteTraceIndex(const SegyGeometry * geometry,
+                                            bool                 only_ilxl) const;
+
   TraceHeaderFormat         trace_header_format_;
 
   SegyGeometry            * geometry_;             ///< Parameters to find final index from i and j
@@ -252,6 +317,8 @@ private:
 
   bool                      sampling_inconsistency_;   ///< If sampling in trace header is inconsistent with sampling in binary header
 
+  static bool               use_trace_index_;          ///< Use sidecar file in FindGridGeometry
+
 };
 
 
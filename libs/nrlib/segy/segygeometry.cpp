@@ -940,10 +940,67 @@ SegyGeometry::SegyGeometry(const SegyGeometry *geometry)
   firstAxisIL_ = geometry->firstAxisIL_;
 }
 
+SegyGeometry::SegyGeometry(std::istream & file)
+{
+  x0_          = ReadBinaryDouble(file);
+  y0_          = ReadBinaryDouble(file);
+  dx_          = ReadBinaryDouble(file);
+  dy_          = ReadBinaryDouble(file);
+  nx_          = static_cast<size_t>(ReadBinaryInt(file));
+  ny_          = static_cast<size_t>(ReadBinaryInt(file));
+  in_line0_    = ReadBinaryDouble(file);
+  cross_line0_ = ReadBinaryDouble(file);
+  il_stepX_    = ReadBinaryDouble(file);
+  il_stepY_    = ReadBinaryDouble(file);
+  xl_stepX_    = ReadBinaryDouble(file);
+  xl_stepY_    = ReadBinaryDouble(file);
+  sin_rot_     = ReadBinaryDouble(file);
+  cos_rot_     = ReadBinaryDouble(file);
+  rot_         = ReadBinaryDouble(file);
+  IL0_         = ReadBinaryInt(file);
+  XL0_         = ReadBinaryInt(file);
+  minIL_       = ReadBinaryInt(file);
+  maxIL_       = ReadBinaryInt(file);
+  ILStep_      = ReadBinaryInt(file);
+  minXL_       = ReadBinaryInt(file);
+  maxXL_       = ReadBinaryInt(file);
+  XLStep_      = ReadBinaryInt(file);
+  firstAxisIL_ = (ReadBinaryInt(file) == 1);
+}
+
 SegyGeometry::~SegyGeometry()
 {
 }
 
+void
+SegyGeometry::WriteBinary(std::ostream & file) const
+{
+  WriteBinaryDouble(file, x0_);
+  WriteBinaryDouble(file, y0_);
+  WriteBinaryDouble(file, dx_);
+  WriteBinaryDouble(file, dy_);
+  WriteBinaryInt(file, static_cast<int>(nx_));
+  WriteBinaryInt(file, static_cast<int>(ny_));
+  WriteBinaryDouble(file, in_line0_);
+  WriteBinaryDouble(file, cross_line0_);
+  WriteBinaryDouble(file, il_stepX_);
+  WriteBinaryDouble(file, il_stepY_);
+  WriteBinaryDouble(file, xl_stepX_);
+  WriteBinaryDouble(file, xl_stepY_);
+  WriteBinaryDouble(file, sin_rot_);
+  WriteBinaryDouble(file, cos_rot_);
+  WriteBinaryDouble(file, rot_);
+  WriteBinaryInt(file, IL0_);
+  WriteBinaryInt(file, XL0_);
+  WriteBinaryInt(file, minIL_);
+  WriteBinaryInt(file, maxIL_);
+  WriteBinaryInt(file, ILStep_);
+  WriteBinaryInt(file, minXL_);
+  WriteBinaryInt(file, maxXL_);
+  WriteBinaryInt(file, XLStep_);
+  WriteBinaryInt(file, firstAxisIL_ ? 1 : 0);
+}
+
 bool
 SegyGeometry::IsInside(double x, double y) const
 {
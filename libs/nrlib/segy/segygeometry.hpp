@@ -54,6 +54,7 @@ public:
   SegyGeometry(const RegularSurface<double> surf);
   SegyGeometry(const RegularSurfaceRotated<double> surf);
   SegyGeometry(const SegyGeometry *geometry);   ///< Copy constructor
+  SegyGeometry(std::istream & file);             ///< Read geometry written by WriteBinary
   SegyGeometry() {}; //Empty constructor for use with SetupGeometry.
 
   ~SegyGeometry();
@@ -104,6 +105,7 @@ public:
   bool   GetFirstAxisIL()  const { return firstAxisIL_ ;}
 
   void   WriteGeometry() const;
+  void   WriteBinary(std::ostream & file) const;   ///< Exact copy of all parameters
   void   WriteILXL(bool errorMode = false) const;
 
   void   SetupGeometry(double xRef, double yRef, int ilRef, int xlRef,
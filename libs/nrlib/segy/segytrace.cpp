@@ -124,6 +124,52 @@ SegYTrace::SegYTrace(std::fstream & file, size_t jStart, size_t jEnd, int format
   }
 }
 
+SegYTrace::SegYTrace(const char * buffer, size_t jStart, size_t jEnd, int format,
+                     const TraceHeader * trace_header)
+{
+  rmissing_      = segyRMISSING;
+  imissing_      = segyIMISSING;
+  j_start_       = jStart;
+  j_end_         = jEnd;
+  x_             = trace_header->GetUtmx();
+  y_             = trace_header->GetUtmy();
+  in_line_       = trace_header->GetInline();
+  cross_line_    = trace_header->GetCrossline();
+  coord1_        = trace_header->GetCoord1();
+  coord2_        = trace_header->GetCoord2();
+  trace_header_  = new TraceHeader(*trace_header);
+  table_index_   = 0;
+  file_position_ = 0;
+
+  size_t nData = jEnd - jStart + 1;
+  data_.resize(nData);
+
+  // Only the samples that are kept are decoded.
+  if (format == 1) {
+    for (size_t i = 0; i < nData; i++)
+      ParseIBMFloatBE(&buffer[4*(jStart + i)], data_[i]);
+  }
+  else if (format == 2) {
+    int b;
+    for (size_t i = 0; i < nData; i++) {
+      ParseInt32BE(&buffer[4*(jStart + i)], b);
+      data_[i] = static_cast<float>(b);
+    }
+  }
+  else if (format == 3) {
+    short b;
+    for (size_t i = 0; i < nData; i++) {
+      ParseInt16BE(&buffer[2*(jStart + i)], b);
+      data_[i] = static_cast<float>(b);
+    }
+  }
+  else {
+    assert(format == 5);
+    for (size_t i = 0; i < nData; i++)
+      ParseIEEEFloatBE(&buffer[4*(jStart + i)], data_[i]);
+  }
+}
+
 SegYTrace::SegYTrace(std::vector<float> indata, size_t jStart, size_t jEnd, double x, double y, int inLine, int crossLine)
 {
   rmissing_   = segyRMISSING;
@@ -169,6 +215,29 @@ SegYTrace::SegYTrace(const TraceHeader& trace_header, bool keep_header)
 
 }
 
+SegYTrace::SegYTrace(double         x,
+                     double         y,
+                     int            inLine,
+                     int            crossLine,
+                     double         coord1,
+                     double         coord2,
+                     std::streampos filePos)
+{
+  rmissing_      = segyRMISSING;
+  imissing_      = segyIMISSING;
+  j_start_       = 1;
+  j_end_         = 0;
+  x_             = x;
+  y_             = y;
+  in_line_       = inLine;
+  cross_line_    = crossLine;
+  coord1_        = coord1;
+  coord2_        = coord2;
+  table_index_   = 0;
+  file_position_ = filePos;
+  trace_header_  = NULL;
+}
+
 SegYTrace::~SegYTrace()
 {
   delete trace_header_;
@@ -53,6 +53,12 @@ public:
             size_t              nz,
             const TraceHeader * trace_header = NULL);                                     ///< Standard reading constructor.
 
+  SegYTrace(const char        * buffer,
+            size_t              jStart,
+            size_t              jEnd,
+            int                 format,
+            const TraceHeader * trace_header);                                            ///< Decode samples jStart-jEnd of a raw big endian trace. Format must be legal.
+
   SegYTrace(std::vector<float> indata,
             size_t             jStart,
             size_t             jEnd,
@@ -64,6 +70,14 @@ public:
   SegYTrace(const TraceHeader & trace_header,
             bool                keep_header = true);                                      ///< Constructor for handling only headers.
 
+  SegYTrace(double              x,
+            double              y,
+            int                 inLine,
+            int                 crossLine,
+            double              coord1,
+            double              coord2,
+            std::streampos      filePos);                                                 ///< Constructor for header values taken from a trace index.
+
   ~SegYTrace();
 
   void SetTableIndex(size_t index) {table_index_ = index;}                                ///< Set table index
@@ -714,7 +714,7 @@ StormContGrid::WriteCravaFile(const std::string & file_name,
     //std::string f_name = file_name + IO::SuffixCrava();
     NRLib::OpenWrite(bin_file, file_name, std::ios::out | std::ios::binary);
 
-    std::string file_type = "crava_fftgrid_binary";
+    std::string file_type = "crava_fftgrid_binary_v2";
     bin_file << file_type << "\n";
 
     NRLib::WriteBinaryDouble(bin_file, GetXMin());
@@ -734,18 +734,14 @@ StormContGrid::WriteCravaFile(const std::string & file_name,
     NRLib::WriteBinaryInt(bin_file, static_cast<int>(GetNJ()));
     NRLib::WriteBinaryInt(bin_file, static_cast<int>(GetNK()));
 
-    //for(int i=0;i<rsize_;i++)
-    //  NRLib::WriteBinaryFloat(binFile, rvalue_[i]);
-
-    float value = 0.0f;
-    for (size_t i = 0; i < GetNI(); i++) {
-      for (size_t j = 0; j < GetNJ(); j++) {
-        for (size_t k = 0; k < GetNK(); k++) {
-          value = GetValue(i, j, k);
-          NRLib::WriteBinaryFloat(bin_file, value);
-        }
-      }
-    }
+    // Same layout as FFTGrid::writeCravaFile: The values are stored little endian from a
+    // page aligned offset, with i running fastest, and the grid is written in one go.
+    const int data_offset = 4096;
+    NRLib::WriteBinaryInt(bin_file, data_offset);
+    std::vector<char> header_padding(data_offset - static_cast<int>(bin_file.tellp()), 0);
+    bin_file.write(&header_padding[0], header_padding.size());
+    if (GetN() > 0)
+      NRLib::WriteBinaryFloatBuffer(bin_file, &(*this)(0), GetN(), END_LITTLE_ENDIAN);
 
     bin_file.close();
   }
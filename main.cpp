@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <assert.h>
+#include <algorithm>
 
 #if defined(COMPILE_STORM_MODULES_FOR_RMS)
 #include <util/precompile.h>
@@ -35,6 +36,7 @@
 #include "src/wavelet.h"
 #include "src/avoinversion.h"
 #include "src/fftgrid.h"
+#include "src/fftengine.h"
 #include "src/gridmapping.h"
 #include "src/simbox.h"
 #include "src/timings.h"
@@ -216,6 +218,14 @@ int main(int argc, char** argv)
     std::vector<SeismicParametersHolder> seismicParametersIntervals(common_data->GetMultipleIntervalGrid()->GetNIntervals());
 
     if(modelSettings->getEstimationMode() == false) {
+      std::vector<ModelGeneral *>   modelGeneralIntervals(n_intervals, NULL);
+      std::vector<ModelAVOStatic *> modelAVOstaticIntervals(n_intervals, NULL);
+
+      bool doInversion = !modelSettings->getForwardModeling();
+      int  n_parallel  = 1;
+      if (doInversion)
+        n_parallel = std::min(modelSettings->getNumberOfParallelIntervals(), n_intervals);
+
       //Loop over intervals
       for (int i_interval = 0; i_interval < n_intervals; i_interval++) {
 
@@ -288,72 +298,60 @@ int main(int argc, char** argv)
                           common_data,
                           i_interval);
 
-        //Loop over dataset
-        //i.   ModelAVODynamic
-        //ii.  Inversion
-        //iii. Move model one time-step ahead
+        modelGeneralIntervals[i_interval]   = modelGeneral;
+        modelAVOstaticIntervals[i_interval] = modelAVOstatic;
 
         //Do not run avoinversion if forward modelleing or estimationmode
         //Syntetic seismic is generated in CravaResult
-        if (!modelSettings->getForwardModeling() && !modelSettings->getEstimationMode()) {
-          int  eventType;
-          int  eventIndex;
-          modelGeneral->GetTimeLine()->ReSet();
-
-          double time;
-          int time_index = 0;
-          bool first     = true;
-          while(modelGeneral->GetTimeLine()->GetNextEvent(eventType, eventIndex, time) == true) {
-            if (first == false) {
-                modelGeneral->AdvanceTime(time_index, seismicParametersIntervals[i_interval], modelSettings);
-                time_index++;
-            }
-            bool failed = false;
-            switch(eventType) {
-            case TimeLine::AVO : {
-              LogKit::LogFormatted(LogKit::Low,"\nAVO inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
-              failed = doTimeLapseAVOInversion(modelSettings,
-                                                modelGeneral,
-                                                modelAVOstatic,
-                                                common_data,
-                                                seismicParametersIntervals[i_interval],
-                                                eventIndex,
-                                                i_interval);
-              break;
-            }
-            case TimeLine::TRAVEL_TIME : {
-              LogKit::LogFormatted(LogKit::Low,"\nTravel time inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
-              //failed = doTimeLapseTravelTimeInversion(modelSettings,
-              //                                        modelGeneral,
-              //                                        modelTravelTimeStatic,
-              //                                        inputFiles,
-              //                                        eventIndex,
-              //                                        seismicParametersIntervals[i_interval]);
-              break;
-            }
-            case TimeLine::GRAVITY : {
-              LogKit::LogFormatted(LogKit::Low,"\nGravimetric inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
-              //failed = doTimeLapseGravimetricInversion(modelSettings,
-              //                                          modelGeneral,
-              //                                          modelGravityStatic,
-              //                                          common_data,
-              //                                          eventIndex,
-              //                                          seismicParametersIntervals[i_interval]);
-              break;
-            }
-            default :
-              failed = true;
-              break;
-            }
-            if(failed)
-              return(1);
-
-            first = false;
-          }
+        //Intervals are inverted here one by one, unless they are inverted in parallel below.
+        if (doInversion && n_parallel == 1) {
+          bool failed = doIntervalInversion(modelSettings,
+                                            modelGeneral,
+                                            modelAVOstatic,
+                                            common_data,
+                                            seismicParametersIntervals[i_interval],
+                                            i_interval);
+          if(failed)
+            return(1);
         }
-
-        crava_result->AddBlockedLogs(modelGeneral->GetBlockedWells());
       } //interval_loop
+
+      if (doInversion && n_parallel > 1) {
+        //The intervals only share CommonData. Start with the largest intervals so
+        //that the smaller ones fill in at the end.
+        std::vector<std::pair<double, int> > interval_order(n_intervals);
+        for (int i_interval = 0; i_interval < n_intervals; i_interval++) {
+          const Simbox * simbox = common_data->GetMultipleIntervalGrid()->GetIntervalSimbox(i_interval);
+          double size = static_cast<double>(simbox->GetNXpad())*simbox->GetNYpad()*simbox->GetNZpad();
+          interval_order[i_interval] = std::make_pair(-size, i_interval);
+        }
+        std::sort(interval_order.begin(), interval_order.end());
+
+        LogKit::WriteHeader("Inverting " + NRLib::ToString(n_parallel) + " intervals in parallel");
+
+        std::vector<int> failed(n_intervals, 0);
+#ifdef PARALLEL
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_parallel)
+#endif
+        for (int i = 0; i < n_intervals; i++) {
+          int i_interval = interval_order[i].second;
+          LogKit::LogFormatted(LogKit::Low,"\nStarting inversion of interval "+common_data->GetMultipleIntervalGrid()->GetIntervalName(i_interval)+"..\n");
+          failed[i_interval] = doIntervalInversion(modelSettings,
+                                                   modelGeneralIntervals[i_interval],
+                                                   modelAVOstaticIntervals[i_interval],
+                                                   common_data,
+                                                   seismicParametersIntervals[i_interval],
+                                                   i_interval);
+          LogKit::LogFormatted(LogKit::Low,"\nInversion of interval "+common_data->GetMultipleIntervalGrid()->GetIntervalName(i_interval)+" finished.\n");
+        }
+        for (int i_interval = 0; i_interval < n_intervals; i_interval++) {
+          if(failed[i_interval])
+            return(1);
+        }
+      }
+
+      for (int i_interval = 0; i_interval < n_intervals; i_interval++)
+        crava_result->AddBlockedLogs(modelGeneralIntervals[i_interval]->GetBlockedWells());
     }
     if (n_intervals == 1)
       crava_result->SetBgBlockedLogs(common_data->GetBgBlockedLogs());
@@ -422,6 +420,8 @@ int main(int argc, char** argv)
     delete inputFiles;
     inputFiles              = NULL;
 
+    FFTEngine::destroyPlans();
+
     Timings::reportTotal();
     LogKit::LogFormatted(LogKit::Low,"\n*** CRAVA closing  ***\n");
     LogKit::LogFormatted(LogKit::Low,"\n*** CRAVA finished ***\n");
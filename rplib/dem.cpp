@@ -7,20 +7,13 @@
 #include <numeric>
 #include <cmath>
 
-static DEM* global_dem;
-
-static std::vector<double> WrapperGEQDEMYPrime(std::vector<double>&       y,
-                                               double                     t) {
-  return global_dem->GEQDEMYPrime(y, t);
-}
-
-
 DEM::DEM(const std::vector<double>&       bulk_modulus,
          const std::vector<double>&       shear_modulus,
          const std::vector<double>&       aspect_ratio,
          std::vector<double>&             concentration,
          double                           bulk_modulus_bg,
          double                           shear_modulus_bg) :
+  sum_conc_(0.0),
   bulk_modulus_bg_(bulk_modulus_bg),
   shear_modulus_bg_(shear_modulus_bg),
   bulk_modulus_(bulk_modulus),
@@ -28,8 +21,6 @@ DEM::DEM(const std::vector<double>&       bulk_modulus,
   aspect_ratio_(aspect_ratio),
   concentration_(concentration) {
 
-  global_dem = this;
-
 }
 
 DEM::~DEM() {
@@ -74,43 +65,40 @@ DEM::CalcEffectiveModulus(double&                    effective_bulk_modulus,
   }
   else {
     std::vector<double>           y0;
-    std::vector<double>                 tout;
-    std::vector< std::vector<double> >  yout;
+    std::vector<double>           yfinal;
 
     double tfinal = sum_conc;
     y0.resize(2);
     y0[0] = bulk_modulus_bg_;
     y0[1] = shear_modulus_bg_;
 
+    sum_conc_ = std::accumulate(concentration_.begin(), concentration_.end(), 0.0);
+
     OrdDiffEqSolver::
-    Ode45(&WrapperGEQDEMYPrime,
+    Ode45(*this,
           0.0,
           tfinal,
           y0,
-          tout,
-          yout,
+          yfinal,
           1e-5);
 
-    if (!yout.empty())
-      effective_bulk_modulus  = (yout.back())[0];
-    if (!yout.empty())
-      effective_shear_modulus = (yout.back())[1];
+    effective_bulk_modulus  = yfinal[0];
+    effective_shear_modulus = yfinal[1];
 
   }
 
 }
 
-std::vector<double>
-DEM::GEQDEMYPrime(std::vector<double>&       y,
-                  double                     t) {
+void
+DEM::GEQDEMYPrime(const double *             y,
+                  double                     t,
+                  double *                   yprime) const {
 
   size_t ninclusions = aspect_ratio_.size();
 
   double krhs = 0;
   double murhs = 0;
-  double sum_conc = std::accumulate(concentration_.begin(), concentration_.end(), 0.0);
-
-  std::vector<double> yprime(2, 0.0);
+  double sum_conc = sum_conc_;
 
   for (size_t index = 0; index < ninclusions; index++) {
     double k2 = bulk_modulus_[index];
@@ -184,8 +172,6 @@ DEM::GEQDEMYPrime(std::vector<double>&       y,
   yprime[0] = krhs/(1 - t);
   yprime[1] = murhs/(1 - t);
 
-  return yprime;
-
 }
 
 
@@ -3,7 +3,11 @@
 
 #include <vector>
 
-class DEM {
+#include "rplib/orddiffeqsolver.h"
+
+// The DEM equations are integrated with this object as the right hand side, so
+// that separate DEM objects may be used from separate threads.
+class DEM : public OrdDiffEqSolver::Function {
 public:
   DEM(const std::vector<double>&       bulk_modulus,
       const std::vector<double>&       shear_modulus,
@@ -39,10 +43,16 @@ public:
   void CalcEffectiveModulus(double&                    effective_bulk_modulus,
                             double&                    effective_shear_modulus);
 
-  std::vector<double> GEQDEMYPrime(std::vector<double>&       y,
-                                   double                     t);
+  void GEQDEMYPrime(const double *             y,
+                    double                     t,
+                    double *                   yprime) const;
+
+  virtual size_t Dim() const { return 2; }
+
+  virtual void Evaluate(const double * y, double t, double * yprime) const { GEQDEMYPrime(y, t, yprime); }
 
 private:
+  double                           sum_conc_; // Sum of concentration_, set before integration
   double                           bulk_modulus_bg_;
   double                           shear_modulus_bg_;
   const std::vector<double>&       bulk_modulus_;
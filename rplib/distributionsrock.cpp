@@ -38,6 +38,31 @@ Rock * DistributionsRock::GenerateSample(const std::vector<double> & trend_param
 
 
 
+//--------------------------------------------------------------//
+void DistributionsRock::GenerateSeismicSamples(const std::vector<double> & trend_params,
+                                               std::vector<double>       & vp,
+                                               std::vector<double>       & vs,
+                                               std::vector<double>       & rho)
+{
+  size_t nResVar=reservoir_variables_.size();
+  for(size_t k=0;k<vp.size();k++) {
+    for(size_t i=0;i<nResVar;i++)
+      reservoir_variables_[i]->TriggerNewSample(resampling_level_);
+    GenerateSeismicParamsPrivate(trend_params, vp[k], vs[k], rho[k]);
+  }
+}
+
+//--------------------------------------------------------------//
+void DistributionsRock::GenerateSeismicParamsPrivate(const std::vector<double> & trend_params,
+                                                     double                    & vp,
+                                                     double                    & vs,
+                                                     double                    & rho)
+{
+  Rock * rock = GenerateSamplePrivate(trend_params);
+  rock->GetSeismicParams(vp, vs, rho);
+  delete rock;
+}
+
 //--------------------------------------------------------------//
 void DistributionsRock::GenerateWellSample(double                 corr,
                                            std::vector<double>  & vp,
@@ -121,6 +146,10 @@ void  DistributionsRock::SetupExpectationAndCovariances(std::string & errTxt)
   NRLib::Grid2D<double> cov(3,3);
   std::vector<double>   mean(3);
 
+  std::vector<double>   vp(n);
+  std::vector<double>   vs(n);
+  std::vector<double>   rho(n);
+
   unsigned int seed = NRLib::Random::DrawUint32();
 
   bool failed = false;
@@ -133,35 +162,33 @@ void  DistributionsRock::SetupExpectationAndCovariances(std::string & errTxt)
 
       if(failed == false) {
 
-        NRLib::Random::Initialize(seed);
+        // Every trend node draws the same numbers from its own generator, so the
+        // tabulated moments are smooth in the trends and the global generator
+        // is left untouched.
+        NRLib::RandomGenerator generator;
+        generator.Initialize(seed);
+        NRLib::Random::StreamScope stream(generator);
+
         const std::vector<double> & tp = trend_params(i,j); // trend_params = two-dimensional
 
         NRLib::Vector log_vp(n);
         NRLib::Vector log_vs(n);
         NRLib::Vector log_rho(n);
 
-        double vp;
-        double vs;
-        double rho;
+        GenerateSeismicSamples(tp, vp, vs, rho);
 
         for (int k = 0 ; k < n ; k++) {
-          Rock * rock = GenerateSample(tp);
-
-          rock->GetSeismicParams(vp, vs, rho);
-
-          log_vp(k) = std::log(vp);
-          log_vs(k) = std::log(vs);
-          log_rho(k) = std::log(rho);
-
-          delete rock;
+          log_vp(k) = std::log(vp[k]);
+          log_vs(k) = std::log(vs[k]);
+          log_rho(k) = std::log(rho[k]);
 
-          if(vp <= 0 || vs < 0 || rho <=0) {
+          if(vp[k] <= 0 || vs[k] < 0 || rho[k] <=0) {
             errTxt += "\nAt least one sample generated from the rock model obtains negative values.\n";
-            if(vp <= 0)
+            if(vp[k] <= 0)
               errTxt += "  The variance for Vp might be too large.\n\n";
-            if(vs < 0)
+            if(vs[k] < 0)
               errTxt += "  The variance for Vs might be too large.\n\n";
-            if(rho <= 0)
+            if(rho[k] <= 0)
               errTxt += "  The variance for density might be too large.\n\n";
 
             failed = true;
@@ -21,6 +21,13 @@ public:
   Rock                                * GenerateSample(const std::vector<double> & trend_params);
   Rock                                * GenerateSampleAndReservoirVariables(const std::vector<double> & trend_params, std::vector<double> &resVar );
 
+  // Draws vp.size() samples and returns their seismic parameters. Gives the same values as
+  // repeated calls to GenerateSample, but without keeping a Rock object for each sample.
+  void                                  GenerateSeismicSamples(const std::vector<double> & trend_params,
+                                                               std::vector<double>       & vp,
+                                                               std::vector<double>       & vs,
+                                                               std::vector<double>       & rho);
+
   void                                  GenerateWellSample(double                 corr,
                                                            std::vector<double> &  vp,
                                                            std::vector<double> &  vs,
@@ -65,6 +72,13 @@ protected:
   //Since there is a common start of generate sample here, that is the public function.
   //The public function then calls this overloaded function to get the specific object.
   virtual Rock                        * GenerateSamplePrivate(const std::vector<double> & trend_params) = 0;
+
+  //Seismic parameters of a sample from GenerateSamplePrivate. Rock models that can find these
+  //without building the Rock object should override this.
+  virtual void                          GenerateSeismicParamsPrivate(const std::vector<double> & trend_params,
+                                                                     double                    & vp,
+                                                                     double                    & vs,
+                                                                     double                    & rho);
                                         //This function should be called last step in constructor
                                         //for all children classes.
 
@@ -64,6 +64,24 @@ DistributionsRockGassmann::GenerateSamplePrivate(const std::vector<double> & tre
   return new_rock;
 }
 
+void
+DistributionsRockGassmann::GenerateSeismicParamsPrivate(const std::vector<double> & trend_params,
+                                                        double                    & vp,
+                                                        double                    & vs,
+                                                        double                    & rho)
+{
+  DryRock * dryrock = distr_dryrock_->GenerateSample(trend_params);
+  Fluid   * fluid   = distr_fluid_->GenerateSample(trend_params);
+
+  // Same parameters as the RockGassmann from GetSample, without its deep copies
+  double k, mu;
+  RockGassmann::ComputeElasticParams(fluid, dryrock, k, mu, rho);
+  DEMTools::CalcSeismicParamsFromElasticParams(k, mu, rho, vp, vs);
+
+  delete fluid;
+  delete dryrock;
+}
+
 bool
 DistributionsRockGassmann::HasDistribution() const
 {
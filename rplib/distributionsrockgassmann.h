@@ -38,6 +38,11 @@ public:
 private:
   virtual Rock                                 * GenerateSamplePrivate(const std::vector<double> & trend_params);
 
+  virtual void                                   GenerateSeismicParamsPrivate(const std::vector<double> & trend_params,
+                                                                              double                    & vp,
+                                                                              double                    & vs,
+                                                                              double                    & rho);
+
   Rock                                         * GetSample(const DryRock              * dryrock,
                                                            const Fluid                * fluid);
 
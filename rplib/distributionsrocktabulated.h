@@ -43,8 +43,19 @@ private:
   // Rock is an abstract class, hence pointer must be used here. Allocated memory (using new) MUST be deleted by caller.
   virtual Rock                     * GenerateSamplePrivate(const std::vector<double> & trend_params);
 
+  virtual void                       GenerateSeismicParamsPrivate(const std::vector<double> & trend_params,
+                                                                  double                    & vp,
+                                                                  double                    & vs,
+                                                                  double                    & rho);
+
   Rock                             * GetSample(const std::vector<double> & u, const std::vector<double> & trend_params);
 
+  void                               GetSeismicParams(const std::vector<double> & u,
+                                                      const std::vector<double> & trend_params,
+                                                      double                    & vp,
+                                                      double                    & vs,
+                                                      double                    & rho) const;
+
   DistributionWithTrend       * elastic1_;
   DistributionWithTrend       * elastic2_;
   DistributionWithTrend       * density_;
@@ -4,6 +4,21 @@
 
 #include <cmath>
 
+// Constant Runge-Kutta-Fehlberg tableau. Shared read only by all calls.
+static const double ode_alpha[5] = {1.0/4.0, 3.0/8.0, 12.0/13.0, 1.0, 1.0/2.0};
+
+static const double ode_beta[5][6] = {
+  {1.0/4.0,           0.0,                0.0,              0.0,             0.0,              0.0},
+  {3.0/32.0,          9.0/32.0,           0.0,              0.0,             0.0,              0.0},
+  {1932.0/2197.0,    -7200.0/2197.0,      7296.0/2197.0,    0.0,             0.0,              0.0},
+  {8341.0/4104.0,    -32832.0/4104.0,     29440.0/4104.0,  -845.0/4104.0,    0.0,              0.0},
+  {-6080.0/20520.0,   41040.0/20520.0,   -28352.0/20520.0,  9295.0/20520.0, -5643.0/20520.0,   0.0}
+};
+
+static const double ode_gamma[2][6] = {
+  {902880.0/7618050.0,  0.0, 3953664.0/7618050.0, 3855735.0/7618050.0, -1371249.0/7618050.0,  277020.0/7618050.0},
+  {-2090.0/752400.0,    0.0, 22528.0/752400.0,    21970.0/752400.0,    -15048.0/752400.0,    -27360.0/752400.0}
+};
 
 OrdDiffEqSolver::OrdDiffEqSolver() {
 
@@ -16,68 +31,40 @@ OrdDiffEqSolver::~OrdDiffEqSolver()
 
 void
 OrdDiffEqSolver::
-Ode45(std::vector<double>                 (*func_ptr)(std::vector<double>&, double),
+Ode45(const Function &                     func,
       double                               t0,
       double                               tfinal,
-      std::vector<double>&                 y0,
+      const std::vector<double>&           y0,
       std::vector<double>&                 tout,
       std::vector< std::vector<double> >&  yout,
       double                               tol) {
 
+  std::vector<double> yfinal;
+  Integrate(func, t0, tfinal, y0, yfinal, &tout, &yout, tol);
+}
 
-  // constant matrices initialization
-  static std::vector<double> alpha(5);
-  alpha[0] = 1.0/4.0;
-  alpha[1] = 3.0/8.0;
-  alpha[2] = 12.0/13.0;
-  alpha[3] = 1.0;
-  alpha[4] = 1.0/2.0;
-
-  static std::vector< std::vector<double> > beta(5);
-
-  beta[0].resize(6, 0.0);
-  beta[0][0] = 1.0/4.0;
-
-  beta[1].resize(6, 0.0);
-  beta[1][0] = 3.0/32.0;
-  beta[1][1] = 9.0/32.0;
-
-  beta[2].resize(6, 0.0);
-  beta[2][0] = 1932.0/2197.0;
-  beta[2][1] = -7200.0/2197.0;
-  beta[2][2] = 7296.0/2197.0;
-
-  beta[3].resize(6, 0.0);
-  beta[3][0] = 8341.0/4104.0;
-  beta[3][1] = -32832.0/4104.0;
-  beta[3][2] = 29440.0/4104.0;
-  beta[3][3] = -845.0/4104.0;
-
-  beta[4].resize(6, 0.0);
-  beta[4][0] = -6080.0/20520.0;
-  beta[4][1] = 41040.0/20520.0;
-  beta[4][2] = -28352.0/20520.0;
-  beta[4][3] = 9295.0/20520.0;
-  beta[4][4] = -5643.0/20520.0;
-
-  static std::vector< std::vector<double> > gamma(2);
-
-  gamma[0].resize(6, 0.0);
-  gamma[0][0] = 902880.0/7618050.0;
-
-  gamma[0][2] = 3953664.0/7618050.0;
-  gamma[0][3] = 3855735.0/7618050.0;
-  gamma[0][4] = -1371249.0/7618050.0;
-  gamma[0][5] = 277020.0/7618050.0;
-
-  gamma[1].resize(6, 0.0);
+void
+OrdDiffEqSolver::
+Ode45(const Function &                     func,
+      double                               t0,
+      double                               tfinal,
+      const std::vector<double>&           y0,
+      std::vector<double>&                 yfinal,
+      double                               tol) {
 
-  gamma[1][0] = -2090.0/752400.0;
+  Integrate(func, t0, tfinal, y0, yfinal, NULL, NULL, tol);
+}
 
-  gamma[1][2] = 22528.0/752400.0;
-  gamma[1][3] = 21970.0/752400.0;
-  gamma[1][4] = -15048.0/752400.0;
-  gamma[1][5] = -27360.0/752400.0;
+void
+OrdDiffEqSolver::
+Integrate(const Function &                     func,
+          double                               t0,
+          double                               tfinal,
+          const std::vector<double>&           y0,
+          std::vector<double>&                 yfinal,
+          std::vector<double>*                 tout,
+          std::vector< std::vector<double> >*  yout,
+          double                               tol) {
 
   // Other initialization
   double t = t0;
@@ -85,48 +72,55 @@ Ode45(std::vector<double>                 (*func_ptr)(std::vector<double>&, doub
   double h = hmax/8.0;
   double power = 1.0/5.0;
 
-  std::vector<double> y = y0;
-  std::vector< std::vector<double> > f; // 6 x 2 matrix
-  f.resize(6);
-  for (size_t i = 0; i < f.size(); i++)
-    f[i].resize(2, 0.0);
+  size_t n = func.Dim();
+
+  // All work space is allocated here, not per step:
+  // f holds the six slopes (6 x n), y1 the intermediate states and d the error estimate.
+  std::vector<double> work(9*n, 0.0);
+  double * f  = &work[0];
+  double * y1 = f  + 6*n;
+  double * d  = y1 + n;
+  double * y  = d  + n;
 
-  unsigned int chunk = 128;
-  tout.reserve(chunk);
-  yout.reserve(chunk);
-  for (size_t i = 0; i < yout.size(); i++)
-    yout[i].reserve(y.size());
+  for (size_t i = 0; i < n; i++)
+    y[i] = y0[i];
 
-  tout.push_back(t0);
-  yout.push_back(y0);
+  if (tout != NULL) {
+    unsigned int chunk = 128;
+    tout->reserve(chunk);
+    yout->reserve(chunk);
+    tout->push_back(t0);
+    yout->push_back(y0);
+  }
 
   while (t < tfinal && (t + h) > t) {
     if (t+h > tfinal)
       h = tfinal - t; //NBNB fjellvoll is this correct in c++
 
     //Compute the slopes
-    std::vector<double> temp = (*func_ptr)(y, t);
-    f[0] = temp;
+    func.Evaluate(y, t, f);
 
     for (unsigned int j = 0; j < 5; j++) {
-      double t1 = t + alpha[j]*h;
-      std::vector<double> y1(y);
-      CalcVector(beta, f, h, j, y1);
-      temp = (*func_ptr)(y1, t1);
-      f[j+1] = temp;
+      double t1 = t + ode_alpha[j]*h;
+      for (size_t i = 0; i < n; i++)
+        y1[i] = y[i];
+      CalcVector(ode_beta[j], f, n, h, y1);
+      func.Evaluate(y1, t1, f + (j+1)*n);
     } // end loop j
 
     //estimate error and acceptable error
-    std::vector<double> d(y.size(), 0.0);
-    CalcVector(gamma, f, h, 1, d);
+    for (size_t i = 0; i < n; i++)
+      d[i] = 0.0;
+    CalcVector(ode_gamma[1], f, n, h, d);
 
     double delta = std::abs(d[0]);
-    if (std::abs(d[1]) > delta)
-      delta = std::abs(d[1]);
-
-    double tau = std::abs(y[0]);
-    if (std::abs(y[1]) > tau)
-      tau = std::abs(y[1]);
+    double tau   = std::abs(y[0]);
+    for (size_t i = 1; i < n; i++) {
+      if (std::abs(d[i]) > delta)
+        delta = std::abs(d[i]);
+      if (std::abs(y[i]) > tau)
+        tau = std::abs(y[i]);
+    }
 
     if (1.0 > tau)
       tau = 1.0;
@@ -135,9 +129,11 @@ Ode45(std::vector<double>                 (*func_ptr)(std::vector<double>&, doub
 
     if (delta <= tau) {
       t += h;
-      CalcVector(gamma, f, h, 0, y);
-      tout.push_back(t);
-      yout.push_back(y);
+      CalcVector(ode_gamma[0], f, n, h, y);
+      if (tout != NULL) {
+        tout->push_back(t);
+        yout->push_back(std::vector<double>(y, y + n));
+      }
     }
 
     if (delta != 0.0) {
@@ -150,18 +146,19 @@ Ode45(std::vector<double>                 (*func_ptr)(std::vector<double>&, doub
   if (t < tfinal)
     throw NRLib::Exception("DEM: Singularity likely.");
 
+  yfinal.assign(y, y + n);
 }
 
 
 void
 OrdDiffEqSolver::
-CalcVector(const std::vector< std::vector<double> >& matrix,
-           const std::vector< std::vector<double> >& f,
+CalcVector(const double                              matrix[6],
+           const double *                            f,
+           size_t                                    n,
            double                                    h,
-           size_t                                    row,
-           std::vector<double>&                      y) {
+           double *                                  y) {
 
-  for (unsigned int i1 = 0; i1 < y.size(); i1++)
+  for (size_t i1 = 0; i1 < n; i1++)
     for (unsigned int j1 = 0; j1 < 6; j1++)
-      y[i1] += h*matrix[row][j1]*f[j1][i1];
+      y[i1] += h*matrix[j1]*f[j1*n + i1];
 }
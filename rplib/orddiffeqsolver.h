@@ -9,22 +9,50 @@ class OrdDiffEqSolver {
    OrdDiffEqSolver();
    ~OrdDiffEqSolver();
 
+ // Right hand side f(y, t) of the system y' = f(y, t). Evaluate must not change the
+ // object, so that the same function may be integrated from several threads at once.
+ class Function {
+  public:
+   virtual        ~Function() {}
+   virtual size_t  Dim()                                                  const = 0;
+   virtual void    Evaluate(const double * y, double t, double * yprime)  const = 0;
+ };
+
  //ODE45 integrates a system of ordinary differential equations using
  //4th and 5th order Runge-Kutta formulas.
- static void Ode45(std::vector<double>                 (func_ptr)(std::vector<double>&, double),
+ //The solver has no state of its own and allocates its work space once per call,
+ //so it is reentrant as long as func is.
+ static void Ode45(const Function &                     func,
                    double                               t0,
                    double                               tfinal,
-                   std::vector<double>&                 y0,
+                   const std::vector<double>&           y0,
                    std::vector<double>&                 tout,
                    std::vector< std::vector<double> >&  yout,
                    double                               tol = 1.e-6);
 
+ //As above, but only returns the solution at tfinal.
+ static void Ode45(const Function &                     func,
+                   double                               t0,
+                   double                               tfinal,
+                   const std::vector<double>&           y0,
+                   std::vector<double>&                 yfinal,
+                   double                               tol = 1.e-6);
+
 private:
-static void CalcVector(const std::vector< std::vector<double> >& matrix,
-                       const std::vector< std::vector<double> >& f,
+static void Integrate(const Function &                     func,
+                      double                               t0,
+                      double                               tfinal,
+                      const std::vector<double>&           y0,
+                      std::vector<double>&                 yfinal,
+                      std::vector<double>*                 tout,
+                      std::vector< std::vector<double> >*  yout,
+                      double                               tol);
+
+static void CalcVector(const double                              matrix[6],
+                       const double *                            f,
+                       size_t                                    n,
                        double                                    h,
-                       size_t                                    row,
-                       std::vector<double>&                      y);
+                       double *                                  y);
 
 };
 #endif
@@ -77,22 +77,31 @@ RockGassmann::SetPorosity(double porosity) {
 
 void
 RockGassmann::ComputeSeismicAndElasticParams() {
+  ComputeElasticParams(fluid_, dryrock_, k_, mu_, rho_);
+  DEMTools::CalcSeismicParamsFromElasticParams(k_, mu_, rho_, vp_, vs_);
+}
+
+void
+RockGassmann::ComputeElasticParams(const Fluid   * fluid,
+                                   const DryRock * dryrock,
+                                   double        & k,
+                                   double        & mu,
+                                   double        & rho) {
   double k_dry, mu_dry, rho_dry;
-  dryrock_->GetElasticParams(k_dry, mu_dry, rho_dry);
+  dryrock->GetElasticParams(k_dry, mu_dry, rho_dry);
 
   double k_fluid, rho_fluid;
-  fluid_->GetElasticParams(k_fluid, rho_fluid);
+  fluid->GetElasticParams(k_fluid, rho_fluid);
 
-  mu_ = mu_dry; // mu and porosity are assumed unchanged in Gassmann model.
+  mu = mu_dry; // mu and porosity are assumed unchanged in Gassmann model.
 
-  double total_porosity   = dryrock_->GetTotalPorosity();
-  double mineral_moduli_k = dryrock_->GetMineralModuliK();
+  double total_porosity   = dryrock->GetTotalPorosity();
+  double mineral_moduli_k = dryrock->GetMineralModuliK();
 
   double temp1 = (1 - k_dry/mineral_moduli_k)*(1 - k_dry/mineral_moduli_k);
 
-  k_ = k_dry + temp1/(total_porosity/k_fluid + (1 - total_porosity)/mineral_moduli_k + k_dry/(mineral_moduli_k*mineral_moduli_k));
+  k = k_dry + temp1/(total_porosity/k_fluid + (1 - total_porosity)/mineral_moduli_k + k_dry/(mineral_moduli_k*mineral_moduli_k));
 
-  rho_ = rho_dry + total_porosity*rho_fluid;
-  DEMTools::CalcSeismicParamsFromElasticParams(k_, mu_, rho_, vp_, vs_);
+  rho = rho_dry + total_porosity*rho_fluid;
 }
 
@@ -31,6 +31,14 @@ RockGassmann();
 
   virtual void                          SetPorosity(double porosity);
 
+                                        // Elastic parameters of the Gassmann rock made from fluid and dryrock,
+                                        // found without building the rock.
+  static void                           ComputeElasticParams(const Fluid   * fluid,
+                                                             const DryRock * dryrock,
+                                                             double        & k,
+                                                             double        & mu,
+                                                             double        & rho);
+
 private:
                                         //Copy constructor for getting base class variables , used by Clone:
                                         RockGassmann(const RockGassmann & rhs) : Rock(rhs) {}
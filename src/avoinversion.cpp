@@ -21,6 +21,7 @@
 #include "src/vario.h"
 #include "src/krigingdata3d.h"
 #include "src/covgridseparated.h"
+#include "src/factoredpostcov.h"
 #include "src/krigingadmin.h"
 #include "src/faciesprob.h"
 #include "src/definitions.h"
@@ -106,6 +107,7 @@ AVOInversion::AVOInversion(ModelSettings           * modelSettings,
   scaleWarning_      = 0;
   scaleWarningText_  = "";
   sigmamdnew_        = NULL;
+  factoredPostCov_   = NULL;
   interval_name_     = modelGeneral_->GetIntervalName();
 
   errThetaCov_       = modelAVOdynamic->GetErrThetaCov();
@@ -295,7 +297,8 @@ AVOInversion::AVOInversion(ModelSettings           * modelSettings,
                                          activeAngles,
                                          this,
                                          modelAVOdynamic->GetLocalNoiseScales(),
-                                         seismicParameters);
+                                         seismicParameters,
+                                         modelSettings->getNumberOfThreads());
     if (modelSettings->getEstimateFaciesProb()) {
       bool useFilter = modelSettings->getUseFilterForFaciesProb();
       computeFaciesProb(spat_real_well_filter, spat_synt_well_filter, useFilter, seismicParameters);
@@ -325,6 +328,9 @@ AVOInversion::AVOInversion(ModelSettings           * modelSettings,
   seismicParameters.SetPostCovVs00(postCovVs00_);
   seismicParameters.SetPostCovRho00(postCovRho00_);
 
+  delete factoredPostCov_;
+  factoredPostCov_ = NULL;
+
   delete spat_real_well_filter;
   delete spat_synt_well_filter;
 }
@@ -501,8 +507,13 @@ AVOInversion::divideDataByScaleWavelet(const SeismicParametersHolder & seismicPa
   Wavelet1D* localWavelet ;
 
   flag   = FFTW_ESTIMATE | FFTW_IN_PLACE;
-  plan1  = rfftwnd_create_plan(1,&nzp_,FFTW_REAL_TO_COMPLEX,flag);
-  plan2  = rfftwnd_create_plan(1,&nzp_,FFTW_COMPLEX_TO_REAL,flag);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    plan1  = rfftwnd_create_plan(1,&nzp_,FFTW_REAL_TO_COMPLEX,flag);
+    plan2  = rfftwnd_create_plan(1,&nzp_,FFTW_COMPLEX_TO_REAL,flag);
+  }
 
   for (l=0 ; l< ntheta_ ; l++ )
   {
@@ -619,8 +630,13 @@ AVOInversion::divideDataByScaleWavelet(const SeismicParametersHolder & seismicPa
 
   fftw_free(rData);
   fftw_free(adjustmentFactor);
-  fftwnd_destroy_plan(plan1);
-  fftwnd_destroy_plan(plan2);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(plan1);
+    fftwnd_destroy_plan(plan2);
+  }
 }
 
 
@@ -641,7 +657,11 @@ AVOInversion::computeAdjustmentFactor(fftw_complex                  * adjustment
     // computes the time covariance for reflection coefficients rcCovT can be globaly stored
   fftw_real* rcCovT;
   int flag   = FFTW_ESTIMATE | FFTW_IN_PLACE;
-  rfftwnd_plan plan1  = rfftwnd_create_plan(1, &nzp_ ,FFTW_REAL_TO_COMPLEX,flag);
+  rfftwnd_plan plan1;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  plan1  = rfftwnd_create_plan(1, &nzp_ ,FFTW_REAL_TO_COMPLEX,flag);
   rcCovT = static_cast<fftw_real*>(fftw_malloc(2*(nzp_/2+1)*sizeof(fftw_real)));
   fftw_complex * rcSpecIntens = reinterpret_cast<fftw_complex*>(rcCovT);
 
@@ -714,6 +734,9 @@ AVOInversion::computeAdjustmentFactor(fftw_complex                  * adjustment
   delete errorSmooth;
   delete errorSmooth2;
   delete errorSmooth3;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   fftwnd_destroy_plan(plan1);
   fftw_free(rcCovT);
 }
@@ -733,8 +756,13 @@ AVOInversion::multiplyDataByScaleWaveletAndWriteToFile(const std::string & typeN
   cData  = reinterpret_cast<fftw_complex*>(rData);
 
   flag   = FFTW_ESTIMATE | FFTW_IN_PLACE;
-  plan1  = rfftwnd_create_plan(1, &nzp_ ,FFTW_REAL_TO_COMPLEX,flag);
-  plan2  = rfftwnd_create_plan(1,&nzp_,FFTW_COMPLEX_TO_REAL,flag);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    plan1  = rfftwnd_create_plan(1, &nzp_ ,FFTW_REAL_TO_COMPLEX,flag);
+    plan2  = rfftwnd_create_plan(1,&nzp_,FFTW_COMPLEX_TO_REAL,flag);
+  }
 
   Wavelet1D* localWavelet;
 
@@ -785,8 +813,13 @@ AVOInversion::multiplyDataByScaleWaveletAndWriteToFile(const std::string & typeN
   }
 
   fftw_free(rData);
-  fftwnd_destroy_plan(plan1);
-  fftwnd_destroy_plan(plan2);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(plan1);
+    fftwnd_destroy_plan(plan2);
+  }
 }
 
 
@@ -799,48 +832,7 @@ AVOInversion::computePostMeanResidAndFFTCov(ModelGeneral            * modelGener
 
   double wall=0.0, cpu=0.0;
   TimeKit::getTime(wall,cpu);
-  int i,j,k,l;
-
-  fftw_complex * kW          = new fftw_complex[ntheta_];
-
-  fftw_complex * errMult1    = new fftw_complex[ntheta_];
-  fftw_complex * errMult2    = new fftw_complex[ntheta_];
-  fftw_complex * errMult3    = new fftw_complex[ntheta_];
-
-  fftw_complex * ijkData     = new fftw_complex[ntheta_];
-  fftw_complex * ijkDataMean = new fftw_complex[ntheta_];
-  fftw_complex * ijkRes      = new fftw_complex[ntheta_];
-  fftw_complex * ijkMean     = new fftw_complex[3];
-  fftw_complex * ijkAns      = new fftw_complex[3];
-  fftw_complex   kD,kD3;
-
-  fftw_complex**  K  = new fftw_complex*[ntheta_];
-  for (i = 0; i < ntheta_; i++)
-    K[i] = new fftw_complex[3];
-
-  fftw_complex**  KS  = new fftw_complex*[ntheta_];
-  for (i = 0; i < ntheta_; i++)
-    KS[i] = new fftw_complex[3];
-
-  fftw_complex**  KScc  = new fftw_complex*[3]; // cc - complex conjugate (and transposed)
-  for (i = 0; i < 3; i++)
-    KScc[i] = new fftw_complex[ntheta_];
-
-  fftw_complex**  parVar = new fftw_complex*[3];
-  for (i = 0; i < 3; i++)
-    parVar[i] = new fftw_complex[3];
-
-  fftw_complex**  margVar = new fftw_complex*[ntheta_];
-  for (i = 0; i < ntheta_; i++)
-    margVar[i] = new fftw_complex[ntheta_];
-
-  fftw_complex**  errVar = new fftw_complex*[ntheta_];
-  for (i = 0; i < ntheta_; i++)
-    errVar[i] = new fftw_complex[ntheta_];
-
-  fftw_complex** reduceVar = new fftw_complex*[3];
-  for (i = 0; i < 3; i++)
-    reduceVar[i]= new fftw_complex[3];
+  int l;
 
   Wavelet1D * diff1Operator = new Wavelet1D(Wavelet::FIRSTORDERFORWARDDIFF,nz_,nzp_);
   Wavelet1D * diff2Operator = new Wavelet1D(diff1Operator,Wavelet::FIRSTORDERBACKWARDDIFF);
@@ -919,10 +911,6 @@ AVOInversion::computePostMeanResidAndFFTCov(ModelGeneral            * modelGener
 
   // Computes the posterior mean first below the covariance is computed
   // To avoid to many grids in memory at the same time
-  double priorVarVp,justfactor;
-  int cholFlag;
-  float realFrequency;
-
   Wavelet1D** seisWaveletForNorm = new Wavelet1D*[ntheta_];
   for (l = 0; l < ntheta_; l++)
   {
@@ -933,163 +921,243 @@ AVOInversion::computePostMeanResidAndFFTCov(ModelGeneral            * modelGener
     }
   }
 
+  // Copy matrix A to float**
+  float ** A = new float * [ntheta_];
+  for (int i = 0; i < ntheta_; i++) {
+    A[i] = new float[3];
+    for (int j = 0; j < 3; j++)
+      A[i][j] = static_cast<float>(A_(i,j));
+  }
+
+  //
+  // The frequency planes k are independent, and are distributed as slabs between
+  // the threads. Each thread has its own work matrices, and grid values are
+  // accessed by index rather than through the sequential getNext/setNext cursor.
+  // The result is therefore independent of the number of threads. Grids stored
+  // on file only support sequential access, so then we use a single thread.
+  //
+  // When several intervals are inverted at the same time, their progress bars
+  // would be mixed, so the bar is only drawn when this is the only inversion.
+  //
+  bool showProgress = true;
+#ifdef PARALLEL
+  int n_threads = 1;
+  if (!fileGrid_)
+    n_threads = std::max(modelSettings->getNumberOfThreads(), 1);
+  showProgress = (omp_in_parallel() == 0);
+#endif
+
   LogKit::LogFormatted(LogKit::Low,"\nBuilding posterior distribution:");
   float monitorSize = std::max(1.0f, static_cast<float>(nzp_)*0.02f);
   float nextMonitor = monitorSize;
-  std::cout
-    << "\n  0%       20%       40%       60%       80%      100%"
-    << "\n  |    |    |    |    |    |    |    |    |    |    |  "
-    << "\n  ^";
+  int   nPlanesDone = 0;
+  if (showProgress)
+    std::cout
+      << "\n  0%       20%       40%       60%       80%      100%"
+      << "\n  |    |    |    |    |    |    |    |    |    |    |  "
+      << "\n  ^";
 
-  for (k = 0; k < nzp_; k++)
+#ifdef PARALLEL
+#pragma omp parallel num_threads(n_threads)
+#endif
   {
-    realFrequency = static_cast<float>((nz_*1000.0f)/(simbox_->getlz()*nzp_)*std::min(k,nzp_-k)); // the physical frequency
-    kD = diff1Operator->getCAmp(k);                      // defines content of kD
-    if(simbox_->getIsConstantThick())
-    {
-      // defines content of K=WDA
-      fillkW(k, kW, seisWavelet_);
-
-      lib_matrProdScalVecCpx(kD, kW, ntheta_);
-
-      // Copy matrix A to float**
-      float ** A = new float * [ntheta_];
-      for (i = 0; i < ntheta_; i++)
-        A[i] = new float[3];
-      for (i = 0; i < ntheta_; i++){
-        for (j = 0; j < 3; j++){
-          A[i][j] = static_cast<float>(A_(i,j));
-        }
-      }
-
-      lib_matrProdDiagCpxR(kW, A, ntheta_, 3, K); // defines content of (WDA) K
+    fftw_complex * kW          = new fftw_complex[ntheta_];
+
+    fftw_complex * errMult1    = new fftw_complex[ntheta_];
+    fftw_complex * errMult2    = new fftw_complex[ntheta_];
+    fftw_complex * errMult3    = new fftw_complex[ntheta_];
+
+    fftw_complex * ijkData     = new fftw_complex[ntheta_];
+    fftw_complex * ijkDataMean = new fftw_complex[ntheta_];
+    fftw_complex * ijkRes      = new fftw_complex[ntheta_];
+    fftw_complex * ijkMean     = new fftw_complex[3];
+    fftw_complex * ijkAns      = new fftw_complex[3];
+    fftw_complex   kD,kD3;
+
+    fftw_complex ** K         = lib_matrAllocCpx(ntheta_, 3);
+    fftw_complex ** KS        = lib_matrAllocCpx(ntheta_, 3);
+    fftw_complex ** parVar    = lib_matrAllocCpx(3, 3);
+    fftw_complex ** margVar   = lib_matrAllocCpx(ntheta_, ntheta_);
+    fftw_complex ** errVar    = lib_matrAllocCpx(ntheta_, ntheta_);
+    fftw_complex ** reduceVar = lib_matrAllocCpx(3, 3);
 
-      for (i = 0; i < ntheta_; i++)
-        delete [] A[i];
-      delete [] A;
-
-      // defines error-term multipliers
-      fillkWNorm(k,errMult1,seisWaveletForNorm);         // defines input of  (kWNorm) errMult1
-      fillkWNorm(k,errMult2,errorSmooth3);               // defines input of  (kWD3Norm) errMult2
-      lib_matrFillOnesVecCpx(errMult3,ntheta_);          // defines content of errMult3
-    }
-    else
+#ifdef PARALLEL
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int k = 0; k < nzp_; k++)
     {
-      kD3 = diff3Operator->getCAmp(k);                   // defines  kD3
-
-      // Copy matrix A to float **
-      float ** A = new float * [ntheta_];
-      for (i = 0; i < ntheta_; i++)
-        A[i] = new float[3];
-      for (i = 0; i < ntheta_; i++){
-        for (j = 0; j < 3; j++){
-          A[i][j] = static_cast<float>(A_(i,j));
-        }
-      }
+      float realFrequency = static_cast<float>((nz_*1000.0f)/(simbox_->getlz()*nzp_)*std::min(k,nzp_-k)); // the physical frequency
+      bool  invert_frequency = realFrequency > lowCut_*simbox_->getMinRelThick() &&  realFrequency < highCut_;
 
-      // defines content of K = DA
-      lib_matrFillValueVecCpx(kD, errMult1, ntheta_);    // errMult1 used as dummy
-      lib_matrProdDiagCpxR(errMult1, A, ntheta_, 3, K); // defines content of ( K = DA )
+      kD = diff1Operator->getCAmp(k);                      // defines content of kD
+      if(simbox_->getIsConstantThick())
+      {
+        // defines content of K=WDA
+        fillkW(k, kW, seisWavelet_);
 
-      for (i = 0; i < ntheta_; i++)
-        delete [] A[i];
-      delete [] A;
+        lib_matrProdScalVecCpx(kD, kW, ntheta_);
 
-      // defines error-term multipliers
-      lib_matrFillOnesVecCpx(errMult1,ntheta_);          // defines content of errMult1
-      for (l=0; l < ntheta_; l++)
-      {
-        errMult1[l].re /= seisWavelet_[l]->getNorm();    // defines content of errMult1
-      }
+        lib_matrProdDiagCpxR(kW, A, ntheta_, 3, K); // defines content of (WDA) K
 
-      lib_matrFillValueVecCpx(kD3,errMult2,ntheta_);     // defines content of errMult2
-      for (l=0; l < ntheta_; l++)
-      {
-        //float errorSmoothMult =  1.0f/errorSmooth3[l]->findNormWithinFrequencyBand(lowCut_,highCut_); // defines scaleFactor;
-        float errorSmoothMult =  1.0f/errorSmooth3[l]->getNorm(); // defines scaleFactor;
-        errMult2[l].re  *= errorSmoothMult; // defines content of errMult2
-        errMult2[l].im  *= errorSmoothMult; // defines content of errMult2
+        // defines error-term multipliers
+        fillkWNorm(k,errMult1,seisWaveletForNorm);         // defines input of  (kWNorm) errMult1
+        fillkWNorm(k,errMult2,errorSmooth3);               // defines input of  (kWD3Norm) errMult2
+        lib_matrFillOnesVecCpx(errMult3,ntheta_);           // defines content of errMult3
       }
-      fillInverseAbskWRobust(k,errMult3,seisWaveletForNorm);// defines content of errMult3
-    }
+      else
+      {
+        kD3 = diff3Operator->getCAmp(k);                   // defines  kD3
+
+        // defines content of K = DA
+        lib_matrFillValueVecCpx(kD, errMult1, ntheta_);    // errMult1 used as dummy
+        lib_matrProdDiagCpxR(errMult1, A, ntheta_, 3, K); // defines content of ( K = DA )
 
-    for ( j = 0; j < nyp_; j++) {
-      for ( i = 0; i < cnxp; i++) {
-        ijkMean[0] = meanVp_ ->getNextComplex();
-        ijkMean[1] = meanVs_ ->getNextComplex();
-        ijkMean[2] = meanRho_->getNextComplex();
+        // defines error-term multipliers
+        lib_matrFillOnesVecCpx(errMult1,ntheta_);          // defines content of errMult1
+        for (int m=0; m < ntheta_; m++)
+        {
+          errMult1[m].re /= seisWavelet_[m]->getNorm();    // defines content of errMult1
+        }
 
-        for (l = 0; l < ntheta_; l++ )
+        lib_matrFillValueVecCpx(kD3,errMult2,ntheta_);     // defines content of errMult2
+        for (int m=0; m < ntheta_; m++)
         {
-          ijkData[l] = seisData_[l]->getNextComplex();
-          ijkRes[l]  = ijkData[l];
+          //float errorSmoothMult =  1.0f/errorSmooth3[m]->findNormWithinFrequencyBand(lowCut_,highCut_); // defines scaleFactor;
+          float errorSmoothMult =  1.0f/errorSmooth3[m]->getNorm(); // defines scaleFactor;
+          errMult2[m].re  *= errorSmoothMult; // defines content of errMult2
+          errMult2[m].im  *= errorSmoothMult; // defines content of errMult2
         }
+        fillInverseAbskWRobust(k,errMult3,seisWaveletForNorm);// defines content of errMult3
+      }
 
-        seismicParameters.getNextParameterCovariance(parVar);
-        bool invert_frequency = realFrequency > lowCut_*simbox_->getMinRelThick() &&  realFrequency < highCut_;
+      for (int j = 0; j < nyp_; j++) {
+        for (int i = 0; i < cnxp; i++) {
+          size_t       index = static_cast<size_t>(i) + static_cast<size_t>(j)*static_cast<size_t>(cnxp) + static_cast<size_t>(k)*static_cast<size_t>(cnxp)*static_cast<size_t>(nyp_);
+          fftw_complex ijkErrCorr;
+
+          if (fileGrid_) {
+            ijkMean[0] = meanVp_ ->getNextComplex();
+            ijkMean[1] = meanVs_ ->getNextComplex();
+            ijkMean[2] = meanRho_->getNextComplex();
+            for (int m = 0; m < ntheta_; m++)
+              ijkData[m] = seisData_[m]->getNextComplex();
+            seismicParameters.getNextParameterCovariance(parVar);
+            ijkErrCorr = errCorr_->getNextComplex();
+          }
+          else {
+            ijkMean[0] = meanVp_ ->getComplexValue(index);
+            ijkMean[1] = meanVs_ ->getComplexValue(index);
+            ijkMean[2] = meanRho_->getComplexValue(index);
+            for (int m = 0; m < ntheta_; m++)
+              ijkData[m] = seisData_[m]->getComplexValue(index);
+            seismicParameters.getParameterCovariance(parVar, index);
+            ijkErrCorr = errCorr_->getComplexValue(index);
+          }
 
-        priorVarVp = parVar[0][0].re;
+          for (int m = 0; m < ntheta_; m++)
+            ijkRes[m] = ijkData[m];
 
-        getNextErrorVariance(errVar, errMult1, errMult2, errMult3, ntheta_, wnc_, errThetaCov_, invert_frequency);
+          computeErrorVariance(errVar, ijkErrCorr, errMult1, errMult2, errMult3, ntheta_, wnc_, errThetaCov_, invert_frequency);
 
-        if(invert_frequency){
-          lib_matrProdCpx(K, parVar , ntheta_, 3 ,3, KS);              //  KS is defined here
-          lib_matrProdAdjointCpx(KS, K, ntheta_, 3 ,ntheta_, margVar); // margVar = (K)S(K)' is defined here
-          lib_matrAddMatCpx(errVar, ntheta_,ntheta_, margVar);         // errVar  is added to margVar = (WDA)S(WDA)'  + errVar
+          if(invert_frequency){
+            lib_matrProdCpx(K, parVar , ntheta_, 3 ,3, KS);              //  KS is defined here
+            lib_matrProdAdjointCpx(KS, K, ntheta_, 3 ,ntheta_, margVar); // margVar = (K)S(K)' is defined here
+            lib_matrAddMatCpx(errVar, ntheta_,ntheta_, margVar);         // errVar  is added to margVar = (WDA)S(WDA)'  + errVar
 
-          cholFlag=lib_matrCholCpx(ntheta_,margVar);                   // Choleskey factor of margVar is Defined
+            int cholFlag=lib_matrCholCpx(ntheta_,margVar);               // Choleskey factor L of margVar is Defined
 
-          if(cholFlag==0)
-          { // then it is ok else posterior is identical to prior
+            if(cholFlag==0)
+            { // then it is ok else posterior is identical to prior
+              //
+              // With margVar = LL' we have (KS)'margVar^{-1}(KS) = (L^{-1}KS)'(L^{-1}KS),
+              // so only forward substitutions are needed for the posterior.
+              //
+              lib_matrProdMatVecCpx(K,ijkMean, ntheta_, 3, ijkDataMean); //  defines content of ijkDataMean
+              lib_matrSubtVecCpx(ijkDataMean, ntheta_, ijkData);         //  redefines content of ijkData
 
-            lib_matrAdjoint(KS,ntheta_,3,KScc);                        //  WDAScc is adjoint of WDAS
-            lib_matrAXeqBMatCpx(ntheta_, margVar, KS, 3);              // redefines WDAS
-            lib_matrProdCpx(KScc,KS,3,ntheta_,3,reduceVar);            // defines reduceVar
-            //double hj=1000000.0;
-            //if(reduceVar[0][0].im!=0)
-            // hj = MAXIM(reduceVar[0][0].re/reduceVar[0][0].im,-reduceVar[0][0].re/reduceVar[0][0].im); //NBNB DEBUG
-            lib_matrSubtMatCpx(reduceVar,3,3,parVar);                  // redefines parVar as the posterior solution
+              lib_matrLXeqBMatCpx(ntheta_, margVar, KS, 3);              // redefines WDAS as L^{-1}WDAS
+              lib_matrLxeqbCpx(ntheta_, margVar, ijkData);               // redefines ijkData as L^{-1}ijkData
 
-            lib_matrProdMatVecCpx(K,ijkMean, ntheta_, 3, ijkDataMean); //  defines content of ijkDataMean
-            lib_matrSubtVecCpx(ijkDataMean, ntheta_, ijkData);         //  redefines content of ijkData
+              lib_matrProdAdjointSelfCpx(KS, ntheta_, 3, reduceVar);     // defines reduceVar
+              lib_matrSubtMatCpx(reduceVar,3,3,parVar);                  // redefines parVar as the posterior solution
 
-            lib_matrProdAdjointMatVecCpx(KS,ijkData,3,ntheta_,ijkAns); // defines ijkAns
+              lib_matrProdAdjointMatVecCpx(KS,ijkData,3,ntheta_,ijkAns); // defines ijkAns
 
-            lib_matrAddVecCpx(ijkAns, 3,ijkMean);                      // redefines ijkMean
-            lib_matrProdMatVecCpx(K,ijkMean, ntheta_, 3, ijkData);     // redefines ijkData
-            lib_matrSubtVecCpx(ijkData, ntheta_,ijkRes);               // redefines ijkRes
+              lib_matrAddVecCpx(ijkAns, 3,ijkMean);                      // redefines ijkMean
+              lib_matrProdMatVecCpx(K,ijkMean, ntheta_, 3, ijkData);     // redefines ijkData
+              lib_matrSubtVecCpx(ijkData, ntheta_,ijkRes);               // redefines ijkRes
+            }
           }
 
-          // quality control DEBUG
-          if(priorVarVp*4 < ijkAns[0].re*ijkAns[0].re + ijkAns[0].re*ijkAns[0].re)
-          {
-            justfactor = sqrt(ijkAns[0].re*ijkAns[0].re + ijkAns[0].re*ijkAns[0].re)/sqrt(priorVarVp);
+          if (fileGrid_) {
+            postVp_ ->setNextComplex(ijkMean[0]);
+            postVs_ ->setNextComplex(ijkMean[1]);
+            postRho_->setNextComplex(ijkMean[2]);
+            postCovVp ->setNextComplex(parVar[0][0]);
+            postCovVs ->setNextComplex(parVar[1][1]);
+            postCovRho->setNextComplex(parVar[2][2]);
+            postCrCovVpVs ->setNextComplex(parVar[0][1]);
+            postCrCovVpRho->setNextComplex(parVar[0][2]);
+            postCrCovVsRho->setNextComplex(parVar[1][2]);
+
+            for (int m = 0; m < ntheta_; m++)
+              seisData_[m]->setNextComplex(ijkRes[m]);
+          }
+          else {
+            postVp_ ->setComplexValue(index, ijkMean[0]);
+            postVs_ ->setComplexValue(index, ijkMean[1]);
+            postRho_->setComplexValue(index, ijkMean[2]);
+            postCovVp ->setComplexValue(index, parVar[0][0]);
+            postCovVs ->setComplexValue(index, parVar[1][1]);
+            postCovRho->setComplexValue(index, parVar[2][2]);
+            postCrCovVpVs ->setComplexValue(index, parVar[0][1]);
+            postCrCovVpRho->setComplexValue(index, parVar[0][2]);
+            postCrCovVsRho->setComplexValue(index, parVar[1][2]);
+
+            for (int m = 0; m < ntheta_; m++)
+              seisData_[m]->setComplexValue(index, ijkRes[m]);
           }
         }
+      }
 
-        postVp_ ->setNextComplex(ijkMean[0]);
-        postVs_ ->setNextComplex(ijkMean[1]);
-        postRho_->setNextComplex(ijkMean[2]);
-        postCovVp ->setNextComplex(parVar[0][0]);
-        postCovVs ->setNextComplex(parVar[1][1]);
-        postCovRho->setNextComplex(parVar[2][2]);
-        postCrCovVpVs ->setNextComplex(parVar[0][1]);
-        postCrCovVpRho->setNextComplex(parVar[0][2]);
-        postCrCovVsRho->setNextComplex(parVar[1][2]);
-
-        for (l=0;l<ntheta_;l++)
-          seisData_[l]->setNextComplex(ijkRes[l]);
+      // Log progress
+#ifdef PARALLEL
+#pragma omp critical(avo_inversion_progress)
+#endif
+      {
+        nPlanesDone++;
+        if (showProgress && nPlanesDone >= static_cast<int>(nextMonitor))
+        {
+          nextMonitor += monitorSize;
+          std::cout << "^";
+          fflush(stdout);
+        }
       }
     }
-    // Log progress
-    if (k+1 >= static_cast<int>(nextMonitor))
-    {
-      nextMonitor += monitorSize;
-      std::cout << "^";
-      fflush(stdout);
-    }
+
+    delete [] kW;
+    delete [] errMult1;
+    delete [] errMult2;
+    delete [] errMult3;
+    delete [] ijkData;
+    delete [] ijkDataMean;
+    delete [] ijkRes;
+    delete [] ijkMean;
+    delete [] ijkAns;
+
+    lib_matrFreeCpx(K);
+    lib_matrFreeCpx(KS);
+    lib_matrFreeCpx(parVar);
+    lib_matrFreeCpx(margVar);
+    lib_matrFreeCpx(errVar);
+    lib_matrFreeCpx(reduceVar);
   }
-  std::cout << "\n";
+  if (showProgress)
+    std::cout << "\n";
+
+  for (int i = 0; i < ntheta_; i++)
+    delete [] A[i];
+  delete [] A;
 
   //  time(&timeend);
   // LogKit::LogFormatted(LogKit::Low,"\n Core inversion finished after %ld seconds ***\n",timeend-timestart);
@@ -1185,47 +1253,19 @@ AVOInversion::computePostMeanResidAndFFTCov(ModelGeneral            * modelGener
     writeBWPredicted();
   }
   //delete [] seisData_;
-  delete [] kW;
-  delete [] errMult1;
-  delete [] errMult2;
-  delete [] errMult3;
-  delete [] ijkData;
-  delete [] ijkDataMean;
-  delete [] ijkRes;
-  delete [] ijkMean ;
-  delete [] ijkAns;
   delete    diff1Operator;
   delete    diff3Operator;
 
-  for (i = 0; i < ntheta_; i++)
+  for (l = 0; l < ntheta_; l++)
   {
-    delete[]  K[i];
-    delete[]  KS[i];
-    delete[]  margVar[i] ;
-    delete[] errVar[i] ;
-    delete errorSmooth3[i];
-    delete errorSmooth[i];
-    delete seisWaveletForNorm[i];
+    delete errorSmooth3[l];
+    delete errorSmooth[l];
+    delete seisWaveletForNorm[l];
   }
-
-  delete[] K;
-  delete[] KS;
-  delete[] margVar;
-  delete[] errVar  ;
   delete[] errorSmooth3;
   delete[] errorSmooth;
   delete[] seisWaveletForNorm;
 
-  for (i = 0; i < 3; i++)
-  {
-    delete[] KScc[i];
-    delete[] parVar[i] ;
-    delete[] reduceVar[i];
-  }
-  delete[] KScc;
-  delete[] parVar;
-  delete[] reduceVar;
-
   Timings::addTimeInversion(wall,cpu);
   return(0);
 }
@@ -1233,7 +1273,8 @@ AVOInversion::computePostMeanResidAndFFTCov(ModelGeneral            * modelGener
 
 //--------------------------------------------------------------------
 void
-AVOInversion::getNextErrorVariance(fftw_complex **& errVar,
+AVOInversion::computeErrorVariance(fftw_complex **& errVar,
+                                   fftw_complex     ijkErrCorr,
                                    fftw_complex   * errMult1,
                                    fftw_complex   * errMult2,
                                    fftw_complex   * errMult3,
@@ -1243,11 +1284,8 @@ AVOInversion::getNextErrorVariance(fftw_complex **& errVar,
                                    bool             invert_frequency) const
 {
   fftw_complex ijkErrLam;
-  fftw_complex ijkTmp;
-
-  ijkTmp = errCorr_->getNextComplex();
 
-  ijkErrLam.re        = float( sqrt(ijkTmp.re * ijkTmp.re));
+  ijkErrLam.re        = float( sqrt(ijkErrCorr.re * ijkErrCorr.re));
   ijkErrLam.im        = 0.0;
 
 
@@ -1342,7 +1380,10 @@ AVOInversion::doPredictionKriging(SeismicParametersHolder & seismicParameters)
   if(writePrediction_ == true) { //No need to do this if output not requested.
     double wall2=0.0, cpu2=0.0;
     TimeKit::getTime(wall2,cpu2);
-    doPostKriging(seismicParameters, *postVp_, *postVs_, *postRho_);
+    if (factoredPostCov_ != NULL && !factoredPostCov_->getKrigingCovariances().empty())
+      doPostKriging(seismicParameters, factoredPostCov_->getKrigingCovariances(), *postVp_, *postVs_, *postRho_);
+    else
+      doPostKriging(seismicParameters, *postVp_, *postVs_, *postRho_);
     Timings::setTimeKrigingPred(wall2,cpu2);
 
     seismicParameters.SetPostVpKriging(postVp_);
@@ -1362,198 +1403,227 @@ AVOInversion::simulate(SeismicParametersHolder & seismicParameters, RandomGen *
   if(nSim_>0)
   {
     bool kriging = (krigingParameter_ > 0);
-    FFTGrid * postCovVp      = seismicParameters.GetCovVp();
-    FFTGrid * postCovVs      = seismicParameters.GetCovVs();
-    FFTGrid * postCovRho     = seismicParameters.GetCovRho();
-    FFTGrid * postCrCovVpVs  = seismicParameters.GetCrCovVpVs();
-    FFTGrid * postCrCovVpRho = seismicParameters.GetCrCovVpRho();
-    FFTGrid * postCrCovVsRho = seismicParameters.GetCrCovVsRho();
-
-    assert( postCovVp->getIsTransformed() );
-    assert( postCovVs->getIsTransformed() );
-    assert( postCovRho->getIsTransformed() );
-    assert( postCrCovVpVs->getIsTransformed() );
-    assert( postCrCovVpRho->getIsTransformed() );
-    assert( postCrCovVsRho->getIsTransformed() );
-
-    int             simNr,i,j,k,l;
-    fftw_complex ** ijkPostCov;
-    fftw_complex *  ijkSeed;
-    FFTGrid *       seed0;
-    FFTGrid *       seed1;
-    FFTGrid *       seed2;
-
-    ijkPostCov = new fftw_complex*[3];
-    for (l=0;l<3;l++)
-      ijkPostCov[l]=new fftw_complex[3];
-
-    ijkSeed = new fftw_complex[3];
-
-    seed0 =  createFFTGrid();
-    seed1 =  createFFTGrid();
-    seed2 =  createFFTGrid();
-    seed0->createComplexGrid();
-    seed1->createComplexGrid();
-    seed2->createComplexGrid();
-
-    // long int timestart, timeend;
-
-    for (simNr = 0; simNr < nSim_;  simNr++)
-    {
-      // time(&timestart);
-
-      seed0->fillInComplexNoise(randomGen);
-      seed1->fillInComplexNoise(randomGen);
-      seed2->fillInComplexNoise(randomGen);
-
-      postCovVp     ->setAccessMode(FFTGrid::READ);
-      postCovVs     ->setAccessMode(FFTGrid::READ);
-      postCovRho    ->setAccessMode(FFTGrid::READ);
-      postCrCovVpVs ->setAccessMode(FFTGrid::READ);
-      postCrCovVpRho->setAccessMode(FFTGrid::READ);
-      postCrCovVsRho->setAccessMode(FFTGrid::READ);
-      seed0 ->setAccessMode(FFTGrid::READANDWRITE);
-      seed1 ->setAccessMode(FFTGrid::READANDWRITE);
-      seed2 ->setAccessMode(FFTGrid::READANDWRITE);
-
-      int cnxp=nxp_/2+1;
-      int cholFlag;
-      for (k = 0; k < nzp_; k++)
-        for (j = 0; j < nyp_; j++)
-          for (i = 0; i < cnxp; i++)
-          {
-            ijkPostCov[0][0] = postCovVp     ->getNextComplex();
-            ijkPostCov[1][1] = postCovVs     ->getNextComplex();
-            ijkPostCov[2][2] = postCovRho    ->getNextComplex();
-            ijkPostCov[0][1] = postCrCovVpVs ->getNextComplex();
-            ijkPostCov[0][2] = postCrCovVpRho->getNextComplex();
-            ijkPostCov[1][2] = postCrCovVsRho->getNextComplex();
-
-            ijkPostCov[1][0].re =  ijkPostCov[0][1].re;
-            ijkPostCov[1][0].im = -ijkPostCov[0][1].im;
-            ijkPostCov[2][0].re =  ijkPostCov[0][2].re;
-            ijkPostCov[2][0].im = -ijkPostCov[0][2].im;
-            ijkPostCov[2][1].re =  ijkPostCov[1][2].re;
-            ijkPostCov[2][1].im = -ijkPostCov[1][2].im;
-
-            ijkSeed[0]=seed0->getNextComplex();
-            ijkSeed[1]=seed1->getNextComplex();
-            ijkSeed[2]=seed2->getNextComplex();
-
-            cholFlag = lib_matrCholCpx(3,ijkPostCov);  // Choleskey factor of posterior covariance write over ijkPostCov
-            if(cholFlag == 0)
-            {
-              lib_matrProdCholVec(3,ijkPostCov,ijkSeed); // write over ijkSeed
-            }
-            else
-            {
-              for (l=0; l< 3;l++)
-              {
-                ijkSeed[l].re =0.0;
-                ijkSeed[l].im = 0.0;
-              }
 
-            }
-            seed0->setNextComplex(ijkSeed[0]);
-            seed1->setNextComplex(ijkSeed[1]);
-            seed2->setNextComplex(ijkSeed[2]);
-          }
+    assert( seismicParameters.GetCovVp()->getIsTransformed() );
+    assert( seismicParameters.GetCovVs()->getIsTransformed() );
+    assert( seismicParameters.GetCovRho()->getIsTransformed() );
+    assert( seismicParameters.GetCrCovVpVs()->getIsTransformed() );
+    assert( seismicParameters.GetCrCovVpRho()->getIsTransformed() );
+    assert( seismicParameters.GetCrCovVsRho()->getIsTransformed() );
 
-      postCovVp->endAccess();  //
-      postCovVs->endAccess();   //
-      postCovRho->endAccess();
-      postCrCovVpVs->endAccess();
-      postCrCovVpRho->endAccess();
-      postCrCovVsRho->endAccess();
-      seed0->endAccess();
-      seed1->endAccess();
-      seed2->endAccess();
+    //
+    // Each realisation draws its noise from its own part of the period of the
+    // random generator, so the realisations do not depend on the number of threads.
+    //
+    std::vector<RandomGen> simGen;
+    for (int simNr = 0; simNr < nSim_; simNr++)
+      simGen.push_back(RandomGen(*randomGen, simNr, nSim_));
+    randomGen->skipStreams(nSim_);
+
+    //
+    // The Cholesky factors of the posterior covariance and the kriging covariances
+    // are the same for all realisations, so they are found once. The kriging
+    // covariances are also used for the prediction kriging.
+    //
+    delete factoredPostCov_;
+    factoredPostCov_ = new FactoredPostCov(seismicParameters,
+                                           !fileGrid_,
+                                           kriging == true,
+                                           modelSettings_->getNumberOfThreads());
+    const std::vector<CovGridSeparated *> & krigingCov = factoredPostCov_->getKrigingCovariances();
 
-      // time(&timeend);
-      // printf("Simulation in FFT domain in %ld seconds \n",timeend-timestart);
-      // time(&timestart);
+    //
+    // Realisations are simulated in parallel when the grids and the Cholesky
+    // factors are in memory. Each realisation needs its own three grids.
+    //
+    // The kriging time is taken out of the simulation time only when the
+    // realisations are made one at a time. Concurrent realisations overlap in
+    // wall time, and the CPU time is for the whole process. Kriging progress
+    // bars would also be mixed, so instead each finished realisation is
+    // reported in order.
+    //
+    bool serial = true;
+#ifdef PARALLEL
+    int n_parallel = 1;
+    if (factoredPostCov_->isInMemory() && modelSettings_->getDebugFlag() == 0)
+      n_parallel = findNumberOfParallelSimulations(std::min(modelSettings_->getNumberOfThreads(), nSim_));
+    if (n_parallel > 1) {
+      LogKit::LogFormatted(LogKit::Low,"\nSimulating %d realisations in parallel.\n",n_parallel);
+      FFTGrid::setMaxAllowedGrids(FFTGrid::getMaxAllowedGrids() + 3*(n_parallel - 1));
+    }
+    serial = (n_parallel == 1);
+#endif
 
-      seed0->setAccessMode(FFTGrid::RANDOMACCESS);
-      seed0->invFFTInPlace();
+#ifdef PARALLEL
+#pragma omp parallel num_threads(n_parallel)
+#endif
+    {
+      int             i,j,k;
+      FFTGrid *       seed0;
+      FFTGrid *       seed1;
+      FFTGrid *       seed2;
 
-      seed1->setAccessMode(FFTGrid::RANDOMACCESS);
-      seed1->invFFTInPlace();
+      seed0 =  createFFTGrid();
+      seed1 =  createFFTGrid();
+      seed2 =  createFFTGrid();
+      seed0->createComplexGrid();
+      seed1->createComplexGrid();
+      seed2->createComplexGrid();
 
-      seed2->setAccessMode(FFTGrid::RANDOMACCESS);
-      seed2->invFFTInPlace();
+      // long int timestart, timeend;
 
-      if(modelAVOdynamic_->GetUseLocalNoise()==true)
+#ifdef PARALLEL
+#pragma omp for ordered schedule(dynamic, 1)
+#endif
+      for (int simNr = 0; simNr < nSim_;  simNr++)
       {
-        float vp, vs, rho;
-        float vpnew, vsnew, rhonew;
-
-        for (j=0;j<ny_;j++)
-          for (i=0;i<nx_;i++)
-            for (k=0;k<nz_;k++)
-            {
-              vp  = seed0->getRealValue(i,j,k);
-              vs  = seed1->getRealValue(i,j,k);
-              rho = seed2->getRealValue(i,j,k);
-              vpnew  = float((*sigmamdnew_)(i,j)[0][0]*vp+ (*sigmamdnew_)(i,j)[0][1]*vs+(*sigmamdnew_)(i,j)[0][2]*rho);
-              vsnew  = float((*sigmamdnew_)(i,j)[1][0]*vp+ (*sigmamdnew_)(i,j)[1][1]*vs+(*sigmamdnew_)(i,j)[1][2]*rho);
-              rhonew = float((*sigmamdnew_)(i,j)[2][0]*vp+ (*sigmamdnew_)(i,j)[2][1]*vs+(*sigmamdnew_)(i,j)[2][2]*rho);
-              seed0->setRealValue(i,j,k,vpnew);
-              seed1->setRealValue(i,j,k,vsnew);
-              seed2->setRealValue(i,j,k,rhonew);
-            }
-      }
+        // time(&timestart);
 
-      seed0->add(postVp_);
-      seed0->endAccess();
-      seed1->add(postVs_);
-      seed1->endAccess();
-      seed2->add(postRho_);
-      seed2->endAccess();
-
-      if(kriging == true) {
-        double wall2=0.0, cpu2=0.0;
-        TimeKit::getTime(wall2,cpu2);
-        doPostKriging(seismicParameters, *seed0, *seed1, *seed2);
-        Timings::addToTimeKrigingSim(wall2,cpu2);
-      }
+        seed0->fillInComplexNoise(&simGen[simNr]);
+        seed1->fillInComplexNoise(&simGen[simNr]);
+        seed2->fillInComplexNoise(&simGen[simNr]);
 
-      seismicParameters.AddSimulationSeed0(seed0);
-      seismicParameters.AddSimulationSeed1(seed1);
-      seismicParameters.AddSimulationSeed2(seed2);
+        factoredPostCov_->multiplyByFactors(seed0, seed1, seed2);
 
-      // time(&timeend);
-      // printf("Back transform and write of simulation in %ld seconds \n",timeend-timestart);
-    }
+        // time(&timeend);
+        // printf("Simulation in FFT domain in %ld seconds \n",timeend-timestart);
+        // time(&timestart);
+
+        seed0->setAccessMode(FFTGrid::RANDOMACCESS);
+        seed0->invFFTInPlace();
 
-    delete seed0;
-    delete seed1;
-    delete seed2;
+        seed1->setAccessMode(FFTGrid::RANDOMACCESS);
+        seed1->invFFTInPlace();
 
-    for (l=0;l<3;l++)
-      delete  [] ijkPostCov[l];
-    delete [] ijkPostCov;
-    delete [] ijkSeed;
+        seed2->setAccessMode(FFTGrid::RANDOMACCESS);
+        seed2->invFFTInPlace();
 
+        if(modelAVOdynamic_->GetUseLocalNoise()==true)
+        {
+          float vp, vs, rho;
+          float vpnew, vsnew, rhonew;
+
+          for (j=0;j<ny_;j++)
+            for (i=0;i<nx_;i++)
+              for (k=0;k<nz_;k++)
+              {
+                vp  = seed0->getRealValue(i,j,k);
+                vs  = seed1->getRealValue(i,j,k);
+                rho = seed2->getRealValue(i,j,k);
+                vpnew  = float((*sigmamdnew_)(i,j)[0][0]*vp+ (*sigmamdnew_)(i,j)[0][1]*vs+(*sigmamdnew_)(i,j)[0][2]*rho);
+                vsnew  = float((*sigmamdnew_)(i,j)[1][0]*vp+ (*sigmamdnew_)(i,j)[1][1]*vs+(*sigmamdnew_)(i,j)[1][2]*rho);
+                rhonew = float((*sigmamdnew_)(i,j)[2][0]*vp+ (*sigmamdnew_)(i,j)[2][1]*vs+(*sigmamdnew_)(i,j)[2][2]*rho);
+                seed0->setRealValue(i,j,k,vpnew);
+                seed1->setRealValue(i,j,k,vsnew);
+                seed2->setRealValue(i,j,k,rhonew);
+              }
+        }
+
+        seed0->add(postVp_);
+        seed0->endAccess();
+        seed1->add(postVs_);
+        seed1->endAccess();
+        seed2->add(postRho_);
+        seed2->endAccess();
+
+        if(kriging == true) {
+          double wall2=0.0, cpu2=0.0;
+          TimeKit::getTime(wall2,cpu2);
+          doPostKriging(seismicParameters, krigingCov, *seed0, *seed1, *seed2, serial);
+          if (serial)
+            Timings::addToTimeKrigingSim(wall2,cpu2);
+        }
+
+        // Realisations are stored in the order they are numbered.
+#ifdef PARALLEL
+#pragma omp ordered
+#endif
+        {
+          seismicParameters.AddSimulationSeed0(seed0);
+          seismicParameters.AddSimulationSeed1(seed1);
+          seismicParameters.AddSimulationSeed2(seed2);
+          if (!serial)
+            LogKit::LogFormatted(LogKit::Low,"\nRealisation %d of %d finished.\n", simNr + 1, nSim_);
+        }
+
+        // time(&timeend);
+        // printf("Back transform and write of simulation in %ld seconds \n",timeend-timestart);
+      }
+
+      delete seed0;
+      delete seed1;
+      delete seed2;
+    }
+
+    factoredPostCov_->releaseFactors();
   }
   Timings::addTimeSimulation(wall,cpu);
   return(0);
 }
 
+int
+AVOInversion::findNumberOfParallelSimulations(int nMax) const
+{
+  // Each extra realisation needs three padded grids. As in
+  // ModelAVOStatic::CheckAvailableMemory(), we check how many we have memory for.
+  size_t gridSize   = static_cast<size_t>(4)*2*(nxp_/2+1)*static_cast<size_t>(nyp_)*nzp_;
+  int    n_chunks   = 3*(nMax - 1);
+  char ** memchunk  = new char*[std::max(n_chunks, 1)];
+
+  int i = 0;
+  try {
+    for(i = 0 ; i < n_chunks ; i++)
+      memchunk[i] = new char[gridSize];
+  }
+  catch (std::bad_alloc& ) //Could not allocate memory
+  {
+  }
+
+  for(int j=0 ; j<i ; j++)
+    delete [] memchunk[j];
+  delete [] memchunk;
+
+  return(1 + i/3);
+}
+
 void
 AVOInversion::doPostKriging(SeismicParametersHolder & seismicParameters,
                             FFTGrid                 & postVp,
                             FFTGrid                 & postVs,
                             FFTGrid                 & postRho)
 {
+  std::vector<CovGridSeparated *> covGrids(6);
+  covGrids[0] = new CovGridSeparated(*seismicParameters.GetCovVp()     );
+  covGrids[1] = new CovGridSeparated(*seismicParameters.GetCovVs()     );
+  covGrids[2] = new CovGridSeparated(*seismicParameters.GetCovRho()    );
+  covGrids[3] = new CovGridSeparated(*seismicParameters.GetCrCovVpVs() );
+  covGrids[4] = new CovGridSeparated(*seismicParameters.GetCrCovVpRho());
+  covGrids[5] = new CovGridSeparated(*seismicParameters.GetCrCovVsRho());
+
+  doPostKriging(seismicParameters, covGrids, postVp, postVs, postRho);
+
+  for (int c = 0; c < 6; c++)
+    delete covGrids[c];
+}
+
+void
+AVOInversion::doPostKriging(SeismicParametersHolder               & seismicParameters,
+                            const std::vector<CovGridSeparated *> & covGrids,
+                            FFTGrid                               & postVp,
+                            FFTGrid                               & postVs,
+                            FFTGrid                               & postRho,
+                            bool                                    showProgress)
+{
 
   LogKit::WriteHeader("Kriging to wells");
 
-  CovGridSeparated covGridVp     (*seismicParameters.GetCovVp()     );
-  CovGridSeparated covGridVs     (*seismicParameters.GetCovVs()     );
-  CovGridSeparated covGridRho    (*seismicParameters.GetCovRho()    );
-  CovGridSeparated covGridCrVpVs (*seismicParameters.GetCrCovVpVs() );
-  CovGridSeparated covGridCrVpRho(*seismicParameters.GetCrCovVpRho());
-  CovGridSeparated covGridCrVsRho(*seismicParameters.GetCrCovVsRho());
+  // The kriging tapers the covariances, so it gets its own copies.
+  CovGridSeparated covGridVp     (*covGrids[0]);
+  CovGridSeparated covGridVs     (*covGrids[1]);
+  CovGridSeparated covGridRho    (*covGrids[2]);
+  CovGridSeparated covGridCrVpVs (*covGrids[3]);
+  CovGridSeparated covGridCrVpRho(*covGrids[4]);
+  CovGridSeparated covGridCrVsRho(*covGrids[5]);
 
   KrigingData3D kd(blocked_wells_, 1); // 1 = full resolution logs
 
@@ -1563,7 +1633,8 @@ AVOInversion::doPostKriging(SeismicParametersHolder & seismicParameters,
                          covGridCrVpVs, covGridCrVpRho, covGridCrVsRho,
                          krigingParameter_);
 
-  pKriging.KrigAll(postVp, postVs, postRho, seismicParameters, false, modelSettings_->getDebugFlag(), modelSettings_->getDoSmoothKriging());
+  pKriging.KrigAll(postVp, postVs, postRho, seismicParameters, false, modelSettings_->getDebugFlag(), modelSettings_->getDoSmoothKriging(),
+                   modelSettings_->getNumberOfThreads(), showProgress);
 }
 
 FFTGrid *
@@ -20,6 +20,7 @@ class Simbox;
 class RandomGen;
 class CKrigingAdmin;
 class CovGridSeparated;
+class FactoredPostCov;
 class KrigingData3D;
 class FaciesProb;
 class GridMapping;
@@ -117,6 +118,14 @@ private:
   void                   divideDataByScaleWavelet(const SeismicParametersHolder & seismicParameters);
   void                   multiplyDataByScaleWaveletAndWriteToFile(const std::string & typeName, std::string & interval_name);
   void                   doPostKriging(SeismicParametersHolder & seismicParameters, FFTGrid & postVp, FFTGrid & postVs, FFTGrid & postRho);
+  void                   doPostKriging(SeismicParametersHolder               & seismicParameters,
+                                       const std::vector<CovGridSeparated *> & covGrids,
+                                       FFTGrid                               & postVp,
+                                       FFTGrid                               & postVs,
+                                       FFTGrid                               & postRho,
+                                       bool                                    showProgress = true);
+
+  int                    findNumberOfParallelSimulations(int nMax) const;
 
   void                   correctVpVsRho(ModelSettings * modelSettings);
 
@@ -130,7 +139,8 @@ private:
   void                   SetComplexVector(NRLib::ComplexVector & V,
                                           fftw_complex         * v);
 
-  void                   getNextErrorVariance(fftw_complex **& errVar,
+  void                   computeErrorVariance(fftw_complex **& errVar,
+                                              fftw_complex     ijkErrCorr,
                                               fftw_complex   * errMult1,
                                               fftw_complex   * errMult2,
                                               fftw_complex   * errMult3,
@@ -191,6 +201,8 @@ private:
   FFTGrid          * postRho_;
   FFTGrid          * errCorr_;
 
+  FactoredPostCov  * factoredPostCov_; // Posterior covariance factored for simulation and kriging
+
   std::string        interval_name_;
 
   int                                        krigingParameter_;
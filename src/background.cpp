@@ -276,9 +276,12 @@ Background::GenerateBackgroundModel(NRLib::Grid<float>
                                                 model_settings->getDebugFlag(),
                                                 interval_name);
 
-    MakeKrigedBackground(kriging_data_vp,  bg_vp,  trend_vp,  simbox, covGrid2D, "Vp",  model_settings->getNumberOfThreads());
-    MakeKrigedBackground(kriging_data_vs,  bg_vs,  trend_vs,  simbox, covGrid2D, "Vs",  model_settings->getNumberOfThreads());
-    MakeKrigedBackground(kriging_data_rho, bg_rho, trend_rho, simbox, covGrid2D, "Rho", model_settings->getNumberOfThreads());
+    // Layers and parameters with data at the same positions share kriging matrix factors
+    Kriging2D::FactorMap factors;
+
+    MakeKrigedBackground(kriging_data_vp,  bg_vp,  trend_vp,  simbox, covGrid2D, factors, "Vp",  model_settings->getNumberOfThreads());
+    MakeKrigedBackground(kriging_data_vs,  bg_vs,  trend_vs,  simbox, covGrid2D, factors, "Vs",  model_settings->getNumberOfThreads());
+    MakeKrigedBackground(kriging_data_rho, bg_rho, trend_rho, simbox, covGrid2D, factors, "Rho", model_settings->getNumberOfThreads());
 
     vertical_trends[0] = trend_vp;
     vertical_trends[1] = trend_vs;
@@ -696,6 +699,7 @@ Background::MakeKrigedBackground(const std::vector<KrigingData2D> & kriging_data
                                  std::vector<double>              & trend,
                                  const Simbox                     * simbox,
                                  const CovGrid2D                  & cov_grid_2D,
+                                 Kriging2D::FactorMap             & factors,
                                  const std::string                & type,
                                  int                                n_threads)
 {
@@ -727,6 +731,37 @@ Background::MakeKrigedBackground(const std::vector<KrigingData2D> & kriging_data
     << "\n  |    |    |    |    |    |    |    |    |    |    |  "
     << "\n  ^";
 
+  //
+  // Find the kriging matrix factor of each layer. Factors not already
+  // available are computed once for each distinct set of data positions.
+  //
+  NRLib::SymmetricMatrix                        no_factor;
+  std::vector<const NRLib::SymmetricMatrix *>   layer_factor(nz, &no_factor);
+  std::vector<Kriging2D::FactorMap::iterator>   new_factors;
+  for (int k=0 ; k<nz ; k++) {
+    if (Kriging2D::needsKrigingMatrix(kriging_data[k], nx, ny)) {
+      Kriging2D::FactorMap::key_type key(kriging_data[k].getIndexI(), kriging_data[k].getIndexJ());
+      Kriging2D::FactorMap::iterator it = factors.find(key);
+      if (it == factors.end()) {
+        factors[key];
+        it = factors.find(key);
+        new_factors.push_back(it);
+      }
+      layer_factor[k] = &(it->second);
+    }
+  }
+
+  int n_new = static_cast<int>(new_factors.size());
+#ifdef PARALLEL
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads)
+#endif
+  for (int f=0 ; f<n_new ; f++) {
+    Kriging2D::factoriseKrigingMatrix(new_factors[f]->second,
+                                      cov_grid_2D,
+                                      new_factors[f]->first.first,
+                                      new_factors[f]->first.second);
+  }
+
   bg_grid->Resize(nx, ny, nz);
 #ifdef PARALLEL
   int  chunk_size = 1;
@@ -738,7 +773,7 @@ Background::MakeKrigedBackground(const std::vector<KrigingData2D> & kriging_data
     surfaces[k].Assign(trend[k]);
 
     // Kriging of layer
-    Kriging2D::krigSurface(surfaces[k], kriging_data[k], cov_grid_2D);
+    Kriging2D::krigSurface(surfaces[k], kriging_data[k], cov_grid_2D, *layer_factor[k]);
 
     // Log progress
     if (k+1 >= static_cast<int>(next_monitor)) {
@@ -9,6 +9,7 @@
 
 #include "nrlib/random/beta.hpp"
 #include "src/blockedlogscommon.h"
+#include "src/kriging2d.h"
 
 class Vario;
 class Simbox;
@@ -160,6 +161,7 @@ private:
                                     std::vector<double>              & trend,
                                     const Simbox                     * simbox,
                                     const CovGrid2D                  & cov_grid_2D,
+                                    Kriging2D::FactorMap             & factors,
                                     const std::string                & type,
                                     int                                n_threads);
 
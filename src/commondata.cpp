@@ -7,6 +7,8 @@
 
 #include "src/commondata.h"
 #include "src/fftgrid.h"
+#include "src/fftengine.h"
+#include "src/gridswapfile.h"
 #include "src/fftfilegrid.h"
 #include "src/wavelet.h"
 #include "src/wavelet1D.h"
@@ -904,169 +906,118 @@ bool CommonData::ReadSeismicData(ModelSettings                               * m
 
   LogKit::WriteHeader("Reading seismic data");
 
-  for (int this_timelapse = 0; this_timelapse < n_timelapses; this_timelapse++) {
-
-    std::string err_text_timelapse = "";
+  //
+  // The angle stacks of all vintages are independent, so they are read
+  // concurrently. Settings taken from the cubes are set afterwards, in
+  // the order the cubes are given.
+  //
+  std::vector<std::vector<float> > offsets(n_timelapses);
+  std::vector<int>                 job_timelapse;
+  std::vector<int>                 job_angle;
 
+  for (int this_timelapse = 0; this_timelapse < n_timelapses; this_timelapse++) {
     if (input_files->getNumberOfSeismicFiles(this_timelapse) > 0) {
+      int n_angles = model_settings->getNumberOfAngles(this_timelapse);
+      seismic_data[this_timelapse].resize(n_angles, NULL);
 
-      std::vector<float> angles = model_settings->getAngle(this_timelapse);
-      std::vector<float> offset = model_settings->getLocalSegyOffset(this_timelapse);
-      int n_angles              = model_settings->getNumberOfAngles(this_timelapse);
-
+      //If offset is not set in modelfile (=RMISSING), it will be read from the segy file in ReadAllTraces
+      offsets[this_timelapse] = model_settings->getLocalSegyOffset(this_timelapse);
       for (int i = 0; i < n_angles; i++) {
+        if (offsets[this_timelapse][i] == RMISSING)
+          offsets[this_timelapse][i] = model_settings->getSegyOffset(this_timelapse);
+        job_timelapse.push_back(this_timelapse);
+        job_angle.push_back(i);
+      }
+    }
+  }
 
-        seismic_data[this_timelapse].resize(n_angles);
-
-        std::string file_name = input_files->getSeismicFile(this_timelapse, i);
-        int file_type = IO::findGridType(file_name);
-
-        //If offset is not set in modelfile (=RMISSING), it will be read from the segy file in ReadAllTraces
-        if (offset[i] == RMISSING)
-          offset[i] = model_settings->getSegyOffset(this_timelapse);
-
-        if (file_type == IO::STORM || file_type == IO::SGRI) {
-          StormContGrid * stormgrid = NULL;
-          std::string err_text_tmp = "";
-
-          try {
-            stormgrid = new StormContGrid(0,0,0);
-            stormgrid->ReadFromFile(file_name);
-          }
-          catch (NRLib::Exception & e) {
-            err_text += "Error reading storm file " + file_name + ":\n";
-            err_text_tmp += NRLib::ToString(e.what());
-          }
-
-          if (err_text_tmp == "") {
-
-            if (file_type == IO::STORM)
-              seismic_data[this_timelapse][i] = new SeismicStorage(file_name, SeismicStorage::STORM, angles[i], stormgrid);
-            else
-              seismic_data[this_timelapse][i] = new SeismicStorage(file_name, SeismicStorage::SGRI, angles[i], stormgrid);
-          }
-          else {
-            err_text_timelapse += "Error when reading storm-file " + file_name +": \n";
-            err_text_timelapse += err_text_tmp + "\n";
-            LogKit::LogFormatted(LogKit::Error,"Reading storm-file " + file_name + " failed.\n");
-          }
-
-        } //STORM / SGRI
-        else if (file_type == IO::CRAVA) {
-
-          int nx_pad = full_inversion_simbox.GetNXpad();
-          int ny_pad = full_inversion_simbox.GetNYpad();
-          int nz_pad = 0;  //Not set before ReadSeismicData. Get it from file.
-
-          GetZPaddingFromCravaFile(file_name, err_text, nz_pad);
-
-          FFTGrid *  grid = CreateFFTGrid(full_inversion_simbox.getnx(),
-                                          full_inversion_simbox.getny(),
-                                          full_inversion_simbox.getnz(),
-                                          nx_pad,
-                                          ny_pad,
-                                          nz_pad,
-                                          model_settings->getFileGrid());
-
-          std::string angle    = NRLib::ToString(angles[i]*(180/M_PI), 1);
-          std::string par_name = "Seismic data angle stack "+angle;
-          LogKit::LogFormatted(LogKit::Low,"\nReading grid \'"+par_name+"\' from file "+file_name);
-
-          grid->setAccessMode(FFTGrid::RANDOMACCESS);
-          grid->readCravaFile(file_name, err_text);
-
-          grid->endAccess();
-
-          seismic_data[this_timelapse][i] = new SeismicStorage(file_name, SeismicStorage::FFTGRID, angles[i], grid);
-
-        }
-        else { //Try to read as segy
-
-          std::string err_text_tmp = "";
+  //
+  // Nested parallelism is not used, so the threads either read cubes
+  // concurrently or decode the traces of one cube at a time. Cubes are
+  // read one at a time when there are too few of them to keep at least
+  // half the threads busy.
+  //
+  int  n_jobs        = static_cast<int>(job_angle.size());
+  int  n_threads     = std::max(model_settings->getNumberOfThreads(), 1);
+  bool by_cube       = 2*n_jobs > n_threads;
+  int  n_readers     = by_cube ? std::max(std::min(n_threads, n_jobs), 1) : 1;
+  int  n_decoders    = by_cube ? 1 : n_threads; //Threads decoding traces within each SegY cube
+  bool show_progress = n_readers == 1;          //Progress bars from concurrent readers would be mixed
+
+  std::vector<std::string> job_err_text(n_jobs, "");
+  std::vector<std::string> job_err_text_cube(n_jobs, "");
+  std::vector<int>         job_inconsistent(n_jobs, 0);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_readers) if(n_readers > 1)
+#endif
+  for (int j = 0; j < n_jobs; j++) {
+    int  this_timelapse = job_timelapse[j];
+    int  i              = job_angle[j];
+    bool inconsistent   = false;
+    try {
+      seismic_data[this_timelapse][i] = ReadSeismicCube(model_settings,
+                                                        input_files->getSeismicFile(this_timelapse, i),
+                                                        model_settings->getAngle(this_timelapse)[i],
+                                                        offsets[this_timelapse][i],
+                                                        model_settings->getTraceHeaderFormat(this_timelapse, i),
+                                                        full_inversion_simbox,
+                                                        n_decoders,
+                                                        show_progress,
+                                                        inconsistent,
+                                                        job_err_text[j],
+                                                        job_err_text_cube[j]);
+    }
+    catch (NRLib::Exception & e) {
+      job_err_text_cube[j] += "Failed to read file " + input_files->getSeismicFile(this_timelapse, i) + ": \n";
+      job_err_text_cube[j] += NRLib::ToString(e.what()) + "\n";
+    }
+    job_inconsistent[j] = (inconsistent ? 1 : 0);
+  }
 
-          if (file_type != IO::SEGY)
-            LogKit::LogFormatted(LogKit::Warning,"\n Did not recognize "+file_name+", will read as SEGY.");
+  int j = 0;
+  for (int this_timelapse = 0; this_timelapse < n_timelapses; this_timelapse++) {
 
-          SegY              * segy   = NULL;
-          TraceHeaderFormat * format = model_settings->getTraceHeaderFormat(this_timelapse, i);
+    std::string err_text_timelapse = "";
 
-          if (format == NULL) { //Unknown format
-            std::vector<TraceHeaderFormat*> traceHeaderFormats(0);
+    if (input_files->getNumberOfSeismicFiles(this_timelapse) > 0) {
 
-            if (model_settings->getTraceHeaderFormat() != NULL)
-              traceHeaderFormats.push_back(model_settings->getTraceHeaderFormat());
+      std::vector<float> & offset = offsets[this_timelapse];
+      int n_angles                = model_settings->getNumberOfAngles(this_timelapse);
 
-            segy = new SegY(file_name,
-                            offset[i],
-                            traceHeaderFormats,
-                            true); // Add standard formats to format search
-          }
-          else { //Known format, read directly.
-            segy = new SegY(file_name, offset[i], *format);
-          }
+      for (int i = 0; i < n_angles; i++, j++) {
 
-          float guard_zone = model_settings->getGuardZone();
+        std::string file_name = input_files->getSeismicFile(this_timelapse, i);
 
-          //Check that data cover grid is moved to after interval_simboxes are made
-          float padding         = 2*guard_zone;
-          bool relative_padding = false;
-          bool only_volume      = true;
+        err_text           += job_err_text[j];
+        err_text_timelapse += job_err_text_cube[j];
 
-          try {
-            segy->ReadAllTraces(&full_inversion_simbox,
-                                padding,
-                                only_volume,
-                                relative_padding);
-            segy->ReportSizeOfVolume();
+        if (seismic_data[this_timelapse][i] != NULL && seismic_data[this_timelapse][i]->GetSeismicType() == SeismicStorage::SEGY) {
+          SegY * segy = seismic_data[this_timelapse][i]->GetSegY();
 
-          }
-          catch (NRLib::Exception & e) {
-            err_text_tmp += "Error reading SegY-file " + file_name + ":\n";
-            err_text_tmp += NRLib::ToString(e.what());
+          //Set segy nz and dz for first availible segy-cube. This is used to match written segy cube with input segy in ParameterOutput
+          if (model_settings->getSegyNz() == IMISSING) {
+            model_settings->setSegyNz(static_cast<int>(segy->GetNz()));
+            model_settings->setSegyDz(segy->GetDz());
           }
 
-          if (err_text_tmp == "") {
-
-            bool area_from_segy       = model_settings->getAreaSpecification() == ModelSettings::AREA_FROM_GRID_DATA;
-            bool storm_output         = (model_settings->getOutputGridFormat() & IO::STORM) == 0;
-            bool regularize_if_needed = area_from_segy && storm_output;
-            segy->CreateRegularGrid(regularize_if_needed); //sets geometry
-            segy->GetGeometry()->WriteGeometry();
-
-            seismic_data[this_timelapse][i] = new SeismicStorage(file_name, SeismicStorage::SEGY, angles[i], segy);
-
-            //Set segy nz and dz for first availible segy-cube. This is used to match written segy cube with input segy in ParameterOutput
-            if (model_settings->getSegyNz() == IMISSING) {
-              model_settings->setSegyNz(static_cast<int>(segy->GetNz()));
-              model_settings->setSegyDz(segy->GetDz());
-            }
-
-            //Check and report if offset is different from segy file and model file
-            if (segy->getTrace(0) != NULL && offset[i] != RMISSING && (segy->getTrace(0)->GetTraceHeader().GetStartTime() != offset[i]) && segy->getTrace(0)->GetTraceHeader().GetStartTime() > 0) {
-              LogKit::LogMessage(LogKit::Warning, "\nWARNING: The offset given in modelfile under <segy-start-time> (" + NRLib::ToString(offset[i])
-                                 + ") is different from the offset\n found in file " + file_name + " (" + NRLib::ToString(segy->getTrace(0)->GetTraceHeader().GetStartTime())
-                                 + ") for angle " + NRLib::ToString(i) + ". The offset from modelfile is used.\n");
-              TaskList::addTask("Check consistency between offset in " + file_name + " (" + NRLib::ToString(segy->getTrace(0)->GetTraceHeader().GetStartTime())
-                                + ") and the one given in modelfile under <segy-start-time> (" + NRLib::ToString(offset[i]) + ").");
-            }
-
-            //Set offset for writing segy files
-            if (model_settings->getOutputOffset() == RMISSING)
-              model_settings->setOutputOffset(segy->GetTop());
-
-          }
-          else {
-            err_text_timelapse += "Failed to read SEGY-file " + file_name + ": \n";
-            err_text_timelapse += err_text_tmp + "\n";
-            LogKit::LogFormatted(LogKit::Error,"Reading SEGY-file " + file_name + " failed:\n");
-            LogKit::LogFormatted(LogKit::Error,"  " + err_text_tmp + "\n");
+          //Check and report if offset is different from segy file and model file
+          if (segy->getTrace(0) != NULL && offset[i] != RMISSING && (segy->getTrace(0)->GetTraceHeader().GetStartTime() != offset[i]) && segy->getTrace(0)->GetTraceHeader().GetStartTime() > 0) {
+            LogKit::LogMessage(LogKit::Warning, "\nWARNING: The offset given in modelfile under <segy-start-time> (" + NRLib::ToString(offset[i])
+                               + ") is different from the offset\n found in file " + file_name + " (" + NRLib::ToString(segy->getTrace(0)->GetTraceHeader().GetStartTime())
+                               + ") for angle " + NRLib::ToString(i) + ". The offset from modelfile is used.\n");
+            TaskList::addTask("Check consistency between offset in " + file_name + " (" + NRLib::ToString(segy->getTrace(0)->GetTraceHeader().GetStartTime())
+                              + ") and the one given in modelfile under <segy-start-time> (" + NRLib::ToString(offset[i]) + ").");
           }
 
-          if (segy->GetSamplingInconsistency() == true) {
-            TaskList::addTask("Check SegY cube " + file_name + ", sampling inconsistencies between BinaryHeader and TraceHeader are found.");
-          }
+          //Set offset for writing segy files
+          if (model_settings->getOutputOffset() == RMISSING)
+            model_settings->setOutputOffset(segy->GetTop());
+        }
 
-        } //SEGY
+        if (job_inconsistent[j] == 1) {
+          TaskList::addTask("Check SegY cube " + file_name + ", sampling inconsistencies between BinaryHeader and TraceHeader are found.");
+        }
 
         //Situation if segy-start time is given, without seismic data on segy format
         if (model_settings->getOutputOffset() == RMISSING && offset[i] != RMISSING)
@@ -1123,6 +1074,165 @@ bool CommonData::ReadSeismicData(ModelSettings                               * m
   return true;
 }
 
+SeismicStorage * CommonData::ReadSeismicCube(const ModelSettings     * model_settings,
+                                             const std::string       & file_name,
+                                             float                     angle,
+                                             float                     offset,
+                                             const TraceHeaderFormat * format,
+                                             const Simbox            & full_inversion_simbox,
+                                             int                       n_threads,
+                                             bool                      show_progress,
+                                             bool                    & sampling_inconsistency,
+                                             std::string             & err_text,
+                                             std::string             & err_text_cube) const
+{
+  SeismicStorage * seismic_data = NULL;
+  int              file_type    = IO::findGridType(file_name);
+
+  if (file_type == IO::STORM || file_type == IO::SGRI) {
+    StormContGrid * stormgrid = NULL;
+    std::string err_text_tmp = "";
+
+    try {
+      stormgrid = new StormContGrid(0,0,0);
+      stormgrid->ReadFromFile(file_name);
+    }
+    catch (NRLib::Exception & e) {
+      err_text += "Error reading storm file " + file_name + ":\n";
+      err_text_tmp += NRLib::ToString(e.what());
+    }
+
+    if (err_text_tmp == "") {
+
+      if (file_type == IO::STORM)
+        seismic_data = new SeismicStorage(file_name, SeismicStorage::STORM, angle, stormgrid);
+      else
+        seismic_data = new SeismicStorage(file_name, SeismicStorage::SGRI, angle, stormgrid);
+    }
+    else {
+      err_text_cube += "Error when reading storm-file " + file_name +": \n";
+      err_text_cube += err_text_tmp + "\n";
+      LogKit::LogFormatted(LogKit::Error,"Reading storm-file " + file_name + " failed.\n");
+    }
+
+  } //STORM / SGRI
+  else if (file_type == IO::CRAVA) {
+
+    //FFTGrid keeps a global count of allocated grids, so these grids are made one at a time.
+#ifdef PARALLEL
+#pragma omp critical(common_data_read_crava_seismic)
+#endif
+    {
+      int nx_pad = full_inversion_simbox.GetNXpad();
+      int ny_pad = full_inversion_simbox.GetNYpad();
+      int nz_pad = 0;  //Not set before ReadSeismicData. Get it from file.
+
+      GetZPaddingFromCravaFile(file_name, err_text, nz_pad);
+
+      FFTGrid *  grid = CreateFFTGrid(full_inversion_simbox.getnx(),
+                                      full_inversion_simbox.getny(),
+                                      full_inversion_simbox.getnz(),
+                                      nx_pad,
+                                      ny_pad,
+                                      nz_pad,
+                                      model_settings->getFileGrid());
+
+      std::string angle_text = NRLib::ToString(angle*(180/M_PI), 1);
+      std::string par_name   = "Seismic data angle stack "+angle_text;
+      LogKit::LogFormatted(LogKit::Low,"\nReading grid \'"+par_name+"\' from file "+file_name);
+
+      grid->setAccessMode(FFTGrid::RANDOMACCESS);
+      grid->readCravaFile(file_name, err_text);
+
+      grid->endAccess();
+
+      seismic_data = new SeismicStorage(file_name, SeismicStorage::FFTGRID, angle, grid);
+    }
+  }
+  else { //Try to read as segy
+
+    std::string err_text_tmp = "";
+
+    if (file_type != IO::SEGY)
+      LogKit::LogFormatted(LogKit::Warning,"\n Did not recognize "+file_name+", will read as SEGY.");
+
+    SegY * segy = NULL;
+
+    if (format == NULL) { //Unknown format
+      std::vector<TraceHeaderFormat*> traceHeaderFormats(0);
+
+      if (model_settings->getTraceHeaderFormat() != NULL)
+        traceHeaderFormats.push_back(model_settings->getTraceHeaderFormat());
+
+      segy = new SegY(file_name,
+                      offset,
+                      traceHeaderFormats,
+                      true); // Add standard formats to format search
+    }
+    else { //Known format, read directly.
+      segy = new SegY(file_name, offset, *format);
+    }
+
+    float guard_zone = model_settings->getGuardZone();
+
+    //Check that data cover grid is moved to after interval_simboxes are made
+    float padding         = 2*guard_zone;
+    bool relative_padding = false;
+    bool only_volume      = true;
+
+    try {
+      segy->ReadAllTraces(&full_inversion_simbox,
+                          padding,
+                          only_volume,
+                          relative_padding,
+                          n_threads,
+                          show_progress);
+    }
+    catch (NRLib::Exception & e) {
+      err_text_tmp += "Error reading SegY-file " + file_name + ":\n";
+      err_text_tmp += NRLib::ToString(e.what());
+    }
+
+    if (err_text_tmp == "") {
+
+      bool area_from_segy       = model_settings->getAreaSpecification() == ModelSettings::AREA_FROM_GRID_DATA;
+      bool storm_output         = (model_settings->getOutputGridFormat() & IO::STORM) == 0;
+      bool regularize_if_needed = area_from_segy && storm_output;
+
+      //The geometry is logged over several lines, so one cube is reported at a time.
+      std::string geometry_error = "";
+#ifdef PARALLEL
+#pragma omp critical(common_data_report_segy_geometry)
+#endif
+      {
+        try {
+          segy->ReportSizeOfVolume();
+          segy->CreateRegularGrid(regularize_if_needed); //sets geometry
+          segy->GetGeometry()->WriteGeometry();
+        }
+        catch (NRLib::Exception & e) {
+          geometry_error = e.what();
+        }
+      }
+      if (geometry_error != "")
+        throw NRLib::Exception(geometry_error);
+
+      seismic_data = new SeismicStorage(file_name, SeismicStorage::SEGY, angle, segy);
+
+    }
+    else {
+      err_text_cube += "Failed to read SEGY-file " + file_name + ": \n";
+      err_text_cube += err_text_tmp + "\n";
+      LogKit::LogMessage(LogKit::Error,"Reading SEGY-file " + file_name + " failed:\n  " + err_text_tmp + "\n");
+    }
+
+    sampling_inconsistency = segy->GetSamplingInconsistency();
+
+  } //SEGY
+
+  return(seismic_data);
+}
+
 FFTGrid * CommonData::CreateFFTGrid(int nx, int ny, int nz, int nxp, int nyp, int nzp, bool fileGrid)
 {
   FFTGrid* fftGrid;
@@ -6278,7 +6388,8 @@ CommonData::ReadSegyFile(const std::string                 & file_name,
       segy->ReadAllTraces(volume,
                           padding,
                           only_volume,
-                          relative_padding);
+                          relative_padding,
+                          model_settings->getNumberOfThreads());
     }
     catch (NRLib::Exception & e) {
       err_text += "Error reading SegY-file: " + file_name + ":\n";
@@ -6535,8 +6646,15 @@ void CommonData::FillInData(NRLib::Grid<float>  * grid_new,
   //
   // Create FFT plans
   //
-  rfftwnd_plan fftplan1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
-  rfftwnd_plan fftplan2 = rfftwnd_create_plan(1, &mt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  rfftwnd_plan fftplan1;
+  rfftwnd_plan fftplan2;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftplan1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    fftplan2 = rfftwnd_create_plan(1, &mt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  }
 
   //
   // Do resampling
@@ -6772,8 +6890,13 @@ void CommonData::FillInData(NRLib::Grid<float>  * grid_new,
   }
   LogKit::LogFormatted(LogKit::Low,"\n");
 
-  fftwnd_destroy_plan(fftplan1);
-  fftwnd_destroy_plan(fftplan2);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(fftplan1);
+    fftwnd_destroy_plan(fftplan2);
+  }
 }
 
 int CommonData::GetFillNumber(int i, int n, int np) const{
@@ -10911,6 +11034,17 @@ void CommonData::SetDebugLevel(ModelSettings * model_settings) const
   //Set output for all FFTGrids.
   FFTGrid::setOutputFlags(model_settings->getOutputGridFormat(),
                           model_settings->getOutputGridDomain());
+  FFTGrid::setNumberOfThreads(model_settings->getNumberOfThreads());
+
+  //Set up the engine doing the 3D FFTs of all FFTGrids.
+  FFTEngine::setNumberOfThreads(model_settings->getNumberOfThreads());
+  if (model_settings->getFFTWisdomFile() != "")
+    FFTEngine::setWisdomFile(model_settings->getFFTWisdomFile());
+
+  GridSwapFile::setCompression(model_settings->getCompressTmpGrids(),
+                               model_settings->getTmpGridMaxRelError());
+
+  SegY::SetUseTraceIndex(model_settings->getUseSegyTraceIndex());
 
 }
 
@@ -240,8 +240,15 @@ public:
     //
     // Transform to Fourier domain
     //
-    rfftwnd_plan p1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    rfftwnd_plan p1;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+    p1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
     rfftwnd_one_real_to_complex(p1, rAmp, cAmp);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     fftwnd_destroy_plan(p1);
 
     //for (int i=0 ; i<cnt ; i++) {
@@ -279,8 +286,15 @@ public:
     //
     // Backtransform to time domain
     //
-    rfftwnd_plan p2 = rfftwnd_create_plan(1, &nt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    rfftwnd_plan p2;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+    p2 = rfftwnd_create_plan(1, &nt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
     rfftwnd_one_complex_to_real(p2, cAmp, rAmp);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     fftwnd_destroy_plan(p2);
 
     float scale= float(1.0/nt);
@@ -519,6 +533,18 @@ private:
                                      std::string                                 & err_text,
                                      std::vector<std::vector<SeismicStorage *> > & seismic_data) const;
 
+  SeismicStorage *   ReadSeismicCube(const ModelSettings     * model_settings,
+                                     const std::string       & file_name,
+                                     float                     angle,
+                                     float                     offset,
+                                     const TraceHeaderFormat * format,
+                                     const Simbox            & full_inversion_simbox,
+                                     int                       n_threads,
+                                     bool                      show_progress,
+                                     bool                    & sampling_inconsistency,
+                                     std::string             & err_text,
+                                     std::string             & err_text_cube) const; // Thread safe. err_text_cube is per angle text.
+
   bool               ReadWellData(ModelSettings                           * model_settings,
                                   Simbox                                  * full_inv_simbox,
                                   InputFiles                              * input_files,
@@ -5,6 +5,7 @@
 #include <assert.h>
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <string.h>
 
 #include "nrlib/iotools/logkit.hpp"
 
@@ -125,6 +126,22 @@ CovGridSeparated::CovGridSeparated(int nxp, int nyp, int nzp) :
   }
 }
 
+CovGridSeparated::CovGridSeparated(const CovGridSeparated & cov) :
+  nxp_(cov.nxp_), nyp_(cov.nyp_), nzp_(cov.nzp_), gammaXY_(NULL), gammaZ_(NULL), tabulateCorr_(cov.tabulateCorr_),
+  dx_(cov.dx_), dy_(cov.dy_), dz_(cov.dz_),
+  rangeX_(cov.rangeX_), rangeY_(cov.rangeY_), rangeZ_(cov.rangeZ_), power_(cov.power_), rotAngle_(cov.rotAngle_) {
+
+  memcpy(rotMatrix_, cov.rotMatrix_, sizeof(rotMatrix_));
+  if (cov.gammaXY_) {
+    gammaXY_ = new float[nxp_*nyp_];
+    memcpy(gammaXY_, cov.gammaXY_, nxp_*nyp_*sizeof(float));
+  }
+  if (cov.gammaZ_) {
+    gammaZ_ = new float[nzp_];
+    memcpy(gammaZ_, cov.gammaZ_, nzp_*sizeof(float));
+  }
+}
+
 CovGridSeparated::~CovGridSeparated(void)
 {
   if (gammaXY_)
@@ -18,6 +18,7 @@ public:
                    float rotAngle = 0.f,
                    bool tabulateCorr = true); // for BG model
   CovGridSeparated(int nxp, int nyp, int nzp); // for CrCorr = 0
+  CovGridSeparated(const CovGridSeparated & cov);
   ~CovGridSeparated(void);
 
   float   GetGamma2(int i1, int j1, int k1, int i2, int j2, int k2) const; // returns RMISSING if it fails
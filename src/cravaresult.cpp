@@ -45,7 +45,8 @@ block_grid_(NULL),
 facies_prob_undef_(NULL),
 quality_grid_(NULL),
 write_crava_(false),
-n_intervals_(1)
+n_intervals_(1),
+n_threads_(1)
 {
 }
 
@@ -220,6 +221,7 @@ void CravaResult::CombineResults(ModelSettings                        * model_se
   MultiIntervalGrid * multi_interval_grid     = common_data->GetMultipleIntervalGrid();
   Simbox & output_simbox                      = common_data->GetOutputSimbox();
   n_intervals_                                = multi_interval_grid->GetNIntervals();
+  n_threads_                                  = model_settings->getNumberOfThreads();
 
   //Rapport
   if (n_intervals_ > 1 || output_simbox.getnz() != multi_interval_grid->GetIntervalSimbox(0)->getnz()) {
@@ -704,109 +706,149 @@ void CravaResult::CombineResult(StormContGrid                    *& final_grid,
       nz_old[zone] = CommonData::FindClosestFactorableNumber(multi_interval_grid->GetIntervalSimbox(static_cast<int>(zone))->getnz()+100);
   }
 
-  std::vector<rfftwnd_plan> small_plans;
-  std::vector<rfftwnd_plan> big_plans;
+  //The traces are resampled to a grid "scale" times finer than the interval grid, and the
+  //nearest fine value is used. Only the fine values that are used are evaluated.
   int scale = 10; //How densely to sample "fine" values.
-  CreateDownscalingPlans(nz_old,
+  std::vector<std::vector<double> > phase_tables;
+  CreateResamplingTables(nz_old,
                          scale,
-                         small_plans,
-                         big_plans);
+                         phase_tables);
 
-  //Resample
-  for (int i = 0; i < nx; i++) {
-    for (int j = 0; j < ny; j++) {
-
-      //Combine vectors for each interval to one trace in stormgrid
-      std::vector<float> combined_trace(nz);
+  //Traces of grids on file can only be read from one thread.
+  bool in_memory = true;
+  if (use_nrlib_grids == false) {
+    for (size_t zone = 0; zone < interval_grids.size(); zone++)
+      in_memory = in_memory && !interval_grids[zone]->isFile();
+  }
 
-      if (missing_map != NULL && (*missing_map)(i,j) == true) {
-        for (int k = 0; k < nz; k++)
-          combined_trace[k] = RMISSING;
-      }
-      else {
-        std::vector<std::vector<float> > new_traces(n_intervals_); //Finely interpolated values
-
-        //Resample each trace to new nz
-        for (int zone = 0; zone < n_intervals_; zone++) {
-          std::vector<float> old_trace;
-          if (use_nrlib_grids == false) {
-            FFTGrid * interval_grid  = interval_grids[zone];
-            old_trace = interval_grid->getRealTrace(i, j); //old_trace is changed below.
-          }
-          else {
-            old_trace = GetNRLibGridTrace(interval_grids_nrlib[zone], i, j);
-          }
-          int prepad_size = static_cast<int>(old_trace.size());
-          AddPadding(old_trace, nz_old[zone]);
+  int n_traces_done = 0;
 
-          new_traces[zone].resize(nz_old[zone]*scale);
+  //Resample
+#ifdef PARALLEL
+#pragma omp parallel if(in_memory) num_threads(n_threads_)
+#endif
+  {
+    std::vector<rfftwnd_plan>   plans(n_intervals_);
+    std::vector<fftw_real *>    amps(n_intervals_);
+    std::vector<int>            out_len(n_intervals_);
+    std::vector<bool>           transformed(n_intervals_);
+
+    for (int zone = 0; zone < n_intervals_; zone++) {
+      int nt = nz_old[zone];
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+      plans[zone] = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+      amps[zone]  = static_cast<fftw_real*>(fftw_malloc(sizeof(float)*2*(nt/2 + 1)));
+    }
+
+    //Combine vectors for each interval to one trace in stormgrid
+    std::vector<float> combined_trace(nz);
+
+#ifdef PARALLEL
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int i = 0; i < nx; i++) {
+      for (int j = 0; j < ny; j++) {
 
-          DownscaleTrace(old_trace,
-                         new_traces[zone],
-                         scale,
-                         prepad_size,
-                         small_plans[zone],
-                         big_plans[zone]);
+        if (missing_map != NULL && (*missing_map)(i,j) == true) {
+          for (int k = 0; k < nz; k++)
+            combined_trace[k] = RMISSING;
+        }
+        else {
+          //Each trace is transformed when first needed in this column
+          for (int zone = 0; zone < n_intervals_; zone++)
+            transformed[zone] = false;
 
-        } //n_intervals
+          for (int k = 0; k < nz; k++) {
+            double global_x = 0.0;
+            double global_y = 0.0;
+            double global_z = 0.0;
+
+            double value = 0;
+            final_grid->FindCenterOfCell(i, j, k, global_x, global_y, global_z);
+            for (int zone = 0; zone < n_intervals_; zone++) {
+              if(zone_probability[zone](i,j,k) > 0) {
+                if (transformed[zone] == false) {
+                  std::vector<float> old_trace;
+                  if (use_nrlib_grids == false)
+                    old_trace = interval_grids[zone]->getRealTrace(i, j); //old_trace is changed below.
+                  else
+                    old_trace = GetNRLibGridTrace(interval_grids_nrlib[zone], i, j);
+
+                  out_len[zone] = TransformTrace(old_trace,
+                                                 nz_old[zone],
+                                                 scale,
+                                                 plans[zone],
+                                                 amps[zone]);
+                  transformed[zone] = true;
+                }
 
-        for (int k = 0; k < nz; k++) {
-          double global_x = 0.0;
-          double global_y = 0.0;
-          double global_z = 0.0;
-
-          double value = 0;
-          final_grid->FindCenterOfCell(i, j, k, global_x, global_y, global_z);
-          for (int zone = 0; zone < n_intervals_; zone++) {
-            if(zone_probability[zone](i,j,k) > 0) {
-              Simbox * z_simbox = multi_interval_grid->GetIntervalSimbox(zone);
-              double dummy1, dummy2, rel_index;
-              z_simbox->getInterpolationIndexes(global_x, global_y, global_z, dummy1, dummy2, rel_index);
-              rel_index -= 0.5; //First half grid cell is outside interpolation vector.
-              rel_index /= static_cast<double>(z_simbox->getnz()-1);
-              if(rel_index < 0)
-                rel_index = 0;
-              else if(rel_index > 1)
-                rel_index = 1;
-
-              int index = static_cast<int>(floor(0.5+rel_index*(new_traces[zone].size()-1))); //0 to first item, 1 to last item.
-              value += zone_probability[zone](i,j,k)*new_traces[zone][index];
+                Simbox * z_simbox = multi_interval_grid->GetIntervalSimbox(zone);
+                double dummy1, dummy2, rel_index;
+                z_simbox->getInterpolationIndexes(global_x, global_y, global_z, dummy1, dummy2, rel_index);
+                rel_index -= 0.5; //First half grid cell is outside interpolation vector.
+                rel_index /= static_cast<double>(z_simbox->getnz()-1);
+                if(rel_index < 0)
+                  rel_index = 0;
+                else if(rel_index > 1)
+                  rel_index = 1;
+
+                int index = static_cast<int>(floor(0.5+rel_index*(out_len[zone]-1))); //0 to first item, 1 to last item.
+                value += zone_probability[zone](i,j,k)*EvaluateResampledTrace(reinterpret_cast<fftw_complex *>(amps[zone]),
+                                                                              nz_old[zone],
+                                                                              index,
+                                                                              phase_tables[zone]);
+              }
             }
+            combined_trace[k] = static_cast<float>(value);
           }
-          combined_trace[k] = static_cast<float>(value);
-        }
 
-        //Filter background grids
-        if (apply_filter == true) {
+          //Filter background grids
+          if (apply_filter == true) {
 
-          std::vector<float> filtered_trace(nz);
-          double lz = final_grid->GetLZ();
-          double dz = lz/nz;
-          CommonData::ApplyFilter(filtered_trace,
-                                  combined_trace,
-                                  nz,
-                                  dz,
-                                  max_hz);
+            std::vector<float> filtered_trace(nz);
+            double lz = final_grid->GetLZ();
+            double dz = lz/nz;
+            CommonData::ApplyFilter(filtered_trace,
+                                    combined_trace,
+                                    nz,
+                                    dz,
+                                    max_hz);
 
-          for (int k = 0; k < nz; k++) {
-            combined_trace[k] = filtered_trace[k];
+            for (int k = 0; k < nz; k++) {
+              combined_trace[k] = filtered_trace[k];
+            }
           }
         }
-      }
 
-      for (int k = 0; k < nz; k++) {
-        (*final_grid)(i,j,k) = combined_trace[k];
-      }
+        for (int k = 0; k < nz; k++) {
+          (*final_grid)(i,j,k) = combined_trace[k];
+        }
+      } //ny
 
       // Log progress
-      if (ny*i + j + 1 >= static_cast<int>(next_monitor)) {
-        next_monitor += monitor_size;
-        printf("^");
-        fflush(stdout);
+#ifdef PARALLEL
+#pragma omp critical(combine_progress)
+#endif
+      {
+        n_traces_done += ny;
+        while (n_traces_done >= static_cast<int>(next_monitor)) {
+          next_monitor += monitor_size;
+          printf("^");
+          fflush(stdout);
+        }
       }
+    } //nx
 
-    } //ny
-  } //nx
+    for (int zone = 0; zone < n_intervals_; zone++) {
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+      fftwnd_destroy_plan(plans[zone]);
+      fftw_free(amps[zone]);
+    }
+  }
 
   if (use_nrlib_grids == false) {
     for (size_t i = 0; i < interval_grids.size(); i++) {
@@ -814,11 +856,6 @@ void CravaResult::CombineResult(StormContGrid                    *& final_grid,
       interval_grids[i] = NULL;
     }
   }
-
-  for(size_t zone=0;zone<small_plans.size();zone++) {
-    fftwnd_destroy_plan(small_plans[zone]);
-    fftwnd_destroy_plan(big_plans[zone]);
-  }
 }
 
 
@@ -1258,8 +1295,15 @@ void CravaResult::ResampleTrace(std::vector<double> & old_trace, //not const, it
   int nt = nz_old;
   int mt = nz_new;
 
-  rfftwnd_plan fftplan1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
-  rfftwnd_plan fftplan2 = rfftwnd_create_plan(1, &mt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  rfftwnd_plan fftplan1;
+  rfftwnd_plan fftplan2;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftplan1 = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    fftplan2 = rfftwnd_create_plan(1, &mt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  }
 
   int cnt = nt/2 + 1;
   int rnt = 2*cnt;
@@ -1288,8 +1332,13 @@ void CravaResult::ResampleTrace(std::vector<double> & old_trace, //not const, it
 
   fftw_free(rAmpData);
   fftw_free(rAmpFine);
-  fftwnd_destroy_plan(fftplan1);
-  fftwnd_destroy_plan(fftplan2);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(fftplan1);
+    fftwnd_destroy_plan(fftplan2);
+  }
 
 }
 
@@ -1441,7 +1490,8 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
 
     //From CKrigingAdmin::KrigAll
     if (model_settings->getDebugFlag()) {
-      ParameterOutput::WriteFile(model_settings, block_grid_, "BlockGrid", IO::PathToInversionResults(), &simbox);
+      ParameterOutput::WriteFile(model_settings, block_grid_, "BlockGrid", IO::PathToInversionResults(), &simbox,
+                                 false, "NO_LABEL", NULL, false, 0, model_settings->getNumberOfThreads());
 
       if (write_crava_) {
         std::string file_name = IO::makeFullFileName(IO::PathToInversionResults(), "BlockGrid");
@@ -1523,12 +1573,14 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     std::string file_name_vprho = IO::PrefixPosterior() + IO::PrefixCrossCovariance() + "VpRho";
     std::string file_name_vsrho = IO::PrefixPosterior() + IO::PrefixCrossCovariance() + "VsRho";
 
-    ParameterOutput::WriteFile(model_settings, cov_vp_,        file_name_vp,    IO::PathToCorrelations(), &simbox, false, "Posterior covariance for Vp");
-    ParameterOutput::WriteFile(model_settings, cov_vs_,        file_name_vs,    IO::PathToCorrelations(), &simbox, false, "Posterior covariance for Vs");
-    ParameterOutput::WriteFile(model_settings, cov_rho_,       file_name_rho,   IO::PathToCorrelations(), &simbox, false, "Posterior covariance for density");
-    ParameterOutput::WriteFile(model_settings, cr_cov_vp_vs_,  file_name_vpvs,  IO::PathToCorrelations(), &simbox, false, "Posterior cross-covariance for (Vp,Vs)");
-    ParameterOutput::WriteFile(model_settings, cr_cov_vp_rho_, file_name_vprho, IO::PathToCorrelations(), &simbox, false, "Posterior cross-covariance for (Vp,density)");
-    ParameterOutput::WriteFile(model_settings, cr_cov_vs_rho_, file_name_vsrho, IO::PathToCorrelations(), &simbox, false, "Posterior cross-covariance for (Vs,density)");
+    std::vector<ParameterOutput::OutputGrid> covariances;
+    covariances.push_back(ParameterOutput::OutputGrid(cov_vp_,        file_name_vp,    IO::PathToCorrelations(), false, "Posterior covariance for Vp"));
+    covariances.push_back(ParameterOutput::OutputGrid(cov_vs_,        file_name_vs,    IO::PathToCorrelations(), false, "Posterior covariance for Vs"));
+    covariances.push_back(ParameterOutput::OutputGrid(cov_rho_,       file_name_rho,   IO::PathToCorrelations(), false, "Posterior covariance for density"));
+    covariances.push_back(ParameterOutput::OutputGrid(cr_cov_vp_vs_,  file_name_vpvs,  IO::PathToCorrelations(), false, "Posterior cross-covariance for (Vp,Vs)"));
+    covariances.push_back(ParameterOutput::OutputGrid(cr_cov_vp_rho_, file_name_vprho, IO::PathToCorrelations(), false, "Posterior cross-covariance for (Vp,density)"));
+    covariances.push_back(ParameterOutput::OutputGrid(cr_cov_vs_rho_, file_name_vsrho, IO::PathToCorrelations(), false, "Posterior cross-covariance for (Vs,density)"));
+    ParameterOutput::WriteFiles(model_settings, &simbox, covariances);
 
     if (write_crava_) {
       file_name_vp    = IO::makeFullFileName(IO::PathToCorrelations(), IO::PrefixPosterior() + IO::PrefixCovariance() + "Vp");
@@ -1561,6 +1613,8 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     std::vector<std::string> facies_names = common_data->GetFaciesNames();
     int n_facies = static_cast<int>(facies_names.size());
 
+    std::vector<ParameterOutput::OutputGrid> facies_grids;
+
     std::string base_name = IO::PrefixFaciesProbability();
     if (model_settings->getFaciesProbRelative()) {
       if (model_settings->getFaciesProbFromRockPhysics())
@@ -1575,7 +1629,7 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     if (model_settings->getOutputGridsOther() & IO::FACIESPROB_WITH_UNDEF) {
       for (int i = 0; i < n_facies; i++) {
         std::string file_name = base_name +"With_Undef_"+ facies_names[i];
-        ParameterOutput::WriteToFile(&simbox, time_depth_mapping, model_settings, facies_prob_[i], file_name, "");
+        facies_grids.push_back(ParameterOutput::OutputGrid(facies_prob_[i], file_name, IO::PathToInversionResults(), false, "", time_depth_mapping));
 
         if (write_crava_) {
           std::string file_name_crava = IO::makeFullFileName(IO::PathToInversionResults(), file_name);
@@ -1583,7 +1637,7 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
         }
       }
       std::string file_name = base_name + "Undef";
-      ParameterOutput::WriteToFile(&simbox, time_depth_mapping, model_settings, facies_prob_undef_, file_name, "");
+      facies_grids.push_back(ParameterOutput::OutputGrid(facies_prob_undef_, file_name, IO::PathToInversionResults(), false, "", time_depth_mapping));
 
       if (write_crava_) {
         std::string file_name_crava = IO::makeFullFileName(IO::PathToInversionResults(), file_name);
@@ -1594,7 +1648,7 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     if (model_settings->getOutputGridsOther() & IO::FACIESPROB) {
       for (int i = 0; i < n_facies; i++) {
         std::string file_name = base_name + facies_names[i];
-        ParameterOutput::WriteToFile(&simbox, time_depth_mapping, model_settings, facies_prob_geo_[i], file_name, "");
+        facies_grids.push_back(ParameterOutput::OutputGrid(facies_prob_geo_[i], file_name, IO::PathToInversionResults(), false, "", time_depth_mapping));
 
         if (write_crava_) {
           std::string file_name_crava = IO::makeFullFileName(IO::PathToInversionResults(), file_name);
@@ -1604,7 +1658,7 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     }
     if (model_settings->getOutputGridsOther() & IO::SEISMIC_QUALITY_GRID) {
       std::string file_name = "Seismic_Quality_Grid";
-      ParameterOutput::WriteToFile(&simbox, time_depth_mapping, model_settings, quality_grid_, file_name, "");
+      facies_grids.push_back(ParameterOutput::OutputGrid(quality_grid_, file_name, IO::PathToInversionResults(), false, "", time_depth_mapping));
 
       if (write_crava_) {
         std::string file_name_crava = IO::makeFullFileName(IO::PathToInversionResults(), file_name);
@@ -1614,7 +1668,7 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     if ((model_settings->getOutputGridsOther() & IO::FACIES_LIKELIHOOD) > 0) {
       for (int i = 0; i < n_facies; i++) {
         std::string file_name = IO::PrefixLikelihood() + facies_names[i];
-        ParameterOutput::WriteToFile(&simbox, time_depth_mapping, model_settings, lh_cubes_[i], file_name, "");
+        facies_grids.push_back(ParameterOutput::OutputGrid(lh_cubes_[i], file_name, IO::PathToInversionResults(), false, "", time_depth_mapping));
 
         if (write_crava_) {
           file_name = IO::makeFullFileName(IO::PathToInversionResults(), IO::PrefixLikelihood() + facies_names[i]);
@@ -1623,6 +1677,8 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
 
       }
     }
+
+    ParameterOutput::WriteFiles(model_settings, &simbox, facies_grids);
   }
 
   //Simulations
@@ -1658,6 +1714,8 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
     int n_angles = model_settings->getNumberOfAngles(0); //Only write synthetic seismic for the first vintage
     std::vector<float> angles = model_settings->getAngle(0);
 
+    std::vector<ParameterOutput::OutputGrid> synt_seismic;
+
     for (int i = 0; i < n_angles; i++) {
 
       float theta       = angles[i];
@@ -1670,9 +1728,11 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
       if (((model_settings->getOutputGridsSeismic() & IO::SYNTHETIC_SEISMIC_DATA) > 0) || (model_settings->getForwardModeling() == true)) {
         if (i == 0)
           LogKit::LogFormatted(LogKit::Low,"\nWrite Synthetic Seismic\n");
-        ParameterOutput::WriteFile(model_settings, synt_seismic_data_[i], file_name, IO::PathToSeismicData(), &simbox, true, sgri_label, time_depth_mapping, false, theta_deg);
+        synt_seismic.push_back(ParameterOutput::OutputGrid(synt_seismic_data_[i], file_name, IO::PathToSeismicData(), true, sgri_label, time_depth_mapping, theta_deg));
       }
     }
+
+    ParameterOutput::WriteFiles(model_settings, &simbox, synt_seismic);
   }
 
   //Trend Cubes
@@ -1681,10 +1741,12 @@ void CravaResult::WriteResults(ModelSettings           * model_settings,
 
     const std::vector<std::string>  & trend_cube_parameters = model_settings->getTrendCubeParameters();
 
+    std::vector<ParameterOutput::OutputGrid> trend_cubes;
     for (size_t i = 0; i < trend_cubes_.size(); i++) {
       std::string file_name = IO::PrefixTrendCubes() + trend_cube_parameters[i];
-      ParameterOutput::WriteFile(model_settings, trend_cubes_[i], file_name, IO::PathToRockPhysics(), &simbox, false, "trend cube", time_depth_mapping);
+      trend_cubes.push_back(ParameterOutput::OutputGrid(trend_cubes_[i], file_name, IO::PathToRockPhysics(), false, "trend cube", time_depth_mapping));
     }
+    ParameterOutput::WriteFiles(model_settings, &simbox, trend_cubes);
   }
 
   Timings::setTimeWriteResults(wall,cpu);
@@ -1704,6 +1766,7 @@ void CravaResult::WriteEstimationResults(ModelSettings * model_settings,
   blocked_logs_ = common_data->GetBlockedLogsOutput();
 
   n_intervals_ = common_data->GetMultipleIntervalGrid()->GetNIntervals();
+  n_threads_   = model_settings->getNumberOfThreads();
   if (n_intervals_ == 1 && ((model_settings->getOutputGridFormat() & IO::CRAVA) > 0))
     write_crava_ = true;
 
@@ -2006,7 +2069,8 @@ void CravaResult::WriteSeismicData(ModelSettings * model_settings,
 
           float theta_deg   = static_cast<float>((angles[j]*180.0/NRLib::Pi));
           if ((model_settings->getOutputGridsSeismic() & IO::ORIGINAL_SEISMIC_DATA) > 0)
-            ParameterOutput::WriteFile(model_settings, seismic_storm, file_name_orig, IO::PathToSeismicData(), &simbox, true, sgri_label, time_depth_mapping, false, theta_deg);
+            ParameterOutput::WriteFile(model_settings, seismic_storm, file_name_orig, IO::PathToSeismicData(), &simbox, true, sgri_label, time_depth_mapping, false, theta_deg,
+                                       model_settings->getNumberOfThreads());
 
           if (model_settings->getEstimationMode() == false) {
             if ((i==0) && ((model_settings->getOutputGridsSeismic() & IO::RESIDUAL) > 0)) { //residuals only for first vintage.
@@ -2023,7 +2087,8 @@ void CravaResult::WriteSeismicData(ModelSettings * model_settings,
               sgri_label = "Residual computed from synthetic seismic for incidence angle "+angle;
               std::string file_name  = IO::PrefixResiduals() + angle;
 
-              ParameterOutput::WriteFile(model_settings, &residual, file_name, IO::PathToSeismicData(), &simbox, true, sgri_label, time_depth_mapping, false, theta_deg);
+              ParameterOutput::WriteFile(model_settings, &residual, file_name, IO::PathToSeismicData(), &simbox, true, sgri_label, time_depth_mapping, false, theta_deg,
+                                         model_settings->getNumberOfThreads());
             }
           }
         }
@@ -2219,9 +2284,11 @@ void CravaResult::WriteGridPackage(const ModelSettings     * model_settings,
     ExpTransf(grid_rho);
   }
 
-  ParameterOutput::WriteFile(model_settings, grid_vp,  file_name_vp,  path, simbox, false, "NO_LABEL", depth_mapping);
-  ParameterOutput::WriteFile(model_settings, grid_vs,  file_name_vs,  path, simbox, false, "NO_LABEL", depth_mapping);
-  ParameterOutput::WriteFile(model_settings, grid_rho, file_name_rho, path, simbox, false, "NO_LABEL", depth_mapping);
+  std::vector<ParameterOutput::OutputGrid> grids;
+  grids.push_back(ParameterOutput::OutputGrid(grid_vp,  file_name_vp,  path, false, "NO_LABEL", depth_mapping));
+  grids.push_back(ParameterOutput::OutputGrid(grid_vs,  file_name_vs,  path, false, "NO_LABEL", depth_mapping));
+  grids.push_back(ParameterOutput::OutputGrid(grid_rho, file_name_rho, path, false, "NO_LABEL", depth_mapping));
+  ParameterOutput::WriteFiles(model_settings, simbox, grids);
 
 }
 
@@ -2470,18 +2537,21 @@ void CravaResult::GenerateWellOptSyntSeis(ModelSettings
 
 
 void
-CravaResult::CreateDownscalingPlans(const std::vector<int>    & nzp,
-                                    int                         scale,
-                                    std::vector<rfftwnd_plan> & small_plans,
-                                    std::vector<rfftwnd_plan> & big_plans)
+CravaResult::CreateResamplingTables(const std::vector<int>            & nzp,
+                                    int                                 scale,
+                                    std::vector<std::vector<double> > & phase_tables)
 {
-  small_plans.resize(nzp.size());
-  big_plans.resize(nzp.size());
-  for(size_t zone=0;zone<small_plans.size();zone++) {
-    int nt = nzp[zone];;
-    int mt = nt*scale;
-    small_plans[zone] = rfftwnd_create_plan(1, &nt, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
-    big_plans[zone]   = rfftwnd_create_plan(1, &mt, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  //Cosine and sine of 2*pi*p/mt, interleaved, for each zone
+  phase_tables.resize(nzp.size());
+  for(size_t zone=0;zone<phase_tables.size();zone++) {
+    int mt = nzp[zone]*scale;
+    std::vector<double> & phase = phase_tables[zone];
+    phase.resize(2*mt);
+    for (int p = 0; p < mt; p++) {
+      double theta = 2.0*NRLib::Pi*static_cast<double>(p)/static_cast<double>(mt);
+      phase[2*p]   = cos(theta);
+      phase[2*p+1] = sin(theta);
+    }
   }
 }
 
@@ -2498,46 +2568,48 @@ CravaResult::AddPadding(std::vector<float> & trace,
   }
 }
 
-void
-CravaResult::DownscaleTrace(const std::vector<float> & trace_in,
-                            std::vector<float>       & trace_out,
-                            int                        scale,
-                            int                        prepad_size,
-                            const rfftwnd_plan       & small_plan,
-                            const rfftwnd_plan       & big_plan)
+int
+CravaResult::TransformTrace(std::vector<float> & trace,
+                            int                  nzp,
+                            int                  scale,
+                            const rfftwnd_plan & plan,
+                            fftw_real          * r_amp)
 {
-  //Assumes trace_in is already padded.
-  int nt = static_cast<int>(trace_in.size());
-  int mt = nt*scale;
+  int prepad_size = static_cast<int>(trace.size());
+  AddPadding(trace, nzp);
 
-  int cnt = nt/2 + 1;
-  int rnt = 2*cnt;
-  int cmt = mt/2 + 1;
-  int rmt = 2*cmt;
+  int rnt = 2*(nzp/2 + 1);
+  for (int k = 0; k < nzp; k++)
+    r_amp[k] = trace[k];
+  for (int k = nzp; k < rnt; k++)
+    r_amp[k] = 0.0f;
 
-  fftw_real * rAmpData = static_cast<fftw_real*>(fftw_malloc(sizeof(float)*rnt));
-  fftw_real * rAmpFine = static_cast<fftw_real*>(fftw_malloc(sizeof(float)*rmt));
+  rfftwnd_one_real_to_complex(plan, r_amp, reinterpret_cast<fftw_complex*>(r_amp));
 
-  CommonData::ResampleTrace(trace_in,
-                            small_plan,
-                            big_plan,
-                            rAmpData,
-                            rAmpFine,
-                            nt,
-                            cnt,
-                            rnt,
-                            cmt,
-                            rmt);
+  return prepad_size*scale-(scale-1); //Fine values beyond this are contaminated by padding.
+}
 
-  //Add trend
-  size_t out_len = prepad_size*scale-(scale-1); //Points beyond this are contaminated by padding.
-  trace_out.resize(out_len);
-  for (size_t k = 0; k < out_len; k++) {
-    trace_out[k] = rAmpFine[k];
+double
+CravaResult::EvaluateResampledTrace(const fftw_complex        * c_amp,
+                                    int                         nt,
+                                    int                         index,
+                                    const std::vector<double> & phase)
+{
+  //Fine value number index of the trace with spectrum c_amp, as found by zero padding
+  //the spectrum to mt = scale*nt and transforming back, without forming the fine trace.
+  int cnt = nt/2 + 1;
+  int mt  = static_cast<int>(phase.size()/2);
+
+  double value = c_amp[0].re;
+  int    p     = 0;
+  for (int k = 1; k < cnt; k++) {
+    p += index; //p = k*index modulo mt
+    if (p >= mt)
+      p -= mt;
+    value += 2.0*(c_amp[k].re*phase[2*p] - c_amp[k].im*phase[2*p+1]);
   }
 
-  fftw_free(rAmpData);
-  fftw_free(rAmpFine);
+  return value/static_cast<double>(nt);
 }
 
 NRLib::Grid2D<bool> *
@@ -175,20 +175,23 @@ public:
                             const std::vector<int> & intervals,
                             double                   dz) const;
 
-  void DownscaleTrace(const std::vector<float> & trace_in,
-                      std::vector<float>       & trace_out,
-                      int                        scale,
-                      int                        prepad_size,
-                      const rfftwnd_plan       & small_plan,
-                      const rfftwnd_plan       & big_plan);
+  int TransformTrace(std::vector<float> & trace,
+                     int                  nzp,
+                     int                  scale,
+                     const rfftwnd_plan & plan,
+                     fftw_real          * r_amp);
+
+  static double EvaluateResampledTrace(const fftw_complex        * c_amp,
+                                       int                         nt,
+                                       int                         index,
+                                       const std::vector<double> & phase);
 
   void AddPadding(std::vector<float> & trace,
                   int                  nzp);
 
-  void CreateDownscalingPlans(const std::vector<int>       & nz_old,
-                              int                            scale,
-                              std::vector<rfftwnd_plan>    & small_plans,
-                              std::vector<rfftwnd_plan>    & big_plans);
+  void CreateResamplingTables(const std::vector<int>            & nzp,
+                              int                                 scale,
+                              std::vector<std::vector<double> > & phase_tables);
 
   NRLib::Grid2D<bool> * CreateMissingGrid(const Simbox & simbox);
 
@@ -285,6 +288,7 @@ private:
 
   bool                                                     write_crava_;
   int                                                      n_intervals_;
+  int                                                      n_threads_;       ///< Threads used when combining intervals
 };
 
 #endif
@@ -15,6 +15,8 @@
 #include "src/seismicparametersholder.h"
 #include "src/simbox.h"
 #include "src/gravimetricinversion.h"
+#include "src/commondata.h"
+#include "src/timeline.h"
 
 #include "src/doinversion.h"
 
@@ -52,6 +54,74 @@ void setupStaticModels(ModelGeneral            *& modelGeneral,
   //Add in ModelTravelTimeStatic when ready
 }
 
+bool doIntervalInversion(ModelSettings           * modelSettings,
+                         ModelGeneral            * modelGeneral,
+                         ModelAVOStatic          * modelAVOstatic,
+                         CommonData              * commonData,
+                         SeismicParametersHolder & seismicParameters,
+                         int                       i_interval)
+{
+  //Loop over dataset
+  //i.   ModelAVODynamic
+  //ii.  Inversion
+  //iii. Move model one time-step ahead
+  int  eventType;
+  int  eventIndex;
+  modelGeneral->GetTimeLine()->ReSet();
+
+  double time;
+  int time_index = 0;
+  bool first     = true;
+  while(modelGeneral->GetTimeLine()->GetNextEvent(eventType, eventIndex, time) == true) {
+    if (first == false) {
+        modelGeneral->AdvanceTime(time_index, seismicParameters, modelSettings);
+        time_index++;
+    }
+    bool failed = false;
+    switch(eventType) {
+    case TimeLine::AVO : {
+      LogKit::LogFormatted(LogKit::Low,"\nAVO inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
+      failed = doTimeLapseAVOInversion(modelSettings,
+                                       modelGeneral,
+                                       modelAVOstatic,
+                                       commonData,
+                                       seismicParameters,
+                                       eventIndex,
+                                       i_interval);
+      break;
+    }
+    case TimeLine::TRAVEL_TIME : {
+      LogKit::LogFormatted(LogKit::Low,"\nTravel time inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
+      //failed = doTimeLapseTravelTimeInversion(modelSettings,
+      //                                        modelGeneral,
+      //                                        modelTravelTimeStatic,
+      //                                        inputFiles,
+      //                                        eventIndex,
+      //                                        seismicParameters);
+      break;
+    }
+    case TimeLine::GRAVITY : {
+      LogKit::LogFormatted(LogKit::Low,"\nGravimetric inversion, time lapse "+ CommonData::ConvertIntToString(time_index) +"..\n");
+      //failed = doTimeLapseGravimetricInversion(modelSettings,
+      //                                          modelGeneral,
+      //                                          modelGravityStatic,
+      //                                          commonData,
+      //                                          eventIndex,
+      //                                          seismicParameters);
+      break;
+    }
+    default :
+      failed = true;
+      break;
+    }
+    if(failed)
+      return(true);
+
+    first = false;
+  }
+  return(false);
+}
+
 bool doTimeLapseAVOInversion(ModelSettings           * modelSettings,
                              ModelGeneral            * modelGeneral,
                              ModelAVOStatic          * modelAVOstatic,
@@ -22,6 +22,13 @@ void setupStaticModels(ModelGeneral            *& modelGeneral,
                        CommonData               * commonData,
                        int                        i_interval);
 
+bool doIntervalInversion(ModelSettings           * modelSettings,
+                         ModelGeneral            * modelGeneral,
+                         ModelAVOStatic          * modelAVOstatic,
+                         CommonData              * commonData,
+                         SeismicParametersHolder & seismicParameters,
+                         int                       i_interval);
+
 bool doTimeLapseAVOInversion(ModelSettings           * modelSettings,
                              ModelGeneral            * modelGeneral,
                              ModelAVOStatic          * modelAVOstatic,
@@ -0,0 +1,156 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+
+#include "src/faciesdensitytable.h"
+#include "src/fftgrid.h"
+#include "src/simbox.h"
+
+FaciesDensityTable::FaciesDensityTable(const std::vector<std::vector<FFTGrid *> > & density,
+                                       const std::vector<Simbox *>                & volume)
+  : nFacies_(0),
+    volume_(volume.begin(), volume.end()),
+    table_(density.size())
+{
+  assert(density.size() == volume.size());
+  if (density.size() > 0)
+    nFacies_ = static_cast<int>(density[0].size());
+
+  for (size_t i = 0; i < density.size(); i++) {
+    int nx = volume[i]->getnx();
+    int ny = volume[i]->getny();
+    int nz = volume[i]->getnz();
+
+    std::vector<float> & table = table_[i];
+    table.resize(static_cast<size_t>(nx)*ny*nz*nFacies_);
+
+    for (int f = 0; f < nFacies_; f++) {
+      FFTGrid * grid = density[i][f];
+      grid->setAccessMode(FFTGrid::RANDOMACCESS);
+      size_t index = f;
+      for (int l = 0; l < nz; l++) {
+        for (int k = 0; k < ny; k++) {
+          for (int j = 0; j < nx; j++) {
+            table[index] = std::max<float>(0, grid->getRealValue(j, k, l));
+            index += nFacies_;
+          }
+        }
+      }
+      grid->endAccess();
+    }
+  }
+}
+
+FaciesDensityTable::~FaciesDensityTable(void)
+{
+}
+
+void
+FaciesDensityTable::findCorner(double x, int n, int & i1, int & i2, float & w)
+{
+  i1 = static_cast<int>(floor(x));
+  if (i1 < 0) {
+    i1 = 0;
+    i2 = 0;
+    w  = 0;
+  }
+  else if (i1 >= n-1) {
+    i1 = n-1;
+    i2 = i1;
+    w  = 0;
+  }
+  else {
+    i2 = i1 + 1;
+    w  = static_cast<float>(x - i1);
+  }
+}
+
+void
+FaciesDensityTable::findDensities(const float              * vp,
+                                  const float              * vs,
+                                  const float              * rho,
+                                  int                        n,
+                                  const std::vector<float> & t,
+                                  float                    * dens) const
+{
+  int nAng = static_cast<int>(t.size());
+  int dim  = static_cast<int>(table_.size());
+
+  for (size_t c = 0; c < static_cast<size_t>(n)*nFacies_; c++)
+    dens[c] = 0.0f;
+
+  std::vector<float> angleWeight(nAng);
+
+  for (int i = 0; i < dim; i++) {
+    // Volume i holds the density for the noise levels given by the bits of i
+    int factor = 1;
+    for (int a = 0; a < nAng; a++) {
+      if (a > 0)
+        factor *= 2;
+      angleWeight[a] = ((i & factor) > 0 ? t[a] : 1 - t[a]);
+    }
+
+    const Simbox * volume = volume_[i];
+    const float  * table  = &table_[i][0];
+    int            nx     = volume->getnx();
+    int            ny     = volume->getny();
+    int            nz     = volume->getnz();
+    size_t         sj     = static_cast<size_t>(nFacies_);
+    size_t         sk     = sj*nx;
+    size_t         sl     = sk*ny;
+
+    for (int c = 0; c < n; c++) {
+      double jFull, kFull, lFull;
+      volume->getInterpolationIndexes(vp[c], vs[c], rho[c], jFull, kFull, lFull);
+
+      int   j1, j2, k1, k2, l1, l2;
+      float wj, wk, wl;
+      findCorner(jFull, nx, j1, j2, wj);
+      findCorner(kFull, ny, k1, k2, wk);
+      findCorner(lFull, nz, l1, l2, wl);
+
+      const float * v1 = table + j1*sj + k1*sk + l1*sl;
+      const float * v2 = table + j1*sj + k1*sk + l2*sl;
+      const float * v3 = table + j1*sj + k2*sk + l1*sl;
+      const float * v4 = table + j1*sj + k2*sk + l2*sl;
+      const float * v5 = table + j2*sj + k1*sk + l1*sl;
+      const float * v6 = table + j2*sj + k1*sk + l2*sl;
+      const float * v7 = table + j2*sj + k2*sk + l1*sl;
+      const float * v8 = table + j2*sj + k2*sk + l2*sl;
+
+      float w1 = (1.0f-wj)*(1.0f-wk)*(1.0f-wl);
+      float w2 = (1.0f-wj)*(1.0f-wk)*(     wl);
+      float w3 = (1.0f-wj)*(     wk)*(1.0f-wl);
+      float w4 = (1.0f-wj)*(     wk)*(     wl);
+      float w5 = (     wj)*(1.0f-wk)*(1.0f-wl);
+      float w6 = (     wj)*(1.0f-wk)*(     wl);
+      float w7 = (     wj)*(     wk)*(1.0f-wl);
+      float w8 = (     wj)*(     wk)*(     wl);
+
+      // Straight loop over contiguous facies values, which the compiler vectorises
+      float * d = dens + c*sj;
+      for (int f = 0; f < nFacies_; f++) {
+        float value = w1*v1[f];
+        value += w2*v2[f];
+        value += w3*v3[f];
+        value += w4*v4[f];
+        value += w5*v5[f];
+        value += w6*v6[f];
+        value += w7*v7[f];
+        value += w8*v8[f];
+        for (int a = 0; a < nAng; a++)
+          value *= angleWeight[a];
+        d[f] += value;
+      }
+    }
+  }
+
+  for (size_t c = 0; c < static_cast<size_t>(n)*nFacies_; c++) {
+    if (!(dens[c] > 0.0f))
+      dens[c] = 0.0f;
+  }
+}
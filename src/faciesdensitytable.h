@@ -0,0 +1,51 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#ifndef FACIESDENSITYTABLE_H
+#define FACIESDENSITYTABLE_H
+
+#include <vector>
+
+class FFTGrid;
+class Simbox;
+
+// Facies densities in (Vp, Vs, Rho), tabulated for fast trilinear interpolation.
+//
+// There is one density volume for each combination of angle noise levels. The
+// densities of all facies are copied from their grids once, clipped at zero,
+// and interleaved so that the densities of all facies in a cell are contiguous.
+// The eight corners of an interpolation cell then give the densities of every
+// facies at the cost of eight short contiguous reads.
+//
+// The table is read only after construction, so any number of threads may
+// evaluate densities concurrently.
+
+class FaciesDensityTable
+{
+public:
+  FaciesDensityTable(const std::vector<std::vector<FFTGrid *> > & density,
+                     const std::vector<Simbox *>                & volume);
+  ~FaciesDensityTable(void);
+
+  int    getNFacies(void) const { return nFacies_ ;}
+
+  // Finds the densities of all facies for n cells sharing the noise scale
+  // weights t, typically a trace. The result for cell c and facies f is put
+  // in dens[c*nFacies + f]. Gives the same values as the old per-cell lookup.
+  void   findDensities(const float              * vp,
+                       const float              * vs,
+                       const float              * rho,
+                       int                        n,
+                       const std::vector<float> & t,
+                       float                    * dens) const;
+
+private:
+  static void findCorner(double x, int n, int & i1, int & i2, float & w);
+
+  int                               nFacies_;
+  std::vector<const Simbox *>       volume_;  ///< Volume of each density, not owned
+  std::vector<std::vector<float> >  table_;   ///< Interleaved facies densities for each volume
+};
+
+#endif
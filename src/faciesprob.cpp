@@ -20,6 +20,7 @@
 
 #include "rplib/syntwelldata.h"
 #include "src/faciesprob.h"
+#include "src/faciesdensitytable.h"
 #include "src/fftgrid.h"
 #include "src/fftfilegrid.h"
 #include "src/avoinversion.h"
@@ -517,8 +518,8 @@ void FaciesProb::makeFaciesDens(int                                nfac,
     }
     density[i]->fftInPlace();
     density[i]->multiply(smoother);
+    density[i]->deferScale(float(sqrt(double(nbinsa*nbinsb*nbinsr))));
     density[i]->invFFTInPlace();
-    density[i]->multiplyByScalar(float(sqrt(double(nbinsa*nbinsb*nbinsr))));
   }
 
 
@@ -1240,7 +1241,8 @@ void FaciesProb::makeFaciesProb(int                                        nFac,
     normalizeCubes(priorFaciesCubes);
 
   calculateFaciesProb(postVp, postVs, postRho, density, volume,
-                      p_undef, priorFacies, priorFaciesCubes, noiseScale, seismicLH);
+                      p_undef, priorFacies, priorFaciesCubes, noiseScale, seismicLH,
+                      modelSettings->getNumberOfThreads());
 
   for(int l=0;l<nFacies_;l++){
     if(ModelSettings::getDebugLevel() >= 1) {
@@ -1304,124 +1306,6 @@ float FaciesProb::FindDensityFromPosteriorPDF(const double
     return 0.0;
 }
 
-float FaciesProb::findDensity(float                                       vp,
-                              float                                       vs,
-                              float                                       rho,
-                              const std::vector<std::vector<FFTGrid*> > & density,
-                              int                                         facies,
-                              const std::vector<Simbox *>               & volume,
-                              const std::vector<float>                  & t,
-                              int                                         nAng)
-{
-  double jFull, kFull, lFull;
-
-  int i;
-  int dim = static_cast<int>(density.size());
-  std::vector<float> value(dim);
-  for(i=0;i<dim;i++)
-  {
-  volume[i]->getInterpolationIndexes(vp, vs, rho, jFull, kFull, lFull);
-  int j1,k1,l1;
-  int j2,k2,l2;
-  float wj,wk,wl;
-  j1=k1=l1=j2=k2=l2=0;
-  j1 = static_cast<int>(floor(jFull));
-  if(j1<0) {
-    j1 = 0;
-    j2 = 0;
-    wj = 0;
-  }
-  else if(j1>=volume[i]->getnx()-1) {
-    j1 = volume[i]->getnx()-1;
-    j2 = j1;
-    wj = 0;
-  }
-  else {
-    j2 = j1 + 1;
-    wj = static_cast<float>(jFull-j1);
-  }
-
-  k1 = static_cast<int>(floor(kFull));
-  if(k1<0) {
-    k1 = 0;
-    k2 = 0;
-    wk = 0;
-  }
-  else if(k1>=volume[i]->getny()-1) {
-    k1 = volume[i]->getny()-1;
-    k2 = k1;
-    wk = 0;
-  }
-  else {
-    k2 = k1 + 1;
-    wk = static_cast<float>(kFull-k1);
-  }
-
-  l1 = static_cast<int>(floor(lFull));
-  if(l1<0) {
-    l1 = 0;
-    l2 = 0;
-    wl = 0;
-  }
-  else if(l1>=volume[i]->getnz()-1) {
-    l1 = volume[i]->getnz()-1;
-    l2 = l1;
-    wl = 0;
-  }
-  else {
-    l2 = l1 + 1;
-    wl = static_cast<float>(lFull-l1);
-  }
-
-
-    density[i][facies]->setAccessMode(FFTGrid::RANDOMACCESS);
-    float value1 = std::max<float>(0,density[i][facies]->getRealValue(j1,k1,l1));
-    float value2 = std::max<float>(0,density[i][facies]->getRealValue(j1,k1,l2));
-    float value3 = std::max<float>(0,density[i][facies]->getRealValue(j1,k2,l1));
-    float value4 = std::max<float>(0,density[i][facies]->getRealValue(j1,k2,l2));
-    float value5 = std::max<float>(0,density[i][facies]->getRealValue(j2,k1,l1));
-    float value6 = std::max<float>(0,density[i][facies]->getRealValue(j2,k1,l2));
-    float value7 = std::max<float>(0,density[i][facies]->getRealValue(j2,k2,l1));
-    float value8 = std::max<float>(0,density[i][facies]->getRealValue(j2,k2,l2));
-    density[i][facies]->endAccess();
-    //float value=0;
-    value[i] = 0;
-    value[i] += (1.0f-wj)*(1.0f-wk)*(1.0f-wl)*value1;
-    value[i] += (1.0f-wj)*(1.0f-wk)*(     wl)*value2;
-    value[i] += (1.0f-wj)*(     wk)*(1.0f-wl)*value3;
-    value[i] += (1.0f-wj)*(     wk)*(     wl)*value4;
-    value[i] += (     wj)*(1.0f-wk)*(1.0f-wl)*value5;
-    value[i] += (     wj)*(1.0f-wk)*(     wl)*value6;
-    value[i] += (     wj)*(     wk)*(1.0f-wl)*value7;
-    value[i] += (     wj)*(     wk)*(     wl)*value8;
-  }
-
-  int factor = 1;
-  float valuesum = 0;
-  for(i=0;i<dim;i++)
-  {
-    factor = 1;
-    for(int j=0;j<nAng;j++)
-    {
-      if(j>0)
-        factor*=2;
-      if((i & factor) > 0)
-        value[i]*=t[j];
-      else
-        value[i]*=(1-t[j]);
-    }
-
-    valuesum += value[i];
-  }
-
-  if (valuesum > 0.0)
-    return(valuesum);
-  else
-    return 0.0;
-}
-
-
-
 void FaciesProb::resampleAndWriteDensity(const FFTGrid     * const density,
                                          const std::string & fileName,
                                          const Simbox      * origVol,
@@ -1915,7 +1799,8 @@ void FaciesProb::calculateFaciesProb(FFTGrid
                                      const std::vector<float>                   & priorFacies,
                                      std::vector<FFTGrid *>                     & priorFaciesCubes,
                                      const std::vector<Grid2D *>                & noiseScale,
-                                     FFTGrid                                    * seismicLH)
+                                     FFTGrid                                    * seismicLH,
+                                     int                                          nThreads)
 {
   float * value = new float[nFacies_];
   int i,j,k,l;
@@ -1991,68 +1876,162 @@ void FaciesProb::calculateFaciesProb(FFTGrid
     << "\n  |    |    |    |    |    |    |    |    |    |    |  "
     << "\n  ^";
 
+  FaciesDensityTable table(density, volume);
+
+  bool inMemory = (vpgrid->isFile() == 0 && (seismicLH == NULL || seismicLH->isFile() == 0));
+  for(i=0;i<static_cast<int>(priorFaciesCubes.size());i++)
+    inMemory = inMemory && priorFaciesCubes[i]->isFile() == 0;
+
   float help;
-  float dens;
   float undefSum = p_undefined/(volume[0]->getnx()*volume[0]->getny()*volume[0]->getnz());
-  for(i=0;i<nzp;i++)
+  if(inMemory)
   {
-    for(j=0;j<nyp;j++)
+    //
+    // Find the probabilities one trace at a time, with the traces shared among threads.
+    //
+    nextMonitor = std::max(1.0f, static_cast<float>(ny)*0.02f);
+    monitorSize = nextMonitor;
+    int nRowsDone = 0;
+#ifdef PARALLEL
+#pragma omp parallel num_threads(nThreads)
+#endif
     {
-      for(k=0;k<rnxp;k++)
+      std::vector<float> vpTrace(nz);
+      std::vector<float> vsTrace(nz);
+      std::vector<float> rhoTrace(nz);
+      std::vector<float> densTrace(static_cast<size_t>(nz)*nFacies_);
+      std::vector<float> tTrace(nAng);
+      std::vector<float> valueCell(nFacies_);
+
+#ifdef PARALLEL
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for(int jj=0;jj<ny;jj++)
       {
-        vp = vpgrid->getNextReal();
-        vs = vsgrid->getNextReal();
-        rho = rhogrid->getNextReal();
-        if(k<smallrnxp && j<ny && i<nz)
+        for(int kk=0;kk<nx;kk++)
         {
-          sum = undefSum;
-          for(l=0;l<nFacies_;l++)
+          for(int ii=0;ii<nz;ii++)
           {
-            if(k<nx)
+            vpTrace[ii]  = vpgrid->getRealValue(kk,jj,ii);
+            vsTrace[ii]  = vsgrid->getRealValue(kk,jj,ii);
+            rhoTrace[ii] = rhogrid->getRealValue(kk,jj,ii);
+          }
+          for(int angle = 0;angle<nAng;angle++)
+            tTrace[angle] = float((*tgrid[angle])(kk,jj));
+
+          table.findDensities(&vpTrace[0], &vsTrace[0], &rhoTrace[0], nz, tTrace, &densTrace[0]);
+
+          for(int ii=0;ii<nz;ii++)
+          {
+            float cellSum = undefSum;
+            for(int ll=0;ll<nFacies_;ll++)
             {
-              for(int angle = 0;angle<nAng;angle++)
-                t[angle] = float((*tgrid[angle])(k,j));
-              dens = findDensity(vp, vs, rho, density, l,volume, t, nAng);
-            }
-            else{
-              dens = 1.0;
+              float dens = densTrace[ii*nFacies_ + ll];
+              if(priorFaciesCubes.size() != 0)
+                valueCell[ll] = priorFaciesCubes[ll]->getRealValue(kk,jj,ii)*dens;
+              else
+                valueCell[ll] = priorFacies[ll]*dens;
+              cellSum = cellSum+valueCell[ll];
             }
-            if(priorFaciesCubes.size() != 0)
-              value[l] = priorFaciesCubes[l]->getNextReal()*dens;
-            else
-              value[l] = priorFacies[l]*dens;
-            sum = sum+value[l];
+            for(int ll=0;ll<nFacies_;ll++)
+              faciesProb_[ll]->setRealValue(kk,jj,ii,valueCell[ll]/cellSum);
+            faciesProbUndef_->setRealValue(kk,jj,ii,undefSum/cellSum);
+            if(seismicLH != NULL)
+              seismicLH->setRealValue(kk,jj,ii,cellSum);
           }
-          for(l=0;l<nFacies_;l++)
+        }
+        for(int kk=nx;kk<smallrnxp;kk++)
+        {
+          for(int ii=0;ii<nz;ii++)
           {
-            help = value[l]/sum;
+            for(int ll=0;ll<nFacies_;ll++)
+              faciesProb_[ll]->setRealValue(kk,jj,ii,RMISSING,true);
+            faciesProbUndef_->setRealValue(kk,jj,ii,RMISSING,true);
+            if(seismicLH != NULL)
+              seismicLH->setRealValue(kk,jj,ii,RMISSING,true);
+          }
+        }
+
+        // Log progress
+#ifdef PARALLEL
+#pragma omp critical(facies_progress)
+#endif
+        {
+          nRowsDone++;
+          while (nRowsDone >= static_cast<int>(nextMonitor)) {
+            nextMonitor += monitorSize;
+            std::cout << "^";
+            fflush(stdout);
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    std::vector<float> dens(nFacies_);
+    for(i=0;i<nzp;i++)
+    {
+      for(j=0;j<nyp;j++)
+      {
+        for(k=0;k<rnxp;k++)
+        {
+          vp = vpgrid->getNextReal();
+          vs = vsgrid->getNextReal();
+          rho = rhogrid->getNextReal();
+          if(k<smallrnxp && j<ny && i<nz)
+          {
+            sum = undefSum;
             if(k<nx)
             {
-              faciesProb_[l]->setNextReal(help);
+              for(int angle = 0;angle<nAng;angle++)
+                t[angle] = float((*tgrid[angle])(k,j));
+              table.findDensities(&vp, &vs, &rho, 1, t, &dens[0]);
             }
             else
             {
-              faciesProb_[l]->setNextReal(RMISSING);
+              for(l=0;l<nFacies_;l++)
+                dens[l] = 1.0;
+            }
+            for(l=0;l<nFacies_;l++)
+            {
+              if(priorFaciesCubes.size() != 0)
+                value[l] = priorFaciesCubes[l]->getNextReal()*dens[l];
+              else
+                value[l] = priorFacies[l]*dens[l];
+              sum = sum+value[l];
+            }
+            for(l=0;l<nFacies_;l++)
+            {
+              help = value[l]/sum;
+              if(k<nx)
+              {
+                faciesProb_[l]->setNextReal(help);
+              }
+              else
+              {
+                faciesProb_[l]->setNextReal(RMISSING);
+              }
+            }
+            if(k<nx) {
+              faciesProbUndef_->setNextReal(undefSum/sum);
+              if(seismicLH != NULL)
+                seismicLH->setNextReal(sum);
+            }
+            else {
+              faciesProbUndef_->setNextReal(RMISSING);
+              if(seismicLH != NULL)
+                seismicLH->setNextReal(RMISSING);
             }
-          }
-          if(k<nx) {
-            faciesProbUndef_->setNextReal(undefSum/sum);
-            if(seismicLH != NULL)
-              seismicLH->setNextReal(sum);
-          }
-          else {
-            faciesProbUndef_->setNextReal(RMISSING);
-            if(seismicLH != NULL)
-              seismicLH->setNextReal(RMISSING);
           }
         }
       }
-    }
-    // Log progress
-    if (i+1 >= static_cast<int>(nextMonitor)) {
-      nextMonitor += monitorSize;
-      std::cout << "^";
-      fflush(stdout);
+      // Log progress
+      if (i+1 >= static_cast<int>(nextMonitor)) {
+        nextMonitor += monitorSize;
+        std::cout << "^";
+        fflush(stdout);
+      }
     }
   }
   std::cout << "\n";
@@ -218,15 +218,6 @@ private:
                                             double                    & varVs,
                                             double                    & varRho);
 
-  float                  findDensity(float                                       vp,
-                                     float                                       vs,
-                                     float                                       rho,
-                                     const std::vector<std::vector<FFTGrid*> > & density,
-                                     int                                         facies,
-                                     const std::vector<Simbox *>               & volume,
-                                     const std::vector<float>                  & t,
-                                     int                                         nAng);
-
   float                  FindDensityFromPosteriorPDF(const double                                          & vp,
                                                      const double                                          & vs,
                                                      const double                                          & rho,
@@ -257,7 +248,8 @@ private:
                                              const std::vector<float>     & priorFacies,
                                              std::vector<FFTGrid *>       & priorFaciesCubes,
                                              const std::vector<Grid2D *>   & noiseScale,
-                                             FFTGrid                       * seismicLH);
+                                             FFTGrid                       * seismicLH,
+                                             int                             nThreads);
 
   // shared routine for the calculateFaciesProb functions
 
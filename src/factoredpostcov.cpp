@@ -0,0 +1,285 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include <new>
+
+#include "nrlib/iotools/logkit.hpp"
+#include "nrlib/iotools/stringtools.hpp"
+
+#include "src/factoredpostcov.h"
+#include "src/seismicparametersholder.h"
+#include "src/covgridseparated.h"
+#include "src/gridswapfile.h"
+#include "src/fftgrid.h"
+#include "src/io.h"
+
+#include "lib/lib_matr.h"
+
+FactoredPostCov::FactoredPostCov(SeismicParametersHolder & seismicParameters,
+                                 bool                      keepInMemory,
+                                 bool                      tabulateKrigingCov,
+                                 int                       nThreads)
+  : fileName_(""),
+    nThreads_(std::max(nThreads, 1))
+{
+  FFTGrid * postCovVp = seismicParameters.GetCovVp();
+  assert(postCovVp->getIsTransformed());
+
+  cnxp_ = postCovVp->getCNxp();
+  nyp_  = postCovVp->getNyp();
+  nzp_  = postCovVp->getNzp();
+
+  if (keepInMemory) {
+    try {
+      factors_.resize(9*postCovVp->getcsize());
+    }
+    catch (std::bad_alloc & ) {
+      std::vector<float>().swap(factors_);
+      LogKit::LogFormatted(LogKit::Low,"\nNot enough memory to keep the posterior Cholesky factors in memory. They are kept on file.\n");
+    }
+  }
+
+  if (isInMemory())
+    factoriseInMemory(seismicParameters);
+  else
+    factoriseToFile(seismicParameters);
+
+  if (tabulateKrigingCov) {
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCovVp()     ));
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCovVs()     ));
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCovRho()    ));
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCrCovVpVs() ));
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCrCovVpRho()));
+    krigingCov_.push_back(new CovGridSeparated(*seismicParameters.GetCrCovVsRho()));
+  }
+}
+
+FactoredPostCov::~FactoredPostCov(void)
+{
+  releaseFactors();
+  for (size_t c = 0; c < krigingCov_.size(); c++)
+    delete krigingCov_[c];
+}
+
+void
+FactoredPostCov::releaseFactors(void)
+{
+  std::vector<float>().swap(factors_);
+  if (fileName_ != "") {
+    remove(fileName_.c_str());
+    fileName_ = "";
+  }
+}
+
+void
+FactoredPostCov::factoriseInMemory(SeismicParametersHolder & seismicParameters)
+{
+  FFTGrid * postCovVp      = seismicParameters.GetCovVp();
+  FFTGrid * postCovVs      = seismicParameters.GetCovVs();
+  FFTGrid * postCovRho     = seismicParameters.GetCovRho();
+  FFTGrid * postCrCovVpVs  = seismicParameters.GetCrCovVpVs();
+  FFTGrid * postCrCovVpRho = seismicParameters.GetCrCovVpRho();
+  FFTGrid * postCrCovVsRho = seismicParameters.GetCrCovVsRho();
+
+  size_t planeSize = static_cast<size_t>(cnxp_)*nyp_;
+
+#ifdef PARALLEL
+#pragma omp parallel num_threads(nThreads_)
+#endif
+  {
+    fftw_complex ** ijkPostCov = lib_matrAllocCpx(3, 3);
+
+#ifdef PARALLEL
+#pragma omp for schedule(static)
+#endif
+    for (int k = 0; k < nzp_; k++) {
+      for (size_t index = k*planeSize; index < (k+1)*planeSize; index++) {
+        ijkPostCov[0][0] = postCovVp     ->getComplexValue(index);
+        ijkPostCov[1][1] = postCovVs     ->getComplexValue(index);
+        ijkPostCov[2][2] = postCovRho    ->getComplexValue(index);
+        ijkPostCov[0][1] = postCrCovVpVs ->getComplexValue(index);
+        ijkPostCov[0][2] = postCrCovVpRho->getComplexValue(index);
+        ijkPostCov[1][2] = postCrCovVsRho->getComplexValue(index);
+
+        factoriseCell(ijkPostCov, &factors_[9*index]);
+      }
+    }
+    lib_matrFreeCpx(ijkPostCov);
+  }
+}
+
+void
+FactoredPostCov::factoriseToFile(SeismicParametersHolder & seismicParameters)
+{
+  FFTGrid * postCovVp      = seismicParameters.GetCovVp();
+  FFTGrid * postCovVs      = seismicParameters.GetCovVs();
+  FFTGrid * postCovRho     = seismicParameters.GetCovRho();
+  FFTGrid * postCrCovVpVs  = seismicParameters.GetCrCovVpVs();
+  FFTGrid * postCrCovVpRho = seismicParameters.GetCrCovVpRho();
+  FFTGrid * postCrCovVsRho = seismicParameters.GetCrCovVsRho();
+
+  int fileNum;
+#ifdef PARALLEL
+#pragma omp critical(fft_file_grid_name)
+#endif
+  fileNum = fileNum_++;
+  fileName_ = IO::makeFullFileName(IO::PathToTmpFiles(), IO::PrefixTmpGrids() + "postcovchol" + NRLib::ToString(fileNum));
+
+  GridSwapFile file;
+  file.openWrite(fileName_, 9*static_cast<size_t>(cnxp_)*nyp_);
+
+  postCovVp     ->setAccessMode(FFTGrid::READ);
+  postCovVs     ->setAccessMode(FFTGrid::READ);
+  postCovRho    ->setAccessMode(FFTGrid::READ);
+  postCrCovVpVs ->setAccessMode(FFTGrid::READ);
+  postCrCovVpRho->setAccessMode(FFTGrid::READ);
+  postCrCovVsRho->setAccessMode(FFTGrid::READ);
+
+  fftw_complex ** ijkPostCov = lib_matrAllocCpx(3, 3);
+  float           L[9];
+
+  for (int k = 0; k < nzp_; k++) {
+    for (int j = 0; j < nyp_; j++) {
+      for (int i = 0; i < cnxp_; i++) {
+        ijkPostCov[0][0] = postCovVp     ->getNextComplex();
+        ijkPostCov[1][1] = postCovVs     ->getNextComplex();
+        ijkPostCov[2][2] = postCovRho    ->getNextComplex();
+        ijkPostCov[0][1] = postCrCovVpVs ->getNextComplex();
+        ijkPostCov[0][2] = postCrCovVpRho->getNextComplex();
+        ijkPostCov[1][2] = postCrCovVsRho->getNextComplex();
+
+        factoriseCell(ijkPostCov, L);
+        for (int l = 0; l < 9; l++)
+          file.setNext(L[l]);
+      }
+    }
+  }
+  lib_matrFreeCpx(ijkPostCov);
+  file.close();
+
+  postCovVp     ->endAccess();
+  postCovVs     ->endAccess();
+  postCovRho    ->endAccess();
+  postCrCovVpVs ->endAccess();
+  postCrCovVpRho->endAccess();
+  postCrCovVsRho->endAccess();
+}
+
+void
+FactoredPostCov::multiplyByFactors(FFTGrid * seed0,
+                                   FFTGrid * seed1,
+                                   FFTGrid * seed2) const
+{
+  // Overwrites the seeds with L times the seeds, as lib_matrProdCholVec().
+  if (isInMemory() && !seed0->isFile() && !seed1->isFile() && !seed2->isFile()) {
+    size_t planeSize = static_cast<size_t>(cnxp_)*nyp_;
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(nThreads_)
+#endif
+    for (int k = 0; k < nzp_; k++) {
+      for (size_t index = k*planeSize; index < (k+1)*planeSize; index++) {
+        fftw_complex s0 = seed0->getComplexValue(index);
+        fftw_complex s1 = seed1->getComplexValue(index);
+        fftw_complex s2 = seed2->getComplexValue(index);
+
+        multiplyCell(&factors_[9*index], s0, s1, s2);
+
+        seed0->setComplexValue(index, s0);
+        seed1->setComplexValue(index, s1);
+        seed2->setComplexValue(index, s2);
+      }
+    }
+    return;
+  }
+
+  GridSwapFile file;
+  if (!isInMemory())
+    file.openRead(fileName_, 9*static_cast<size_t>(cnxp_)*nyp_);
+
+  seed0->setAccessMode(FFTGrid::READANDWRITE);
+  seed1->setAccessMode(FFTGrid::READANDWRITE);
+  seed2->setAccessMode(FFTGrid::READANDWRITE);
+
+  size_t index = 0;
+  float  L[9];
+  for (int k = 0; k < nzp_; k++) {
+    for (int j = 0; j < nyp_; j++) {
+      for (int i = 0; i < cnxp_; i++) {
+        fftw_complex s0 = seed0->getNextComplex();
+        fftw_complex s1 = seed1->getNextComplex();
+        fftw_complex s2 = seed2->getNextComplex();
+
+        if (isInMemory())
+          multiplyCell(&factors_[9*index], s0, s1, s2);
+        else {
+          for (int l = 0; l < 9; l++)
+            L[l] = file.getNext();
+          multiplyCell(L, s0, s1, s2);
+        }
+        index++;
+
+        seed0->setNextComplex(s0);
+        seed1->setNextComplex(s1);
+        seed2->setNextComplex(s2);
+      }
+    }
+  }
+
+  seed0->endAccess();
+  seed1->endAccess();
+  seed2->endAccess();
+}
+
+void
+FactoredPostCov::factoriseCell(fftw_complex ** postCov, float * L)
+{
+  // Only the upper triangle of postCov needs to be filled in on entry.
+  postCov[1][0].re =  postCov[0][1].re;
+  postCov[1][0].im = -postCov[0][1].im;
+  postCov[2][0].re =  postCov[0][2].re;
+  postCov[2][0].im = -postCov[0][2].im;
+  postCov[2][1].re =  postCov[1][2].re;
+  postCov[2][1].im = -postCov[1][2].im;
+
+  if (lib_matrCholCpx(3, postCov) == 0) {
+    L[0] = postCov[0][0].re;
+    L[1] = postCov[1][1].re;
+    L[2] = postCov[2][2].re;
+    L[3] = postCov[1][0].re;
+    L[4] = postCov[1][0].im;
+    L[5] = postCov[2][0].re;
+    L[6] = postCov[2][0].im;
+    L[7] = postCov[2][1].re;
+    L[8] = postCov[2][1].im;
+  }
+  else {
+    for (int l = 0; l < 9; l++)
+      L[l] = 0.0f;
+  }
+}
+
+void
+FactoredPostCov::multiplyCell(const float  * L,
+                              fftw_complex & s0,
+                              fftw_complex & s1,
+                              fftw_complex & s2)
+{
+  fftw_complex r0, r1, r2;
+
+  r0.re = L[0]*s0.re;
+  r0.im = L[0]*s0.im;
+  r1.re = L[3]*s0.re - L[4]*s0.im + L[1]*s1.re;
+  r1.im = L[3]*s0.im + L[4]*s0.re + L[1]*s1.im;
+  r2.re = L[5]*s0.re - L[6]*s0.im + L[7]*s1.re - L[8]*s1.im + L[2]*s2.re;
+  r2.im = L[5]*s0.im + L[6]*s0.re + L[7]*s1.im + L[8]*s1.re + L[2]*s2.im;
+
+  s0 = r0;
+  s1 = r1;
+  s2 = r2;
+}
+
+int FactoredPostCov::fileNum_ = 0;
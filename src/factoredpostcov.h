@@ -0,0 +1,67 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#ifndef FACTOREDPOSTCOV_H
+#define FACTOREDPOSTCOV_H
+
+#include <string>
+#include <vector>
+
+#include "fftw.h"
+
+class FFTGrid;
+class CovGridSeparated;
+class SeismicParametersHolder;
+
+// Factored posterior covariance of (Vp, Vs, Rho).
+//
+// The Cholesky factor L of the complex 3x3 posterior covariance is computed
+// once for each Fourier cell and stored packed as nine floats: L00, L11, L22
+// (real), followed by L10, L20 and L21 (complex). A zero factor is stored where
+// the covariance is not positive definite. The factors are kept in memory when
+// the covariance grids are, and memory allows it. Otherwise they are written to
+// a temporary file that is read sequentially, one xy-plane at a time.
+//
+// The separable covariances used for kriging to wells may also be tabulated
+// once and shared by all kriging calls.
+//
+// The store is only valid as long as the posterior covariance grids are unchanged.
+
+class FactoredPostCov
+{
+public:
+  FactoredPostCov(SeismicParametersHolder & seismicParameters,
+                  bool                      keepInMemory,
+                  bool                      tabulateKrigingCov,
+                  int                       nThreads);
+  ~FactoredPostCov(void);
+
+  bool                                    isInMemory(void)             const { return !factors_.empty() ;}
+  const std::vector<CovGridSeparated *> & getKrigingCovariances(void)  const { return krigingCov_       ;}
+
+  void                                    multiplyByFactors(FFTGrid * seed0,
+                                                            FFTGrid * seed1,
+                                                            FFTGrid * seed2) const;
+  void                                    releaseFactors(void);
+
+private:
+  void                                    factoriseInMemory(SeismicParametersHolder & seismicParameters);
+  void                                    factoriseToFile(SeismicParametersHolder & seismicParameters);
+
+  static void                             factoriseCell(fftw_complex ** postCov, float * L);
+  static void                             multiplyCell(const float * L, fftw_complex & s0, fftw_complex & s1, fftw_complex & s2);
+
+  std::vector<float>                      factors_;     ///< Packed factors when kept in memory
+  std::string                             fileName_;    ///< File with packed factors when not kept in memory
+  std::vector<CovGridSeparated *>         krigingCov_;  ///< Vp, Vs, Rho, VpVs, VpRho, VsRho. Empty if not tabulated.
+
+  int                                     cnxp_;
+  int                                     nyp_;
+  int                                     nzp_;
+  int                                     nThreads_;
+
+  static int                              fileNum_;     ///< Gives each factor file a unique name
+};
+
+#endif
@@ -0,0 +1,168 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#include <stdio.h>
+#include <algorithm>
+
+#ifdef PARALLEL
+#include <omp.h>
+#endif
+
+#include "fftw.h"
+#include "rfftw.h"
+
+#include "src/fftengine.h"
+#include "src/definitions.h"
+
+bool
+FFTEngine::PlanKey::operator<(const PlanKey & k) const
+{
+  if (nxp != k.nxp)
+    return nxp < k.nxp;
+  if (nyp != k.nyp)
+    return nyp < k.nyp;
+  if (nzp != k.nzp)
+    return nzp < k.nzp;
+  return forward < k.forward;
+}
+
+void
+FFTEngine::setNumberOfThreads(int nThreads)
+{
+  nThreads_ = std::max(nThreads, 1);
+}
+
+void
+FFTEngine::setWisdomFile(const std::string & fileName)
+{
+  wisdomFile_ = fileName;
+
+  FILE * file = fopen(wisdomFile_.c_str(), "r");
+  if (file != NULL) {
+    if (fftw_import_wisdom_from_file(file) == FFTW_SUCCESS)
+      LogKit::LogFormatted(LogKit::Low, "\nFFT plans are taken from wisdom file \'%s\'.\n", wisdomFile_.c_str());
+    else
+      LogKit::LogFormatted(LogKit::Warning, "\nWARNING: Could not read FFT wisdom file \'%s\'. The file will be regenerated.\n", wisdomFile_.c_str());
+    fclose(file);
+  }
+}
+
+void
+FFTEngine::exportWisdom(void)
+{
+  if (wisdomFile_ == "")
+    return;
+
+  FILE * file = fopen(wisdomFile_.c_str(), "w");
+  if (file != NULL) {
+    fftw_export_wisdom_to_file(file);
+    fclose(file);
+  }
+  else
+    LogKit::LogFormatted(LogKit::Warning, "\nWARNING: Could not write FFT wisdom file \'%s\'.\n", wisdomFile_.c_str());
+}
+
+const FFTEngine::Plan3D &
+FFTEngine::findPlan(int nxp, int nyp, int nzp, bool forward)
+{
+  // Plan creation in FFTW is not thread safe, so all plans are created in the
+  // fftw_planner critical section. The plans are shared by all threads, and
+  // a 2D rfftwnd plan keeps its scratch buffer in the plan unless it is made
+  // with FFTW_THREADSAFE. The 1D column plans allocate their own work space.
+  std::map<PlanKey, Plan3D>::const_iterator it;
+
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    PlanKey key(nxp, nyp, nzp, forward);
+    it = plans_.find(key);
+    if (it == plans_.end()) {
+      int    flag = FFTW_MEASURE | FFTW_USE_WISDOM | FFTW_IN_PLACE | FFTW_THREADSAFE;
+      Plan3D plan;
+      if (forward) {
+        plan.plane  = rfftw2d_create_plan(nyp, nxp, FFTW_REAL_TO_COMPLEX, flag);
+        plan.column = fftw_create_plan(nzp, FFTW_FORWARD, flag);
+      }
+      else {
+        plan.plane  = rfftw2d_create_plan(nyp, nxp, FFTW_COMPLEX_TO_REAL, flag);
+        plan.column = fftw_create_plan(nzp, FFTW_BACKWARD, flag);
+      }
+      it = plans_.insert(std::make_pair(key, plan)).first;
+      exportWisdom();
+    }
+  }
+  return it->second;
+}
+
+void
+FFTEngine::scalePlane(fftw_real * plane, size_t n, float scale)
+{
+  if (scale != 1.0f) {
+    for (size_t i = 0; i < n; i++)
+      plane[i] *= scale;
+  }
+}
+
+void
+FFTEngine::realToComplex3D(fftw_real * rvalue, int nxp, int nyp, int nzp, float scale)
+{
+  const Plan3D & plan = findPlan(nxp, nyp, nzp, true);
+
+  int            cnxp      = nxp/2 + 1;
+  size_t         planeSize = static_cast<size_t>(2*cnxp)*static_cast<size_t>(nyp);
+  fftw_complex * cvalue    = reinterpret_cast<fftw_complex *>(rvalue);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(nThreads_)
+#endif
+  for (int k = 0; k < nzp; k++) {
+    scalePlane(rvalue + k*planeSize, planeSize, scale);
+    rfftwnd_one_real_to_complex(plan.plane, rvalue + k*planeSize, NULL);
+  }
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(nThreads_)
+#endif
+  for (int j = 0; j < nyp; j++)
+    fftw(plan.column, cnxp, cvalue + static_cast<size_t>(j)*cnxp, cnxp*nyp, 1, NULL, 0, 0);
+}
+
+void
+FFTEngine::complexToReal3D(fftw_complex * cvalue, int nxp, int nyp, int nzp, float scale)
+{
+  const Plan3D & plan = findPlan(nxp, nyp, nzp, false);
+
+  int            cnxp      = nxp/2 + 1;
+  size_t         planeSize = static_cast<size_t>(cnxp)*static_cast<size_t>(nyp);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(nThreads_)
+#endif
+  for (int j = 0; j < nyp; j++)
+    fftw(plan.column, cnxp, cvalue + static_cast<size_t>(j)*cnxp, cnxp*nyp, 1, NULL, 0, 0);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(nThreads_)
+#endif
+  for (int k = 0; k < nzp; k++) {
+    rfftwnd_one_complex_to_real(plan.plane, cvalue + k*planeSize, NULL);
+    scalePlane(reinterpret_cast<fftw_real *>(cvalue + k*planeSize), 2*planeSize, scale);
+  }
+}
+
+void
+FFTEngine::destroyPlans(void)
+{
+  std::map<PlanKey, Plan3D>::iterator it;
+  for (it = plans_.begin(); it != plans_.end(); ++it) {
+    rfftwnd_destroy_plan(it->second.plane);
+    fftw_destroy_plan(it->second.column);
+  }
+  plans_.clear();
+}
+
+std::map<FFTEngine::PlanKey, FFTEngine::Plan3D> FFTEngine::plans_;
+int                                             FFTEngine::nThreads_   = 1;
+std::string                                     FFTEngine::wisdomFile_ = "";
@@ -0,0 +1,66 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#ifndef FFTENGINE_H
+#define FFTENGINE_H
+
+#include <map>
+#include <string>
+
+#include "fftw.h"
+#include "rfftw.h"
+
+// In-place 3D real FFTs of padded FFTGrid cubes.
+//
+// The 3D transform is split in a 2D real transform of each xy-plane followed
+// by 1D complex transforms along z. Both passes are distributed over threads.
+// Plans are measured once per (nxp, nyp, nzp, direction) and kept for the rest
+// of the run. If a wisdom file is given, the measurements are also reused
+// between runs.
+//
+// The scale factor is applied to each xy-plane while it is in cache during the
+// plane pass, so normalisation does not need a separate pass over the grid.
+//
+// Storage is the FFTW in-place layout used by FFTGrid: the real grid has
+// 2*(nxp/2+1) values in x, and the complex grid has nxp/2+1 values in x.
+
+class FFTEngine
+{
+public:
+  static void           setNumberOfThreads(int nThreads);
+  static int            getNumberOfThreads(void) { return nThreads_ ;}
+  static void           setWisdomFile(const std::string & fileName);
+
+  static void           realToComplex3D(fftw_real    * rvalue, int nxp, int nyp, int nzp, float scale);
+  static void           complexToReal3D(fftw_complex * cvalue, int nxp, int nyp, int nzp, float scale);
+
+  static void           destroyPlans(void);
+
+private:
+  struct PlanKey
+  {
+    PlanKey(int nx, int ny, int nz, bool fw) : nxp(nx), nyp(ny), nzp(nz), forward(fw) {}
+    bool operator<(const PlanKey & k) const;
+    int  nxp;
+    int  nyp;
+    int  nzp;
+    bool forward;
+  };
+
+  struct Plan3D
+  {
+    rfftwnd_plan        plane;          // 2D real transform of one xy-plane
+    fftw_plan           column;         // 1D complex transform along z
+  };
+
+  static const Plan3D & findPlan(int nxp, int nyp, int nzp, bool forward);
+  static void           exportWisdom(void);
+  static void           scalePlane(fftw_real * plane, size_t n, float scale);
+
+  static std::map<PlanKey, Plan3D> plans_;
+  static int                       nThreads_;
+  static std::string               wisdomFile_;
+};
+
+#endif
@@ -43,6 +43,7 @@ FFTGrid()
   nxp_            = fftGrid->nxp_;
   nyp_            = fftGrid->nyp_;
   nzp_            = fftGrid->nzp_;
+  scale_          = 1.0;
 
   cnxp_           = nxp_/2+1;
   rnxp_           = 2*(cnxp_);
@@ -56,6 +57,9 @@ FFTGrid()
   fNameIn_        = "";
   accMode_        = NONE;
 
+  // The copy is made from the stored values, so the source must hold no deferred scale.
+  fftGrid->applyDeferredScale();
+
   setAccessMode(WRITE);
   fftGrid->setAccessMode(READ);
 
@@ -108,14 +112,14 @@ FFTFileGrid::setAccessMode(int mode)
   switch(mode)
   {
   case READ:
-    NRLib::OpenRead(inFile_,fNameIn_,std::ios::in | std::ios::binary);
+    inFile_.openRead(fNameIn_, getSlabSize());
     break;
   case WRITE:
-    NRLib::OpenWrite(outFile_,fNameOut_,std::ios::out | std::ios::binary);
+    outFile_.openWrite(fNameOut_, getSlabSize());
     break;
   case READANDWRITE:
-    NRLib::OpenRead(inFile_,fNameIn_,std::ios::in | std::ios::binary);
-    NRLib::OpenWrite(outFile_,fNameOut_,std::ios::out | std::ios::binary);
+    inFile_.openRead(fNameIn_, getSlabSize());
+    outFile_.openWrite(fNameOut_, getSlabSize());
     break;
   case RANDOMACCESS:
     modified_ = 0;
@@ -171,11 +175,12 @@ FFTFileGrid::createComplexGrid()
 fftw_complex
 FFTFileGrid::getNextComplex()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(accMode_ == READ || accMode_ == READANDWRITE);
   fftw_complex cVal;
-  char * buffer = reinterpret_cast<char *>(&cVal);
-  inFile_.read(buffer,sizeof(fftw_complex));
+  cVal.re = inFile_.getNext();
+  cVal.im = inFile_.getNext();
   return(cVal);
 }
 
@@ -184,18 +189,17 @@ FFTFileGrid::getNextComplex()
 float
 FFTFileGrid::getNextReal()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_ == false);
   assert(accMode_ == READ || accMode_ == READANDWRITE);
-  float rVal;
-  char * buffer = reinterpret_cast<char *>(&rVal);
-  inFile_.read(buffer,sizeof(float));
-  return float(rVal);
+  return(inFile_.getNext());
 }
 
 
 float
 FFTFileGrid::getRealValue(int i, int j, int k, bool extSimbox)
 {
+  assert(scale_ == 1.0f);
   // i index in x direction
   // j index in y direction
   // k index in z direction
@@ -250,13 +254,11 @@ FFTFileGrid::setRealValue(int i, int j, int k, float value, bool extSimbox)
 int
 FFTFileGrid::SetNextComplex(std::complex<double> & value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(accMode_ == READANDWRITE || accMode_ == WRITE);
-  fftw_complex tmp;
-  tmp.re = static_cast<fftw_real>(value.real());
-  tmp.im = static_cast<fftw_real>(value.imag());
-  char * buffer = reinterpret_cast<char *>(&tmp);
-  outFile_.write(buffer,sizeof(fftw_complex));
+  outFile_.setNext(static_cast<fftw_real>(value.real()));
+  outFile_.setNext(static_cast<fftw_real>(value.imag()));
   return(0);
 }
 
@@ -264,10 +266,11 @@ FFTFileGrid::SetNextComplex(std::complex<double> & value)
 int
 FFTFileGrid::setNextComplex(fftw_complex value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(accMode_ == READANDWRITE || accMode_ == WRITE);
-  char * buffer = reinterpret_cast<char *>(&value);
-  outFile_.write(buffer,sizeof(fftw_complex));
+  outFile_.setNext(value.re);
+  outFile_.setNext(value.im);
   return(0);
 }
 
@@ -275,10 +278,10 @@ FFTFileGrid::setNextComplex(fftw_complex value)
 int
 FFTFileGrid::setNextReal(float  value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_== false);
   assert(accMode_ == READANDWRITE || accMode_ == WRITE);
-  char * buffer = reinterpret_cast<char *>(&value);
-  outFile_.write(buffer,sizeof(float));
+  outFile_.setNext(value);
   return(0);
 }
 
@@ -395,6 +398,21 @@ FFTFileGrid::multiplyByScalar(float scalar)
     save();
 }
 
+void
+FFTFileGrid::applyDeferredScale()
+{
+  if(scale_ == 1.0f)
+    return;
+  assert(accMode_ == NONE || accMode_ == RANDOMACCESS);
+  if(accMode_ != RANDOMACCESS)
+    load();
+  else
+    modified_ = 1;
+  FFTGrid::applyDeferredScale();
+  if(accMode_ != RANDOMACCESS)
+    save();
+}
+
 
 void
 FFTFileGrid::add(FFTGrid * fftGrid)
@@ -407,21 +425,22 @@ FFTFileGrid::add(FFTGrid * fftGrid)
   assert(nxp_==fftGrid->getNxp());
   fftGrid->setAccessMode(READ);
 
+  float factor = fftGrid->getScale()/scale_;
   if(istransformed_==true)
   {
     fftw_complex value;
     for(size_t i=0;i<csize_;i++)
     {
       value = fftGrid->getNextComplex();
-      cvalue_[i].re += value.re;
-      cvalue_[i].im += value.im;
+      cvalue_[i].re += factor*value.re;
+      cvalue_[i].im += factor*value.im;
     }
   }
   else
   {
     for(size_t i=0;i < rsize_;i++)
     {
-      rvalue_[i] += fftGrid->getNextReal();
+      rvalue_[i] += factor*fftGrid->getNextReal();
     }
   }
   fftGrid->endAccess();
@@ -454,21 +473,22 @@ FFTFileGrid::subtract(FFTGrid * fftGrid)
   assert(nxp_==fftGrid->getNxp());
   fftGrid->setAccessMode(READ);
 
+  float factor = fftGrid->getScale()/scale_;
   if(istransformed_==true)
   {
     fftw_complex value;
     for(size_t i=0;i<csize_;i++)
     {
       value = fftGrid->getNextComplex();
-      cvalue_[i].re -= value.re;
-      cvalue_[i].im -= value.im;
+      cvalue_[i].re -= factor*value.re;
+      cvalue_[i].im -= factor*value.im;
     }
   }
   else
   {
     for(size_t i=0;i < rsize_;i++)
     {
-      rvalue_[i] -= fftGrid->getNextReal();
+      rvalue_[i] -= factor*fftGrid->getNextReal();
     }
   }
   fftGrid->endAccess();
@@ -537,6 +557,7 @@ FFTFileGrid::multiply(FFTGrid * fftGrid)
     }
   }
   fftGrid->endAccess();
+  scale_ *= fftGrid->getScale();
 
   if(accMode_ != RANDOMACCESS)
     save();
@@ -668,14 +689,9 @@ FFTFileGrid::load()
     FFTGrid::createComplexGrid();
   if(fNameIn_ != "") //Something has been saved.
   {
-    int nRead = 1;
-    NRLib::OpenRead(inFile_,fNameIn_,std::ios::in | std::ios::binary);
+    inFile_.openRead(fNameIn_, getSlabSize());
     //Real/complex does not matter in next line, since same meory is used.
-    for(size_t i=0;((i<rsize_) && (nRead == 1));i++)
-    {
-      char * buffer = reinterpret_cast<char *>(&(rvalue_[i]));
-      inFile_.read(buffer,sizeof(float));
-    }
+    inFile_.readAll(rvalue_, rsize_);
     inFile_.close();
   }
 }
@@ -684,14 +700,9 @@ void
 FFTFileGrid::save()
 {
   assert(accMode_ == NONE || accMode_ == RANDOMACCESS);
-  NRLib::OpenWrite(outFile_,fNameOut_,std::ios::out | std::ios::binary);
+  outFile_.openWrite(fNameOut_, getSlabSize());
   //Real/complex does not matter in next line, since same meory is used.
-  int nWritten = 1;
-  for(size_t i=0;((i<rsize_) && (nWritten == 1));i++)
-  {
-    char * buffer = reinterpret_cast<char *>(&(rvalue_[i]));
-    outFile_.write(buffer,sizeof(float));
-  }
+  outFile_.writeAll(rvalue_, rsize_);
   outFile_.close();
   unload();
   std::string tmp = fNameIn_;
@@ -706,6 +717,9 @@ void
 FFTFileGrid::unload()
 {
   fftw_free(rvalue_); // changed
+#ifdef PARALLEL
+#pragma omp critical(fft_grid_count)
+#endif
   nGrids_ = nGrids_ - 1;
 // LogKit::LogFormatted(LogKit::Error,"\nFFTFileGrid unload: nGrids_ = %d\n",nGrids_);
   rvalue_ = NULL;
@@ -717,10 +731,14 @@ FFTFileGrid::genFileName()
 {
   fNameIn_  = "";
   // Store tmp file in top directory.
-  std::string baseName = IO::PrefixTmpGrids() + NRLib::ToString(gNum);
+  int fileNum;
+#ifdef PARALLEL
+#pragma omp critical(fft_file_grid_name)
+#endif
+  fileNum = gNum++;
+  std::string baseName = IO::PrefixTmpGrids() + NRLib::ToString(fileNum);
   std::string fileName = IO::makeFullFileName(IO::PathToTmpFiles(), baseName);
   fNameOut_ = fileName;
-  gNum++;
 }
 
 void
@@ -9,6 +9,7 @@
 #include "fftw.h"
 
 #include "fftgrid.h"
+#include "gridswapfile.h"
 
 class Wavelet;
 class Simbox;
@@ -34,6 +35,7 @@ public:
   int          expTransf();
   int          logTransf();
   void         multiplyByScalar(float scalar);
+  void         applyDeferredScale();
   int          collapseAndAdd(float*);
   void         add(FFTGrid* fftGrid);
   void         addScalar(float scalar);
@@ -77,13 +79,14 @@ private:
   void         load();
   void         unload();
   void         save();
+  size_t       getSlabSize() const { return(static_cast<size_t>(rnxp_)*static_cast<size_t>(nyp_)) ;} // One padded xy-plane
 
   int          accMode_;
   int          modified_;   //Tells if grid is modified during RANDOMACCESS.
   std::string  fNameIn_; //Temporary names, switches whenever a write has occured.
   std::string  fNameOut_;
-  std::ifstream inFile_;
-  std::ofstream outFile_;
+  GridSwapFile inFile_;
+  GridSwapFile outFile_;
 
   static int   gNum; //Number used for generating temporary files.
 };
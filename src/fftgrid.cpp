@@ -29,6 +29,7 @@
 #include "nrlib/segy/segy.hpp"
 
 #include "src/fftgrid.h"
+#include "src/fftengine.h"
 #include "src/simbox.h"
 #include "src/timings.h"
 #include "src/definitions.h"
@@ -79,7 +80,7 @@ FFTGrid::FFTGrid(FFTGrid * fftGrid, bool expTrans)
   nxp_            = fftGrid->nxp_;
   nyp_            = fftGrid->nyp_;
   nzp_            = fftGrid->nzp_;
-  scale_          = fftGrid->scale_;
+  scale_          = 1.0;
   rValMin_        = fftGrid->rValMin_;
   rValMax_        = fftGrid->rValMax_;
   rValAvg_        = fftGrid->rValAvg_;
@@ -95,6 +96,9 @@ FFTGrid::FFTGrid(FFTGrid * fftGrid, bool expTrans)
   add_            = fftGrid->add_;
   istransformed_  = fftGrid->getIsTransformed();
 
+  // The copy is made from the stored values, so the source must hold no deferred scale.
+  fftGrid->applyDeferredScale();
+
   if(istransformed_ == false) {
     createRealGrid(add_);
     for(int k=0;k<nzp_;k++) {
@@ -308,13 +312,18 @@ FFTGrid::~FFTGrid()
 {
   if (rvalue_!=NULL)
   {
-    if(add_==true)
-      nGrids_ = nGrids_ - 1;
-
     fftw_free(rvalue_); //delete rvalue_;
 
-    FFTMemUse_ -= rsize_ * sizeof(fftw_real);
-    LogKit::LogFormatted(LogKit::DebugLow,"\nFFTGrid Destructor: nGrids_ = %d",nGrids_);
+    // Grids may be created and deleted by intervals inverted in parallel.
+#ifdef PARALLEL
+#pragma omp critical(fft_grid_count)
+#endif
+    {
+      if(add_==true)
+        nGrids_ = nGrids_ - 1;
+      FFTMemUse_ -= rsize_ * sizeof(fftw_real);
+      LogKit::LogFormatted(LogKit::DebugLow,"\nFFTGrid Destructor: nGrids_ = %d",nGrids_);
+    }
   }
 }
 
@@ -1049,8 +1058,12 @@ FFTGrid::createRealGrid(bool add)
 {
   istransformed_=false;
   add_ = add;
-  if(add==true)
+  if(add==true) {
+#ifdef PARALLEL
+#pragma omp critical(fft_grid_count)
+#endif
     nGrids_ += 1;
+  }
   createGrid();
 }
 
@@ -1058,6 +1071,9 @@ void
 FFTGrid::createComplexGrid()
 {
   istransformed_  = true;
+#ifdef PARALLEL
+#pragma omp critical(fft_grid_count)
+#endif
   nGrids_        += 1;
   createGrid();
 }
@@ -1071,32 +1087,34 @@ void FFTGrid::createGrid()
   counterForSet_  = 0;
 
  // LogKit::LogFormatted(LogKit::Error,"\nFFTGrid createGrid : nGrids = %d    maxGrids = %d\n",nGrids_,maxAllowedGrids_);
-  if (nGrids_ > maxAllowedGrids_) {
-    std::string text;
-    text += "\n\nERROR in FFTGrid createGrid. You have allocated too many FFTGrids. The fix";
-    text += "\nis to increase the nGrids variable calculated in Model::checkAvailableMemory().\n";
-    text += "\nDo you REALLY need to allocate more grids?\n";
-    text += "\nAre there no grids that can be released?\n";
-    if(terminateOnMaxGrid_==true)
-    {
-      LogKit::LogFormatted(LogKit::Error, text);
-      exit(1);
-    }
-    else if(nGrids_ == maxAllowedGrids_+1) {
-      //NBNB-PAL: Commented out until memory handling is fixed in 4.0 release
-      //TaskList::addTask("Crava needs more memory than expected. The results are still correct. \n Norwegian Computing Center would like to have a look at your project.");
+#ifdef PARALLEL
+#pragma omp critical(fft_grid_count)
+#endif
+  {
+    if (nGrids_ > maxAllowedGrids_) {
+      std::string text;
+      text += "\n\nERROR in FFTGrid createGrid. You have allocated too many FFTGrids. The fix";
+      text += "\nis to increase the nGrids variable calculated in Model::checkAvailableMemory().\n";
+      text += "\nDo you REALLY need to allocate more grids?\n";
+      text += "\nAre there no grids that can be released?\n";
+      if(terminateOnMaxGrid_==true)
+      {
+        LogKit::LogFormatted(LogKit::Error, text);
+        exit(1);
+      }
+      else if(nGrids_ == maxAllowedGrids_+1) {
+        //NBNB-PAL: Commented out until memory handling is fixed in 4.0 release
+        //TaskList::addTask("Crava needs more memory than expected. The results are still correct. \n Norwegian Computing Center would like to have a look at your project.");
+      }
     }
-  }
-  maxAllocatedGrids_ = std::max(nGrids_, maxAllocatedGrids_);
+    maxAllocatedGrids_ = std::max(nGrids_, maxAllocatedGrids_);
 
-  FFTMemUse_ += rsize_ * sizeof(fftw_real);
-  if(FFTMemUse_ > maxFFTMemUse_) {
-    maxFFTMemUse_ = FFTMemUse_;
-    LogKit::LogFormatted(LogKit::DebugLow,"\nNew FFT-grid memory peak (%2d): %10.2f MB\n",nGrids_, FFTMemUse_/(1024.f*1024.f));
+    FFTMemUse_ += rsize_ * sizeof(fftw_real);
+    if(FFTMemUse_ > maxFFTMemUse_) {
+      maxFFTMemUse_ = FFTMemUse_;
+      LogKit::LogFormatted(LogKit::DebugLow,"\nNew FFT-grid memory peak (%2d): %10.2f MB\n",nGrids_, FFTMemUse_/(1024.f*1024.f));
+    }
   }
-
-
-
 }
 
 int
@@ -1202,6 +1220,7 @@ FFTGrid::getDistToBoundary(int i, int n, int np )
 fftw_complex
 FFTGrid::getNextComplex()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(counterForGet_ < csize_);
   counterForGet_  +=  1;
@@ -1219,6 +1238,7 @@ FFTGrid::getNextComplex()
 float
 FFTGrid::getNextReal()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_ == false);
   assert(counterForGet_ < rsize_);
   counterForGet_  +=  1;
@@ -1236,6 +1256,7 @@ FFTGrid::getNextReal()
 float
 FFTGrid::getRealValue(int i, int j, int k, bool extSimbox) const
 {
+  assert(scale_ == 1.0f);
   // when index is in simbox (or the extended simbox if extSimbox is true) it returns the grid value
   // else it returns RMISSING
   // i index in x direction
@@ -1285,6 +1306,7 @@ FFTGrid::getRealTrace(int i, int j, bool add_padding) const
 float
 FFTGrid::getRealValueCyclic(int i, int j, int k) const
 {
+  assert(scale_ == 1.0f);
   float value;
   if(i<0)
     i = nxp_+i;
@@ -1334,6 +1356,7 @@ FFTGrid::getRealValueInterpolated(int i, int j, float kindex, bool extSimbox)
 fftw_complex
 FFTGrid::getComplexValue(int i, int j, int k, bool extSimbox) const
 {
+  assert(scale_ == 1.0f);
   // when index is in simbox (or the extended simbox if extSimbox is true) it returns the grid value
   // else it returns RMISSING
   // i index in x direction
@@ -1383,6 +1406,7 @@ FFTGrid::getFirstComplexValue()
 float
 FFTGrid::getFirstRealValue()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==false);
   float value = static_cast<float>(rvalue_[0]);
   return( value );
@@ -1391,6 +1415,7 @@ FFTGrid::getFirstRealValue()
 int
 FFTGrid::setNextComplex(fftw_complex value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(counterForSet_ < csize_);
   counterForSet_  +=  1;
@@ -1407,6 +1432,7 @@ FFTGrid::setNextComplex(fftw_complex value)
 int
 FFTGrid::SetNextComplex(std::complex<double> & value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==true);
   assert(counterForSet_ < csize_);
   counterForSet_ += 1;
@@ -1427,6 +1453,7 @@ FFTGrid::SetNextComplex(std::complex<double> & value)
 int
 FFTGrid::setNextReal(float value)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_== false);
   assert(counterForSet_ < rsize_);
   counterForSet_  +=  1;
@@ -1444,6 +1471,7 @@ FFTGrid::setNextReal(float value)
 int
 FFTGrid::setRealValue(int i, int j ,int k, float  value, bool extSimbox)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_== false);
 
   bool  inSimbox   = (extSimbox ? ( (i < rnxp_) && (j < nyp_) && (k < nzp_)) : ((i < nx_) && (j < ny_) && (k < nz_)));
@@ -1475,6 +1503,7 @@ int FFTGrid::setRealTrace(int i, int j, float *value)
 int
 FFTGrid::setComplexValue(int i, int j ,int k, fftw_complex value, bool extSimbox)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_== true);
 
   bool  inSimbox   = (extSimbox ? ( (i < nxp_) && (j < nyp_) && (k < nzp_)):
@@ -1494,6 +1523,7 @@ FFTGrid::setComplexValue(int i, int j ,int k, fftw_complex value, bool extSimbox
 int
 FFTGrid::square()
 {
+  assert(scale_ == 1.0f);
   if(istransformed_==true)
   {
     for(size_t i = 0;i < csize_; i++)
@@ -1532,6 +1562,7 @@ FFTGrid::square()
 int
 FFTGrid::expTransf()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==false);
   for(size_t i = 0;i < rsize_; i++)
   {
@@ -1551,6 +1582,7 @@ FFTGrid::expTransf()
 int
 FFTGrid::logTransf()
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==false);
   for(size_t i = 0;i < rsize_; i++)
   {
@@ -1570,6 +1602,7 @@ FFTGrid::logTransf()
 int
 FFTGrid::collapseAndAdd(float * grid)
 {
+  assert(scale_ == 1.0f);
   assert(istransformed_==false);
   int   i,j;
   float value;
@@ -1597,15 +1630,13 @@ FFTGrid::fftInPlace()
   assert(istransformed_==false);
   assert(cubetype_!= CTMISSING);
 
+  // The normalisation and any deferred scale are applied in the plane pass of the transform.
+  float scale = scale_;
   if( cubetype_!= COVARIANCE )
-    FFTGrid::multiplyByScalar(1.0f/sqrt(static_cast<float>(static_cast<size_t>(nxp_)*static_cast<size_t>(nyp_)*static_cast<size_t>(nzp_))));
+    scale *= 1.0f/sqrt(static_cast<float>(static_cast<size_t>(nxp_)*static_cast<size_t>(nyp_)*static_cast<size_t>(nzp_)));
 
-  int flag;
-  rfftwnd_plan plan;
-  flag = FFTW_ESTIMATE | FFTW_IN_PLACE;
-  plan= rfftw3d_create_plan(nzp_,nyp_,nxp_,FFTW_REAL_TO_COMPLEX,flag);
-  rfftwnd_one_real_to_complex(plan,rvalue_,cvalue_);
-  fftwnd_destroy_plan(plan);
+  FFTEngine::realToComplex3D(rvalue_,nxp_,nyp_,nzp_,scale);
+  scale_=1.0;
   istransformed_=true;
   time(&timeend);
   LogKit::LogFormatted(LogKit::DebugLow,"\nFFT of grid type %d finished after %ld seconds \n",cubetype_, timeend-timestart);
@@ -1626,20 +1657,15 @@ FFTGrid::invFFTInPlace()
   assert(cubetype_!= CTMISSING);
 
   float scale;
-  int flag;
-  rfftwnd_plan plan;
   if(cubetype_==COVARIANCE)
     scale=float( 1.0/(static_cast<size_t>(nxp_)*static_cast<size_t>(nyp_)*static_cast<size_t>(nzp_)));
   else
     scale=float( 1.0/sqrt(float(static_cast<size_t>(nxp_)*static_cast<size_t>(nyp_)*static_cast<size_t>(nzp_))));
 
-  flag = FFTW_ESTIMATE | FFTW_IN_PLACE;
-  plan= rfftw3d_create_plan(nzp_,nyp_,nxp_,FFTW_COMPLEX_TO_REAL,flag);
-  rfftwnd_one_complex_to_real(plan,cvalue_,rvalue_);
-  fftwnd_destroy_plan(plan);
+  FFTEngine::complexToReal3D(cvalue_,nxp_,nyp_,nzp_,scale*scale_);
+  scale_=1.0;
   istransformed_=false;
 
-  FFTGrid::multiplyByScalar(scale);
   time(&timeend);
   LogKit::LogFormatted(LogKit::DebugLow,"\nInverse FFT of grid type %d finished after %ld seconds \n",cubetype_, timeend-timestart);
 }
@@ -1653,18 +1679,21 @@ FFTGrid::realAbs()
     cvalue_[i].re = float (  sqrt( cvalue_[i].re * cvalue_[i].re ) );
     cvalue_[i].im = 0.0;
   }
+  scale_ = fabs(scale_);
 }
 
 void
 FFTGrid::add(FFTGrid* fftGrid)
 {
   assert(nxp_==fftGrid->getNxp());
+  // Any difference in deferred scale is folded into the addition.
+  float factor = fftGrid->scale_/scale_;
   if(istransformed_==true)
   {
     for(size_t i=0;i<csize_;i++)
     {
-      cvalue_[i].re += fftGrid->cvalue_[i].re;
-      cvalue_[i].im += fftGrid->cvalue_[i].im;
+      cvalue_[i].re += factor*fftGrid->cvalue_[i].re;
+      cvalue_[i].im += factor*fftGrid->cvalue_[i].im;
     }
   }
 
@@ -1672,7 +1701,7 @@ FFTGrid::add(FFTGrid* fftGrid)
   {
     for(size_t i=0;i < rsize_;i++)
     {
-      rvalue_[i] += fftGrid->rvalue_[i];
+      rvalue_[i] += factor*fftGrid->rvalue_[i];
     }
   }
 }
@@ -1682,9 +1711,10 @@ FFTGrid::addScalar(float scalar)
 {
   // Only addition of scalar in real domain
   assert(istransformed_==false);
+  float value = scalar/scale_;
   for(size_t i=0;i < rsize_;i++)
   {
-    rvalue_[i] += scalar;
+    rvalue_[i] += value;
   }
 }
 
@@ -1692,12 +1722,14 @@ void
 FFTGrid::subtract(FFTGrid* fftGrid)
 {
   assert(nxp_==fftGrid->getNxp());
+  // Any difference in deferred scale is folded into the subtraction.
+  float factor = fftGrid->scale_/scale_;
   if(istransformed_==true)
   {
     for(size_t i=0;i<csize_;i++)
     {
-      cvalue_[i].re -= fftGrid->cvalue_[i].re;
-      cvalue_[i].im -= fftGrid->cvalue_[i].im;
+      cvalue_[i].re -= factor*fftGrid->cvalue_[i].re;
+      cvalue_[i].im -= factor*fftGrid->cvalue_[i].im;
     }
   }
 
@@ -1705,7 +1737,7 @@ FFTGrid::subtract(FFTGrid* fftGrid)
   {
     for(size_t i=0;i < rsize_;i++)
     {
-      rvalue_[i] -= fftGrid->rvalue_[i];
+      rvalue_[i] -= factor*fftGrid->rvalue_[i];
     }
   }
 }
@@ -1750,6 +1782,7 @@ FFTGrid::multiply(FFTGrid* fftGrid)
       rvalue_[i] *= fftGrid->rvalue_[i];
     }
   }
+  scale_ *= fftGrid->scale_;
 }
 
 void
@@ -1766,9 +1799,25 @@ void
 FFTGrid::multiplyByScalar(float scalar)
 {
   assert(istransformed_==false);
+  float value = scalar*scale_;
   for(size_t i=0;i<rsize_;i++)
   {
-    rvalue_[i]*=scalar;
+    rvalue_[i]*=value;
+  }
+  scale_ = 1.0;
+}
+
+void
+FFTGrid::applyDeferredScale()
+{
+  if(scale_ != 1.0f)
+  {
+    // Real and complex values share storage, so this covers both domains.
+    for(size_t i=0;i<rsize_;i++)
+    {
+      rvalue_[i]*=scale_;
+    }
+    scale_ = 1.0;
   }
 }
 
@@ -1785,8 +1834,14 @@ FFTGrid::fft1DzInPlace(fftw_real*  in, int nzp)
   out = reinterpret_cast<fftw_complex*>(in);
 
   flag    = FFTW_ESTIMATE | FFTW_IN_PLACE;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   plan    = rfftwnd_create_plan(1, &nzp ,FFTW_REAL_TO_COMPLEX,flag);
   rfftwnd_one_real_to_complex(plan,in ,out);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   fftwnd_destroy_plan(plan);
 
   return out;
@@ -1804,8 +1859,14 @@ FFTGrid::invFFT1DzInPlace(fftw_complex* in, int nzp)
   out = reinterpret_cast<fftw_real*>(in);
 
   flag = FFTW_ESTIMATE | FFTW_IN_PLACE;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   plan= rfftwnd_create_plan(1,&nzp,FFTW_COMPLEX_TO_REAL,flag);
   rfftwnd_one_complex_to_real(plan,in,out);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
   fftwnd_destroy_plan(plan);
   return out;
 }
@@ -1893,6 +1954,7 @@ FFTGrid::writeStormFile(const std::string & fileName,
                         bool                flat,
                         bool                scientific_format)
 {
+  assert(scale_ == 1.0f);
   int nx, ny, nz;
   if(padding == true)
   {
@@ -1956,6 +2018,93 @@ FFTGrid::writeStormFile(const std::string & fileName,
 }
 
 
+// Trace t is the t'th column of the simbox with a defined top, regularly resampled in z.
+// Columns where the top is missing get no trace.
+class FFTGrid::SegyTraceSource : public NRLib::SegY::TraceSource
+{
+public:
+  SegyTraceSource(const FFTGrid * grid,
+                  const Simbox  * simbox,
+                  float           z0,
+                  float           dz,
+                  int             segynz)
+    : grid_(grid),
+      simbox_(simbox),
+      z0_(z0),
+      dz_(dz),
+      segynz_(segynz),
+      maxEndData_(segynz)
+  {
+    double x,y,z;
+    for(int j=0;j<simbox_->getny();j++) {
+      for(int i=0;i<simbox_->getnx();i++) {
+        simbox_->getCoord(i, j, 0, x, y, z);
+        z = simbox_->getTop(x,y);
+        if(z != RMISSING && z != WELLMISSING)
+          columns_.push_back(i + j*simbox_->getnx());
+      }
+    }
+  }
+
+  // Largest number of samples a trace needed. Larger than segynz if data were truncated.
+  int getMaxEndData() const
+  {
+    return maxEndData_;
+  }
+
+  size_t GetNTraces() const
+  {
+    return columns_.size();
+  }
+
+  void GetPosition(size_t t, double & x, double & y) const
+  {
+    double z;
+    simbox_->getCoord(columns_[t] % simbox_->getnx(), columns_[t] / simbox_->getnx(), 0, x, y, z);
+    x = static_cast<float>(x);
+    y = static_cast<float>(y);
+  }
+
+  void GetTrace(size_t t, std::vector<float> & trace) const
+  {
+    int i = columns_[t] % simbox_->getnx();
+    int j = columns_[t] / simbox_->getnx();
+    int k;
+    double x,y,z;
+    simbox_->getCoord(i, j, 0, x, y, z);
+    z = simbox_->getTop(x,y);
+
+    double gdz       = simbox_->getdz()*simbox_->getRelThick(i,j);
+    int    firstData = static_cast<int>(floor(0.5+(z-z0_)/dz_));
+    int    endData   = static_cast<int>(floor(0.5+((z-z0_)+grid_->nz_*gdz)/dz_));
+
+    if(endData > segynz_)
+    {
+      // Traces are made on several threads, so this is reported once in writeSegyFile.
+#ifdef PARALLEL
+#pragma omp critical(fftgrid_segy_trace_truncation)
+#endif
+      maxEndData_ = std::max(maxEndData_, endData);
+      endData = segynz_;
+    }
+    for(k=0;k<firstData;k++)
+      trace[k] = 0;
+    for(;k<endData;k++)
+      trace[k] = grid_->getRegularZInterpolatedRealValue(i,j,z0_,dz_,k,z,gdz);
+    for(;k<segynz_;k++)
+      trace[k] = 0;
+  }
+
+private:
+  const FFTGrid * grid_;
+  const Simbox  * simbox_;
+  float           z0_;
+  float           dz_;
+  int             segynz_;
+  mutable int     maxEndData_;
+  std::vector<int> columns_;   // i + j*nx of the columns with a defined top
+};
+
 int
 FFTGrid::writeSegyFile(const std::string              & fileName,
                        const Simbox                   * simbox,
@@ -1963,6 +2112,7 @@ FFTGrid::writeSegyFile(const std::string              & fileName,
                        const TraceHeaderFormat        & thf,
                        const std::vector<std::string> & headerText)
 {
+  assert(scale_ == 1.0f);
   //  long int timestart, timeend;
   //  time(&timestart);
 
@@ -1994,56 +2144,16 @@ FFTGrid::writeSegyFile(const std::string              & fileName,
   delete geometry; //Call above takes a copy.
   LogKit::LogFormatted(LogKit::Low,"\nWriting SEGY file "+gfName+"...");
 
-  int i,j,k;
-  double x,y,z;
-  std::vector<float> trace(segynz);//Maximum amount of data needed.
-
-  for(j=0;j<simbox->getny();j++)
-  {
-    for(i=0;i<simbox->getnx();i++)
-    {
-      simbox->getCoord(i, j, 0, x, y, z);
-      z = simbox->getTop(x,y);
-
-      if(z == RMISSING || z == WELLMISSING)
-      {
-        //printf("Missing trace.\n");
-        for(k=0;k<segynz;k++)
-          trace[k] = 0;
-      }
-      else
-      {
-        double gdz       = simbox->getdz()*simbox->getRelThick(i,j);
-        int    firstData = static_cast<int>(floor(0.5+(z-z0)/dz));
-        int    endData   = static_cast<int>(floor(0.5+((z-z0)+nz_*gdz)/dz));
-
-        if(endData > segynz)
-        {
-          printf("Internal warning: SEGY-grid too small (%d, %d needed). Truncating data.\n", nz_, endData);
-          endData = segynz;
-        }
-        for(k=0;k<firstData;k++)
-          trace[k] = 0;
-//          trace[k] = -1e35; //NBNB-Frode: Norsar-hack
-        for(;k<endData;k++) {
-          trace[k] = this->getRegularZInterpolatedRealValue(i,j,z0,dz,k,z,gdz);
-
-        }
-        for(;k<segynz;k++)
-          trace[k] = 0;
-//          trace[k] = -1e35; //NBNB-Frode: Norsar-hack
-        float xx = static_cast<float>(x);
-        float yy = static_cast<float>(y);
-        segy->StoreTrace(xx, yy, trace, NULL);
-      }
-    }
-  }
-
-  segy->WriteAllTracesToFile();
+  SegyTraceSource source(this, simbox, z0, dz, segynz);
+  segy->WriteTraces(source, 1, 0, nThreads_);
 
   delete segy; //Closes file.
   // delete [] value;
   LogKit::LogFormatted(LogKit::Low,"done\n");
+
+  if(source.getMaxEndData() > segynz)
+    LogKit::LogFormatted(LogKit::Warning,"\nInternal warning: SEGY-grid too small (%d, %d needed). Data have been truncated.\n",
+                         segynz, source.getMaxEndData());
   //  time(&timeend);
   //printf("\n Write SEGY was performed in %ld seconds.\n",timeend-timestart);
   return(0);
@@ -2056,6 +2166,7 @@ FFTGrid::writeResampledStormCube(const GridMapping * gridmapping,
                                  const Simbox      * simbox,
                                  const int           format)
 {
+  assert(scale_ == 1.0f);
   // simbox is related to the cube we resample from. gridmapping contains simbox for the cube we resample to.
 
   float time, kindex;
@@ -2107,6 +2218,7 @@ FFTGrid::writeResampledStormCube(const GridMapping * gridmapping,
 int
 FFTGrid::writeSgriFile(const std::string & fileName, const Simbox *simbox, const std::string label)
 {
+  assert(scale_ == 1.0f);
   double vertScale = 0.001;
   double horScale  = 0.001;
   std::string fName = fileName + IO::SuffixSgriHeader();
@@ -2182,13 +2294,14 @@ FFTGrid::writeSgriFile(const std::string & fileName, const Simbox *simbox, const
 void
 FFTGrid::writeCravaFile(const std::string & fileName, const Simbox * simbox)
 {
+  assert(scale_ == 1.0f);
   try {
     LogKit::LogFormatted(LogKit::Low," Writing CRAVA file "+fileName+IO::SuffixCrava()+"...");
     std::ofstream binFile;
     std::string fName = fileName + IO::SuffixCrava();
     NRLib::OpenWrite(binFile, fName, std::ios::out | std::ios::binary);
 
-    std::string fileType = "crava_fftgrid_binary";
+    std::string fileType = "crava_fftgrid_binary_v2";
     binFile << fileType << "\n";
 
     NRLib::WriteBinaryDouble(binFile, simbox->getx0());
@@ -2207,8 +2320,15 @@ FFTGrid::writeCravaFile(const std::string & fileName, const Simbox * simbox)
     NRLib::WriteBinaryInt(binFile, rnxp_);
     NRLib::WriteBinaryInt(binFile, nyp_);
     NRLib::WriteBinaryInt(binFile, nzp_);
-    for(size_t i=0;i<rsize_;i++)
-      NRLib::WriteBinaryFloat(binFile, rvalue_[i]);
+
+    //The values start at a page aligned offset, and are stored little endian in the same
+    //order as rvalue_. On most machines the value block is then an image of the grid in
+    //memory, which is written and read in one go, and which may be mapped directly.
+    const int dataOffset = 4096;
+    NRLib::WriteBinaryInt(binFile, dataOffset);
+    std::vector<char> headerPadding(dataOffset - static_cast<int>(binFile.tellp()), 0);
+    binFile.write(&headerPadding[0], headerPadding.size());
+    NRLib::WriteBinaryFloatBuffer(binFile, rvalue_, rsize_, NRLib::END_LITTLE_ENDIAN);
 
     binFile.close();
     LogKit::LogFormatted(LogKit::Low,"done.\n");
@@ -2258,9 +2378,17 @@ FFTGrid::readCravaFile(const std::string & fileName, std::string & errText, bool
       throw(NRLib::Exception("Grid dimension is wrong for file '"+fileName+"'."));
     }
     createRealGrid(!nopadding);
-    add_ = !nopadding;
-    for(size_t i=0;i<rsize_;i++)
-      rvalue_[i] = NRLib::ReadBinaryFloat(binFile);
+    add_   = !nopadding;
+    scale_ = 1.0;
+    if (fileType == "crava_fftgrid_binary_v2") {
+      int dataOffset = NRLib::ReadBinaryInt(binFile);
+      binFile.seekg(dataOffset);
+      NRLib::ReadBinaryFloatBuffer(binFile, rvalue_, rsize_, NRLib::END_LITTLE_ENDIAN);
+    }
+    else {
+      for(size_t i=0;i<rsize_;i++)
+        rvalue_[i] = NRLib::ReadBinaryFloat(binFile);
+    }
 
     binFile.close();
   }
@@ -2274,7 +2402,7 @@ FFTGrid::readCravaFile(const std::string & fileName, std::string & errText, bool
 float
 FFTGrid::getRegularZInterpolatedRealValue(int i, int j, double z0Reg,
                                           double dzReg, int kReg,
-                                          double z0Grid, double dzGrid)
+                                          double z0Grid, double dzGrid) const
 {
   float z     = static_cast<float> (z0Reg+dzReg*kReg);
   float t     = static_cast<float> ((z-z0Grid)/dzGrid);
@@ -2548,69 +2676,18 @@ FFTGrid::checkNaN()
 
 void FFTGrid::writeSegyFromStorm(Simbox * simbox, StormContGrid *data, std::string fileName)
 {
-  int i,k,j;
-  TextualHeader header = TextualHeader::standardHeader();
-  int nx = static_cast<int>(data->GetNI());
-  int ny = static_cast<int>(data->GetNJ());
-
   SegyGeometry geometry (simbox->getx0(), simbox->gety0(), simbox->getdx(), simbox->getdy(),
                          simbox->getnx(), simbox->getny(),simbox->getIL0(), simbox->getXL0(),
                          simbox->getILStepX(), simbox->getILStepY(),
                          simbox->getXLStepX(), simbox->getXLStepY(),
                          simbox->getAngle());
 
-  //  SegyGeometry geometry(data->GetXMin(),data->GetYMin(),data->GetDX(),data->GetDY(),
-  //                      nx,ny,data->GetAngle());
-
-
   float dz = float(floor((data->GetLZ()/data->GetNK())));
-  //int nz = int(data->GetZMax()/dz);
-  //float z0 = float(data->GetZMin());
-  float z0 = 0.0;
   int nz = int(ceil((data->GetZMax())/dz));
-  SegY segyout(fileName,0,nz,dz,header);
-  segyout.SetGeometry(&geometry);
-
-  std::vector<float> datavec;
-  datavec.resize(nz);
-  float x, y, xt, yt, z;
-  for(j=0;j<ny;j++)
-    for(i=0;i<nx;i++)
-    {
-      xt = float((i+0.5)*geometry.GetDx());
-      yt = float((j+0.5)*geometry.GetDy());
-      x = float(geometry.GetX0()+xt*geometry.GetCosRot()-yt*geometry.GetSinRot());
-      y = float(geometry.GetY0()+yt*geometry.GetCosRot()+xt*geometry.GetSinRot());
-
-      double zbot= data->GetBotSurface().GetZ(x,y);
-      double ztop = data->GetTopSurface().GetZ(x,y);
-      int    firstData = static_cast<int>(floor((ztop)/dz));
-      int    endData   = static_cast<int>(floor((zbot)/dz));
-
-      if(endData > nz)
-      {
-        printf("Internal warning: SEGY-grid too small (%d, %d needed). Truncating data.\n", nz, endData);
-        endData = nz;
-      }
-      for(k=0;k<firstData;k++)
-      {
-        datavec[k] = 0.0;
-      }
-
-      for(k=firstData;k<endData;k++)
-      {
-         z = z0+k*dz;
-        datavec[k] = float(data->GetValueZInterpolated(x,y,z));
-      }
-      for(k=endData;k<nz;k++)
-      {
-        datavec[k] = 0.0;
-      }
-      segyout.StoreTrace(x,y,datavec,NULL);
-    }
-
-  segyout.WriteAllTracesToFile();
 
+  // Samples are taken at z = k*dz, as for seismic data.
+  SegY segyout(data, &geometry, 0.0f, dz, nz, fileName, true,
+               TraceHeaderFormat(TraceHeaderFormat::SEISWORKS), true, 0, nThreads_);
 }
 
 void FFTGrid::makeDepthCubeForSegy(Simbox *simbox,const std::string & fileName)
@@ -2664,5 +2741,6 @@ int FFTGrid::maxAllowedGrids_   = 1;   // One grid is allocated and deallocated
 int FFTGrid::maxAllocatedGrids_ = 0;
 int FFTGrid::nGrids_            = 0;
 bool FFTGrid::terminateOnMaxGrid_ = false;
+int FFTGrid::nThreads_          = 1;
 float FFTGrid::maxFFTMemUse_    = 0;
 float FFTGrid::FFTMemUse_       = 0;
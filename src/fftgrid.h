@@ -112,6 +112,8 @@ public:
   fftw_complex         getComplexValue(int i, int j, int k, bool extSimbox = false) const;
   virtual int          setRealValue(int i, int j, int k, float value, bool extSimbox = false);  // Accessmode randomaccess
   int                  setComplexValue(int i, int j ,int k, fftw_complex value, bool extSimbox = false);
+  fftw_complex         getComplexValue(size_t index) const {return(cvalue_[index]);}                    // Direct access in complex grid, in-memory only
+  void                 setComplexValue(size_t index, fftw_complex value) {cvalue_[index] = value;}     // Direct access in complex grid, in-memory only
   fftw_complex         getFirstComplexValue();
   float                getFirstRealValue();                     // No mode/randomaccess
   virtual int          square();                                // No mode/randomaccess
@@ -156,6 +158,8 @@ public:
   enum                 accessMode{NONE, READ, WRITE, READANDWRITE, RANDOMACCESS};
 
   virtual void         multiplyByScalar(float scalar);      //No mode/randomaccess
+  void                 deferScale(float scalar) {scale_ *= scalar;}  // Scale is applied by the next transform or multiplyByScalar
+  virtual void         applyDeferredScale();                // No mode/randomaccess. Needed before values are read or written directly
   int                  getType() const {return(cubetype_);}
   virtual void         setAccessMode(int mode){assert(mode>=0);}
   virtual void         endAccess(){counterForGet_ = 0; counterForSet_ = 0;}
@@ -194,6 +198,7 @@ public:
   static int           getMaxAllowedGrids()   { return maxAllowedGrids_   ;}
   static int           getMaxAllocatedGrids() { return maxAllocatedGrids_ ;}
   static void          setTerminateOnMaxGrid(bool terminate) {terminateOnMaxGrid_ = terminate ;}
+  static void          setNumberOfThreads(int nThreads) {nThreads_ = nThreads ;}
   static int           findClosestFactorableNumber(int leastint);
 
   static fftw_complex* fft1DzInPlace(fftw_real*  in, int nzp);
@@ -232,7 +237,9 @@ protected:
   //Interpolation into SegY and sgri
   float                getRegularZInterpolatedRealValue(int i, int j, double z0Reg,
                                                          double dzReg, int kReg,
-                                                         double z0Grid, double dzGrid);
+                                                         double z0Grid, double dzGrid) const;
+
+  class SegyTraceSource;                   // Traces of the grid for writeSegyFile
 
   //Supporting functions for interpolateSeismic
   int                  interpolateTrace(int index, short int * flags, int i, int j);
@@ -244,7 +251,7 @@ protected:
 
   int                  cubetype_;          // see enum gridtypes above
   float                theta_;             // angle in angle gather (case of data)
-  float                scale_;             // To keep track of the scalings after fourier transforms
+  float                scale_;             // Deferred scale factor. The grid values are the stored values times scale_. Direct accessors assert it is 1
 
   int                  nx_;                // size of original grid in lateral x direction
   int                  ny_;                // size of original grid in lateral y direction
@@ -277,6 +284,7 @@ protected:
   static int           maxAllocatedGrids_; // The maximum number of grids that has actually been allocated.
   static int           nGrids_;            // The actually number of grids allocated (varies as crava runs).
   static bool          terminateOnMaxGrid_; // If true, terminate when we try to allocate more than maxAllowedGrids.
+  static int           nThreads_;          // Number of threads used when writing SegY files.
   bool                 add_;                // Tells whether we should change nGrids_ or not
 
   static float         maxFFTMemUse_;
@@ -0,0 +1,388 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <math.h>
+#include <string.h>
+
+#include "nrlib/exception/exception.hpp"
+#include "nrlib/iotools/fileio.hpp"
+
+#include "src/gridswapfile.h"
+
+GridSwapFile::GridSwapFile()
+  : slabSize_(0),
+    nBuffer_(0),
+    pos_(0)
+{
+#ifdef PARALLEL
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&cond_, NULL);
+  running_   = false;
+  failed_    = false;
+  job_       = IDLE;
+  nIoBuffer_ = 0;
+#endif
+}
+
+GridSwapFile::~GridSwapFile()
+{
+  close();
+#ifdef PARALLEL
+  pthread_cond_destroy(&cond_);
+  pthread_mutex_destroy(&mutex_);
+#endif
+}
+
+void
+GridSwapFile::openRead(const std::string & fileName, size_t slabSize)
+{
+  assert(slabSize > 0);
+  NRLib::OpenRead(inFile_, fileName, std::ios::in | std::ios::binary);
+  slabSize_ = slabSize;
+  buffer_.resize(slabSize_);
+  nBuffer_  = 0;
+  pos_      = 0;
+#ifdef PARALLEL
+  startWorker(READ); // First slab is read at once
+#endif
+}
+
+void
+GridSwapFile::openWrite(const std::string & fileName, size_t slabSize)
+{
+  assert(slabSize > 0);
+  NRLib::OpenWrite(outFile_, fileName, std::ios::out | std::ios::binary);
+  slabSize_ = slabSize;
+  buffer_.resize(slabSize_);
+  nBuffer_  = 0;
+  pos_      = 0;
+#ifdef PARALLEL
+  startWorker(IDLE);
+#endif
+}
+
+void
+GridSwapFile::close()
+{
+  if (outFile_.is_open() && pos_ > 0)
+    flushBuffer();
+
+#ifdef PARALLEL
+  if (running_) {
+    waitForWorker();
+    postJob(STOP);
+    pthread_join(worker_, NULL);
+    running_ = false;
+    std::vector<float>().swap(ioBuffer_);
+    nIoBuffer_ = 0;
+  }
+#endif
+
+  if (outFile_.is_open())
+    outFile_.close();
+  if (inFile_.is_open())
+    inFile_.close();
+
+  std::vector<float>().swap(buffer_);
+  std::vector<unsigned char>().swap(packed_);
+  nBuffer_  = 0;
+  pos_      = 0;
+}
+
+void
+GridSwapFile::readAll(float * values, size_t n)
+{
+  assert(inFile_.is_open() && pos_ == nBuffer_);
+  for (size_t i = 0; i < n; i += slabSize_) {
+    size_t nSlab = std::min(slabSize_, n - i);
+    size_t nRead = std::min(receiveSlab(), nSlab);
+    memcpy(values + i, &buffer_[0], nRead*sizeof(float));
+    if (nRead < nSlab)
+      break;
+  }
+  nBuffer_ = 0;
+  pos_     = 0;
+}
+
+void
+GridSwapFile::writeAll(const float * values, size_t n)
+{
+  assert(outFile_.is_open() && pos_ == 0);
+  for (size_t i = 0; i < n; i += slabSize_) {
+    size_t nSlab = std::min(slabSize_, n - i);
+    memcpy(&buffer_[0], values + i, nSlab*sizeof(float));
+    sendSlab(nSlab);
+  }
+}
+
+void
+GridSwapFile::fillBuffer()
+{
+  nBuffer_ = receiveSlab();
+  pos_     = 0;
+  assert(nBuffer_ > 0); // Reading past end of file
+}
+
+void
+GridSwapFile::flushBuffer()
+{
+  sendSlab(pos_);
+  pos_ = 0;
+}
+
+size_t
+GridSwapFile::receiveSlab()
+{
+#ifdef PARALLEL
+  // Take the slab the worker has read, and let it read the next one.
+  waitForWorker();
+  if (failed_)
+    throw NRLib::IOError("Could not read grid swap file.");
+  buffer_.swap(ioBuffer_);
+  size_t n = nIoBuffer_;
+  if (n > 0)
+    postJob(READ);
+  return(n);
+#else
+  return(readSlab(&buffer_[0], slabSize_));
+#endif
+}
+
+void
+GridSwapFile::sendSlab(size_t n)
+{
+#ifdef PARALLEL
+  // Hand the slab to the worker once it has written the previous one.
+  waitForWorker();
+  if (failed_)
+    throw NRLib::IOError("Could not write grid swap file.");
+  buffer_.swap(ioBuffer_);
+  buffer_.resize(slabSize_);
+  nIoBuffer_ = n;
+  postJob(WRITE);
+#else
+  writeSlab(&buffer_[0], n);
+#endif
+}
+
+size_t
+GridSwapFile::readSlab(float * values, size_t n)
+{
+  if (!compress_) {
+    inFile_.read(reinterpret_cast<char *>(values), n*sizeof(float));
+    return(static_cast<size_t>(inFile_.gcount())/sizeof(float));
+  }
+
+  unsigned int header[2]; // Number of values and number of bytes
+  inFile_.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (inFile_.gcount() != sizeof(header))
+    return(0);
+  assert(header[0] <= n);
+
+  packed_.resize(header[1]);
+  inFile_.read(reinterpret_cast<char *>(&packed_[0]), header[1]);
+  decodeSlab(&packed_[0], header[0], values);
+  return(header[0]);
+}
+
+void
+GridSwapFile::writeSlab(const float * values, size_t n)
+{
+  if (!compress_) {
+    outFile_.write(reinterpret_cast<const char *>(values), n*sizeof(float));
+    return;
+  }
+
+  packed_.resize(1 + sizeof(float) + (n + 3)/4 + n*sizeof(float));
+  unsigned int header[2];
+  header[0] = static_cast<unsigned int>(n);
+  header[1] = static_cast<unsigned int>(encodeSlab(values, n, &packed_[0]));
+  outFile_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  outFile_.write(reinterpret_cast<const char *>(&packed_[0]), header[1]);
+}
+
+#ifdef PARALLEL
+void
+GridSwapFile::startWorker(int job)
+{
+  assert(running_ == false);
+  ioBuffer_.resize(slabSize_);
+  nIoBuffer_ = 0;
+  failed_    = false;
+  job_       = job;
+  if (pthread_create(&worker_, NULL, runWorker, this) != 0)
+    throw NRLib::Exception("Could not start I/O thread for grid swap file.");
+  running_   = true;
+}
+
+void
+GridSwapFile::waitForWorker()
+{
+  pthread_mutex_lock(&mutex_);
+  while (job_ != IDLE)
+    pthread_cond_wait(&cond_, &mutex_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void
+GridSwapFile::postJob(int job)
+{
+  pthread_mutex_lock(&mutex_);
+  job_ = job;
+  pthread_cond_broadcast(&cond_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void *
+GridSwapFile::runWorker(void * file)
+{
+  // The caller only touches ioBuffer_ and nIoBuffer_ while the job is IDLE.
+  GridSwapFile * swapFile = static_cast<GridSwapFile *>(file);
+  for (;;) {
+    pthread_mutex_lock(&swapFile->mutex_);
+    while (swapFile->job_ == IDLE)
+      pthread_cond_wait(&swapFile->cond_, &swapFile->mutex_);
+    int job = swapFile->job_;
+    pthread_mutex_unlock(&swapFile->mutex_);
+
+    if (job == STOP)
+      break;
+
+    try {
+      if (job == READ)
+        swapFile->nIoBuffer_ = swapFile->readSlab(&swapFile->ioBuffer_[0], swapFile->slabSize_);
+      else
+        swapFile->writeSlab(&swapFile->ioBuffer_[0], swapFile->nIoBuffer_);
+    }
+    catch (std::exception &) {
+      swapFile->nIoBuffer_ = 0;
+      swapFile->failed_    = true;
+    }
+
+    swapFile->postJob(IDLE);
+  }
+  return(NULL);
+}
+#endif
+
+size_t
+GridSwapFile::encodeSlab(const float * values, size_t n, unsigned char * packed)
+{
+  // Each value is turned into a 32 bit word that is small when the grid is
+  // smooth. The number of significant bytes in the word is stored as a 2 bit
+  // tag, followed by the significant bytes themselves.
+  //
+  // LOSSLESS : Word is the bit pattern of the value XOR-ed with the previous one.
+  // QUANTISED: Value is rounded to a multiple of step. Word is the zigzag coded
+  //            difference from the previous multiple.
+  static const size_t losslessBytes[4]  = {0, 2, 3, 4};
+  static const size_t quantisedBytes[4] = {0, 1, 2, 4};
+
+  // A slab holding a non-finite value is stored losslessly, so that NaN and
+  // infinity are kept exact. The relative step is bounded below so that the
+  // multiples of step always fit in an int.
+  static const float minRelStep = 1.0f/static_cast<float>(1 << 30);
+
+  float step = 0.0f;
+  if (maxRelError_ > 0.0f) {
+    float maxAbs = 0.0f;
+    bool  finite = true;
+    for (size_t i = 0; i < n && finite; i++) {
+      finite = std::isfinite(values[i]);
+      maxAbs = std::max(maxAbs, static_cast<float>(fabs(values[i])));
+    }
+    if (finite && maxAbs > 0.0f && maxAbs < 1.0e30f)
+      step = std::max(2.0f*maxRelError_, minRelStep)*maxAbs;
+  }
+
+  unsigned char * tags = packed + 1;
+  unsigned char * data;
+  const size_t  * nBytes;
+  if (step > 0.0f) {
+    packed[0] = QUANTISED;
+    memcpy(packed + 1, &step, sizeof(float));
+    tags   += sizeof(float);
+    nBytes  = quantisedBytes;
+  }
+  else {
+    packed[0] = LOSSLESS;
+    nBytes  = losslessBytes;
+  }
+  data = tags + (n + 3)/4;
+  memset(tags, 0, (n + 3)/4);
+
+  unsigned int prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    unsigned int word;
+    if (step > 0.0f) {
+      unsigned int q = static_cast<unsigned int>(static_cast<int>(floor(values[i]/step + 0.5f)));
+      int          d = static_cast<int>(q - prev);
+      word = (static_cast<unsigned int>(d) << 1) ^ static_cast<unsigned int>(d >> 31);
+      prev = q;
+    }
+    else {
+      unsigned int bits;
+      memcpy(&bits, &values[i], sizeof(float));
+      word = bits ^ prev;
+      prev = bits;
+    }
+
+    unsigned int tag = 3;
+    while (tag > 0 && (word >> (8*nBytes[tag - 1])) == 0)
+      tag--;
+    tags[i/4] |= static_cast<unsigned char>(tag << (2*(i%4)));
+    for (size_t b = 0; b < nBytes[tag]; b++)
+      *data++ = static_cast<unsigned char>(word >> (8*b));
+  }
+
+  return(static_cast<size_t>(data - packed));
+}
+
+void
+GridSwapFile::decodeSlab(const unsigned char * packed, size_t n, float * values)
+{
+  static const size_t losslessBytes[4]  = {0, 2, 3, 4};
+  static const size_t quantisedBytes[4] = {0, 1, 2, 4};
+
+  const unsigned char * tags = packed + 1;
+  const size_t        * nBytes;
+  float                 step = 0.0f;
+  if (packed[0] == QUANTISED) {
+    memcpy(&step, packed + 1, sizeof(float));
+    tags   += sizeof(float);
+    nBytes  = quantisedBytes;
+  }
+  else
+    nBytes  = losslessBytes;
+  const unsigned char * data = tags + (n + 3)/4;
+
+  unsigned int prev = 0;
+  for (size_t i = 0; i < n; i++) {
+    unsigned int tag  = (tags[i/4] >> (2*(i%4))) & 3;
+    unsigned int word = 0;
+    for (size_t b = 0; b < nBytes[tag]; b++)
+      word |= static_cast<unsigned int>(*data++) << (8*b);
+
+    if (step > 0.0f) {
+      prev += (word >> 1) ^ (0u - (word & 1));
+      values[i] = step*static_cast<float>(static_cast<int>(prev));
+    }
+    else {
+      prev ^= word;
+      memcpy(&values[i], &prev, sizeof(float));
+    }
+  }
+}
+
+void
+GridSwapFile::setCompression(bool compress, float maxRelError)
+{
+  compress_    = compress;
+  maxRelError_ = maxRelError;
+}
+
+bool  GridSwapFile::compress_    = false;
+float GridSwapFile::maxRelError_ = 0.0f;
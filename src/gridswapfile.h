@@ -0,0 +1,96 @@
+/***************************************************************************
+*      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
+***************************************************************************/
+
+#ifndef GRIDSWAPFILE_H
+#define GRIDSWAPFILE_H
+
+#include <assert.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef PARALLEL
+#include <pthread.h>
+#endif
+
+// Temporary file holding the values of a grid that is swapped out of memory.
+//
+// The file is read and written one slab (typically one padded xy-plane) at a
+// time, so that sequential access through getNext/setNext costs one system
+// call per slab instead of one per value.
+//
+// Slabs may optionally be compressed, either losslessly or with a maximum error
+// relative to the largest absolute value in the slab. Each compressed slab is
+// stored with its size, so slabs can still be read one by one.
+//
+// In parallel builds each open file has an I/O thread, so that disk access
+// overlaps with the caller's work between calls. When reading, the thread
+// reads and decodes the next slab while the caller uses the current one. When
+// writing, it encodes and writes the previous slab while the caller fills the
+// current one. The thread is stopped by close().
+
+class GridSwapFile
+{
+public:
+  GridSwapFile();
+  ~GridSwapFile();
+
+  void          openRead(const std::string & fileName, size_t slabSize);
+  void          openWrite(const std::string & fileName, size_t slabSize);
+  void          close();
+
+  void          readAll(float * values, size_t n);        // File must be opened for reading
+  void          writeAll(const float * values, size_t n); // File must be opened for writing
+
+  float         getNext()            { if (pos_ == nBuffer_) fillBuffer() ; return buffer_[pos_++]  ;}
+  void          setNext(float value) { if (pos_ == slabSize_) flushBuffer(); buffer_[pos_++] = value;}
+
+  static void   setCompression(bool compress, float maxRelError);
+
+private:
+  enum          slabCodec{RAW, LOSSLESS, QUANTISED};
+
+  static size_t encodeSlab(const float * values, size_t n, unsigned char * packed);
+  static void   decodeSlab(const unsigned char * packed, size_t n, float * values);
+
+  enum          ioJob{IDLE, READ, WRITE, STOP};
+
+  void          fillBuffer();
+  void          flushBuffer();
+  size_t        receiveSlab();          ///< Puts the next slab of the file in buffer_
+  void          sendSlab(size_t n);     ///< Writes the first n values of buffer_ as the next slab
+  size_t        readSlab(float * values, size_t n);
+  void          writeSlab(const float * values, size_t n);
+
+#ifdef PARALLEL
+  void          startWorker(int job);
+  void          waitForWorker();
+  void          postJob(int job);
+  static void * runWorker(void * file);
+#endif
+
+  std::ifstream      inFile_;
+  std::ofstream      outFile_;
+  std::vector<float> buffer_;
+  std::vector<unsigned char> packed_;   ///< Compressed slab being encoded or decoded
+  size_t             slabSize_;   ///< Number of values read or written per call
+  size_t             nBuffer_;    ///< Number of valid values in buffer_
+  size_t             pos_;        ///< Position of next value in buffer_
+
+#ifdef PARALLEL
+  pthread_t          worker_;
+  pthread_mutex_t    mutex_;
+  pthread_cond_t     cond_;
+  bool               running_;    ///< Worker thread has been started
+  bool               failed_;     ///< Worker thread could not read or write a slab
+  int                job_;        ///< Job of worker thread, an ioJob
+  std::vector<float> ioBuffer_;   ///< Slab being read or written by worker thread
+  size_t             nIoBuffer_;  ///< Number of valid values in ioBuffer_
+#endif
+
+  static bool        compress_;     ///< Compress slabs when writing
+  static float       maxRelError_;  ///< Allowed error relative to largest value in slab. Lossless if zero.
+};
+
+#endif
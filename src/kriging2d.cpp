@@ -16,6 +16,19 @@ void Kriging2D::krigSurface(Grid2D              & trend,
                             const KrigingData2D & krigingData,
                             const CovGrid2D     & cov,
                             bool                  getResiduals)
+{
+  NRLib::SymmetricMatrix L;
+  if (needsKrigingMatrix(krigingData, static_cast<int>(trend.GetNI()), static_cast<int>(trend.GetNJ())))
+    factoriseKrigingMatrix(L, cov, krigingData.getIndexI(), krigingData.getIndexJ());
+
+  krigSurface(trend, krigingData, cov, L, getResiduals);
+}
+
+void Kriging2D::krigSurface(Grid2D                       & trend,
+                            const KrigingData2D          & krigingData,
+                            const CovGrid2D              & cov,
+                            const NRLib::SymmetricMatrix & factorK,
+                            bool                           getResiduals)
 {
   //
   // This routine by default returns z(x) = m(x) + k(x)K^{-1}(d - m). If only
@@ -33,7 +46,6 @@ void Kriging2D::krigSurface(Grid2D              & trend,
 
     NRLib::Vector residual(md);
 
-    NRLib::SymmetricMatrix K;
     NRLib::Vector k;
     NRLib::Vector x;
 
@@ -59,12 +71,10 @@ void Kriging2D::krigSurface(Grid2D              & trend,
         {
           if(first)
           {
-             K.resize(md);
              k.resize(md);
              x.resize(md);
 
-             fillKrigingMatrix(K, cov, indexi, indexj);
-             NRLib::CholeskySolve(K, residual, x);
+             NRLib::CholeskySolveFactorized(factorK, residual, x);
              first = false;
           }
           fillKrigingVector(k, cov, indexi, indexj, i, j);
@@ -81,6 +91,28 @@ void Kriging2D::krigSurface(Grid2D              & trend,
   }
 }
 
+bool
+Kriging2D::needsKrigingMatrix(const KrigingData2D & krigingData,
+                              int                   nx,
+                              int                   ny)
+{
+  // The data positions are distinct, so there are cells to krig unless every
+  // cell holds data.
+  int md = krigingData.getNumberOfData();
+  return (md > 0 && md < nx*ny);
+}
+
+void
+Kriging2D::factoriseKrigingMatrix(NRLib::SymmetricMatrix  & L,
+                                  const CovGrid2D         & cov,
+                                  const std::vector<int>  & indexi,
+                                  const std::vector<int>  & indexj)
+{
+  L.resize(static_cast<int>(indexi.size()));
+  fillKrigingMatrix(L, cov, indexi, indexj);
+  NRLib::CholeskyFactorize(L);
+}
+
 void
 Kriging2D::subtractTrend(NRLib::Vector            & residual,
                          const std::vector<float> & data,
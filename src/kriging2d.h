@@ -5,6 +5,9 @@
 #ifndef KRIGING2D_H
 #define KRIGING2D_H
 
+#include <map>
+#include <vector>
+
 #include "src/definitions.h"
 #include "src/covgrid2d.h"
 #include "src/krigingdata2d.h"
@@ -18,11 +21,30 @@ class CovGrid2D;
 class Kriging2D
 {
 public:
+  // Cholesky factors of kriging matrices keyed by the (i,j) data positions.
+  // Surfaces kriged with the same covariance and data positions can share factors.
+  typedef std::map<std::pair<std::vector<int>, std::vector<int> >, NRLib::SymmetricMatrix> FactorMap;
+
   static void  krigSurface(Grid2D              & trend,
                            const KrigingData2D & krigingData,
                            const CovGrid2D     & cov,
                            bool                  getResiduals = false);
 
+  static void  krigSurface(Grid2D                       & trend,
+                           const KrigingData2D          & krigingData,
+                           const CovGrid2D              & cov,
+                           const NRLib::SymmetricMatrix & factorK,        ///< From factoriseKrigingMatrix()
+                           bool                           getResiduals = false);
+
+  static bool  needsKrigingMatrix(const KrigingData2D & krigingData,
+                                  int                   nx,
+                                  int                   ny);
+
+  static void  factoriseKrigingMatrix(NRLib::SymmetricMatrix  & L,
+                                      const CovGrid2D         & cov,
+                                      const std::vector<int>  & indexi,
+                                      const std::vector<int>  & indexj);
+
 private:
   static void  subtractTrend(NRLib::Vector            & d,
                              const std::vector<float> & data,
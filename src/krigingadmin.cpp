@@ -2,6 +2,7 @@
 *      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
 ***************************************************************************/
 
+#include <algorithm>
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
@@ -49,9 +50,6 @@ CKrigingAdmin::~CKrigingAdmin(void)
 {
   delete pBWellGrid_;
 
-  delete [] pIndexAlpha_;
-  delete [] pIndexBeta_;
-  delete [] pIndexRho_;
   int i;
   for (i = 0; i < GetSmoothBlockNx() - 2; i++) {
     delete [] ppKrigSmoothWeightsX_[i];
@@ -70,8 +68,6 @@ CKrigingAdmin::~CKrigingAdmin(void)
 }
 
 void CKrigingAdmin::Init() {
-  i_ = j_ = k_ = 0;
-
   //
   // Create indicator grid having 1.0f if data in cell and -1.0f if no data in cell
   // I wonder why Bjørn didn't choose and int grid with 1s and 0s instead?
@@ -93,12 +89,13 @@ void CKrigingAdmin::Init() {
   }
   noValid_ = noValidAlpha_ + noValidBeta_ + noValidRho_;
 
-  noKrigedCells_ = noKrigedVariables_ = totalNoDataInCurrKrigBlock_= noEmptyDataBlocks_ = 0;
-  sizeAlpha_ = sizeBeta_ = sizeRho_ = 0;
+  noKrigedCells_ = noKrigedVariables_ = noEmptyDataBlocks_ = 0;
+  monitorSize_ = 1;
+  showProgress_ = true;
   rangeAlphaX_ = rangeAlphaY_ = rangeAlphaZ_ = 0;
   rangeBetaX_ = rangeBetaY_ = rangeBetaZ_ = 0;
   rangeRhoX_ = rangeRhoY_ = rangeRhoZ_ = 0;
-  noSolvedMatrixEq_ = noCholeskyDecomp_ = noRMissing_ = 0;
+  noSolvedMatrixEq_ = noCholeskyDecomp_ = noRMissing_ = noReusedSolutions_ = 0;
   dxSmoothBlock_ = dySmoothBlock_ = dzSmoothBlock_ = 0;
   ppKrigSmoothWeightsX_ = ppKrigSmoothWeightsY_ = ppKrigSmoothWeightsZ_ = 0;
   failed2EstimateRange_ = failed2EstimateDefaultDataBoxAndBlock_ = false;
@@ -154,13 +151,9 @@ void CKrigingAdmin::Init() {
     (dyBlock_ + 2*static_cast<int>(ceil(rangeY_))) *
     (dzBlock_ + 2*static_cast<int>(ceil(rangeZ_)));
 
-  int maxAlphaData2 = std::min(noValidAlpha_, sizeMaxBlock);
-  int maxBetaData2  = std::min(noValidBeta_, sizeMaxBlock);
-  int maxRhoData2   = std::min(noValidRho_, sizeMaxBlock);
-
-  pIndexAlpha_ = new int[maxAlphaData2];
-  pIndexBeta_ = new int[maxBetaData2];
-  pIndexRho_  = new int[maxRhoData2];
+  maxAlphaData_ = std::min(noValidAlpha_, sizeMaxBlock);
+  maxBetaData_  = std::min(noValidBeta_, sizeMaxBlock);
+  maxRhoData_   = std::min(noValidRho_, sizeMaxBlock);
 
   Require(dxBlockExt_ <= rangeX_ && dyBlockExt_ <= rangeY_ && dzBlockExt_ <= rangeZ_,
     "dxBlockExt_ <= rangeX_ && dyBlockExt_ <= rangeY_ && dzBlockExt_ <= rangeZ_");
@@ -168,46 +161,80 @@ void CKrigingAdmin::Init() {
   WriteDebugOutput();
 }
 
-void CKrigingAdmin::KrigAll(Gamma gamma, bool doSmoothing) {
+void CKrigingAdmin::KrigAll(const std::vector<Gamma> & gammas, int nThreads, bool doSmoothing) {
   // basic set of neighbourhoods
-  noCholeskyDecomp_ = noSolvedMatrixEq_ = 0;
-  noRMissing_ = 0;
   const int nxBlock = NBlocks(dxBlock_, simbox_.getnx());
   const int nyBlock = NBlocks(dyBlock_, simbox_.getny());
   const int nzBlock = NBlocks(dzBlock_, simbox_.getnz());
+  const int nRows   = nyBlock*nzBlock;
+  const int nTasks  = nRows*static_cast<int>(gammas.size());
 
-  monitorSize_ = int(3*simbox_.getnx()*simbox_.getny()*simbox_.getnz()*0.02);
-  monitorSize_ = std::max(1,monitorSize_);
+  // The blocks are independent and write to disjoint parts of the trend grids,
+  // so the blocks of all variables are kriged in one loop. Each thread has its
+  // own block state and statistics, which are summed at the end.
+  //
+  // A thread krigs a whole row of blocks at a time, as neighbouring blocks often
+  // find the same data and can reuse the solution from the thread's cache.
+  std::vector<KrigingStats> stats(gammas.size());
 
-  // loop over all kriging blocks
-  int i,j,k;
-  for (k = 0; k < nzBlock; k++) {
-    int k1 = k*dzBlock_;
-    for (j = 0; j < nyBlock; j++) {
+#ifdef PARALLEL
+#pragma omp parallel num_threads(nThreads)
+#endif
+  {
+    BlockState                block;
+    std::vector<KrigingStats> threadStats(gammas.size());
+    block.indexAlpha.resize(maxAlphaData_);
+    block.indexBeta.resize(maxBetaData_);
+    block.indexRho.resize(maxRhoData_);
+    block.maxCacheSize = 2*nxBlock + 1; // This and the previous row
+
+#ifdef PARALLEL
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int task = 0; task < nTasks; task++) {
+      int g  = task/nRows;
+      int j  = task%nyBlock;
+      int k  = (task/nyBlock)%nzBlock;
       int j1 = j*dyBlock_;
-      for (i = 0; i < nxBlock; i++) {
-   //     LogKit::LogFormatted(LogKit::DebugLow,"%d %d %d : %d %d %d\n",i, j, k, nxBlock, nyBlock, nzBlock);
+      int k1 = k*dzBlock_;
+      for (int i = 0; i < nxBlock; i++) {
         int i1 = i*dxBlock_;
-        currBlock_ = CBox(i1, j1, k1, i1 + dxBlock_ - 1, j1 + dyBlock_ - 1, k1 + dzBlock_ - 1, &simbox_);
-        currDataBox_ = CBox(i1 - dxBlockExt_, j1 - dyBlockExt_, k1 - dzBlockExt_,
+        block.currBlock = CBox(i1, j1, k1, i1 + dxBlock_ - 1, j1 + dyBlock_ - 1, k1 + dzBlock_ - 1, &simbox_);
+        block.currDataBox = CBox(i1 - dxBlockExt_, j1 - dyBlockExt_, k1 - dzBlockExt_,
           i1 + dxBlock_ + dxBlockExt_ - 1, j1 + dyBlock_ + dyBlockExt_ - 1, k1 + dzBlock_ + dzBlockExt_ - 1,
           &simbox_);
-        KrigBlock(gamma);
-      } // end i
-    } // end j
-  } // end k
-  noKrigedVariables_++;
-  if (!backgroundModel_ && doSmoothing==true) {
-    //LogKit::LogFormatted(LogKit::Low,"SmoothKrigedResult start\n");
-    SmoothKrigedResult(gamma);
-    //LogKit::LogFormatted(LogKit::Low,"SmoothKrigedResult end\n");
-  }
+        KrigBlock(gammas[g], block, threadStats[g]);
+      }
+    }
 
+#ifdef PARALLEL
+#pragma omp critical(kriging_stats)
+#endif
+    {
+      for (size_t g = 0; g < gammas.size(); g++)
+        stats[g].Add(threadStats[g]);
+    }
+  }
 
+  for (size_t g = 0; g < gammas.size(); g++) {
+    noEmptyDataBlocks_ += stats[g].noEmptyDataBlocks;
+    noCholeskyDecomp_   = stats[g].noCholeskyDecomp;
+    noSolvedMatrixEq_   = stats[g].noSolvedMatrixEq;
+    noRMissing_         = stats[g].noRMissing;
+    noReusedSolutions_  = stats[g].noReusedSolutions;
+    noKrigedVariables_++;
+    if (!backgroundModel_ && doSmoothing==true) {
+      //LogKit::LogFormatted(LogKit::Low,"SmoothKrigedResult start\n");
+      SmoothKrigedResult(gammas[g]);
+      //LogKit::LogFormatted(LogKit::Low,"SmoothKrigedResult end\n");
+    }
+    WriteDebugOutput2();
+  }
 }
 
 void CKrigingAdmin::KrigAll(FFTGrid& trendAlpha, FFTGrid& trendBeta, FFTGrid& trendRho, SeismicParametersHolder & seismicParameters,
-                            bool trendsAlreadySubtracted, int debugflag, bool doSmoothing) {
+                            bool trendsAlreadySubtracted, int debugflag, bool doSmoothing, int nThreads,
+                            bool showProgress) {
   Require(!trendAlpha.getIsTransformed()
           && !trendBeta.getIsTransformed()
           && !trendRho.getIsTransformed(),
@@ -245,79 +272,108 @@ void CKrigingAdmin::KrigAll(FFTGrid& trendAlpha, FFTGrid& trendBeta, FFTGrid& tr
   trendBeta_  = &trendBeta;
   trendRho_   = &trendRho;
 
-  printf("\n  0%%       20%%       40%%       60%%       80%%      100%%");
-  printf("\n  |    |    |    |    |    |    |    |    |    |    |  ");
-  printf("\n  ^");
-
-  trendAlpha_->setAccessMode(FFTGrid::RANDOMACCESS);
-  LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Alpha\n");
-  KrigAll(ALPHA_KRIG, doSmoothing);
-  WriteDebugOutput2();
-  LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Alpha\n");
-  trendAlpha_->endAccess();
-
-  trendBeta_->setAccessMode(FFTGrid::RANDOMACCESS);
-  LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Beta\n");
-  KrigAll(BETA_KRIG, doSmoothing);
-  WriteDebugOutput2();
-  LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Beta\n");
-  trendBeta_->endAccess();
-
-  trendRho_->setAccessMode(FFTGrid::RANDOMACCESS);
-  LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Rho\n");
-  KrigAll(RHO_KRIG, doSmoothing);
-  WriteDebugOutput2();
-  LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Rho\n");
-  trendRho_->endAccess();
-
-  printf("\n");
+  showProgress_ = showProgress;
+  if (showProgress_) {
+    printf("\n  0%%       20%%       40%%       60%%       80%%      100%%");
+    printf("\n  |    |    |    |    |    |    |    |    |    |    |  ");
+    printf("\n  ^");
+  }
+
+  monitorSize_ = int(3*simbox_.getnx()*simbox_.getny()*simbox_.getnz()*0.02);
+  monitorSize_ = std::max(1,monitorSize_);
+
+  // Grids on file are loaded one at a time and kriged on one thread.
+  if (nThreads > 1 && !trendAlpha.isFile() && !trendBeta.isFile() && !trendRho.isFile()) {
+    std::vector<Gamma> gammas(3);
+    gammas[0] = ALPHA_KRIG;
+    gammas[1] = BETA_KRIG;
+    gammas[2] = RHO_KRIG;
+
+    trendAlpha_->setAccessMode(FFTGrid::RANDOMACCESS);
+    trendBeta_ ->setAccessMode(FFTGrid::RANDOMACCESS);
+    trendRho_  ->setAccessMode(FFTGrid::RANDOMACCESS);
+    LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Alpha, Beta and Rho\n");
+    KrigAll(gammas, nThreads, doSmoothing);
+    LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Alpha, Beta and Rho\n");
+    trendAlpha_->endAccess();
+    trendBeta_ ->endAccess();
+    trendRho_  ->endAccess();
+  }
+  else {
+    trendAlpha_->setAccessMode(FFTGrid::RANDOMACCESS);
+    LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Alpha\n");
+    KrigAll(std::vector<Gamma>(1, ALPHA_KRIG), 1, doSmoothing);
+    LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Alpha\n");
+    trendAlpha_->endAccess();
+
+    trendBeta_->setAccessMode(FFTGrid::RANDOMACCESS);
+    LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Beta\n");
+    KrigAll(std::vector<Gamma>(1, BETA_KRIG), 1, doSmoothing);
+    LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Beta\n");
+    trendBeta_->endAccess();
+
+    trendRho_->setAccessMode(FFTGrid::RANDOMACCESS);
+    LogKit::LogFormatted(LogKit::DebugHigh,"Start CKrigingAdminKrigAll: Rho\n");
+    KrigAll(std::vector<Gamma>(1, RHO_KRIG), 1, doSmoothing);
+    LogKit::LogFormatted(LogKit::DebugHigh,"End CKrigingAdminKrigAll: Rho\n");
+    trendRho_->endAccess();
+  }
+
+  if (showProgress_)
+    printf("\n");
   LogKit::LogFormatted(LogKit::DebugHigh,"KrigAll finished\n");
 }
 
-void CKrigingAdmin::KrigBlock(Gamma gamma)
+void CKrigingAdmin::KrigBlock(Gamma gamma, BlockState & block, KrigingStats & stats)
 {
   // search for neighbours
   LogKit::LogFormatted(LogKit::DebugHigh,"FindDataInDataBlockLoop(gamma) called next\n");
-  FindDataInDataBlockLoop(gamma);
-  LogKit::LogFormatted(LogKit::DebugHigh,"sizeAlpha_: %d\n", sizeAlpha_);
-  LogKit::LogFormatted(LogKit::DebugHigh,"sizeBeta_: %d\n", sizeBeta_);
-  LogKit::LogFormatted(LogKit::DebugHigh,"sizeRho_: %d\n", sizeRho_);
-  LogKit::LogFormatted(LogKit::DebugHigh,"totalNoDataInCurrKrigBlock_: %d\n", totalNoDataInCurrKrigBlock_);
+  FindDataInDataBlockLoop(gamma, block);
+  LogKit::LogFormatted(LogKit::DebugHigh,"sizeAlpha_: %d\n", block.sizeAlpha);
+  LogKit::LogFormatted(LogKit::DebugHigh,"sizeBeta_: %d\n", block.sizeBeta);
+  LogKit::LogFormatted(LogKit::DebugHigh,"sizeRho_: %d\n", block.sizeRho);
+  LogKit::LogFormatted(LogKit::DebugHigh,"totalNoDataInCurrKrigBlock_: %d\n", block.totalNoDataInCurrKrigBlock);
   //FindDataInDataBlock(gamma); //DEBUG
 
   int iMin, jMin, kMin, iMax, jMax, kMax;
-  currBlock_.GetMin(iMin, jMin, kMin); currBlock_.GetMax(iMax, jMax, kMax);
-  if (!totalNoDataInCurrKrigBlock_) {
-    int cellsInBlock = (kMax - kMin + 1)*(jMax - jMin + 1)*(iMax - iMin + 1);
-    int i;
-    for (i=noKrigedCells_ ; i<noKrigedCells_+cellsInBlock ; i++) {
-      if (noKrigedCells_ > 0 && i%monitorSize_ == 0) {
-        printf("^");
-        fflush(stdout);
-      }
-    }
-    noKrigedCells_ += cellsInBlock;
-    noEmptyDataBlocks_++;
+  block.currBlock.GetMin(iMin, jMin, kMin); block.currBlock.GetMax(iMax, jMax, kMax);
+  int cellsInBlock = (kMax - kMin + 1)*(jMax - jMin + 1)*(iMax - iMin + 1);
+  if (!block.totalNoDataInCurrKrigBlock) {
+    UpdateProgress(cellsInBlock);
+    stats.noEmptyDataBlocks++;
     return;
   }
 
-  int n = sizeAlpha_ + sizeBeta_ + sizeRho_;
+  int n = block.sizeAlpha + block.sizeBeta + block.sizeRho;
 
-  NRLib::Matrix krigMatrix(n, n);
-  NRLib::Vector residual(n);
+  NRLib::Vector x(n);
+  if (FindCachedSolution(gamma, block, x)) {
+    stats.noReusedSolutions++;
+  }
+  else {
+    NRLib::Matrix krigMatrix(n, n);
+    NRLib::Vector residual(n);
 
-  // Set kriging matrix based on data finds
+    // Set kriging matrix based on data finds
 
-  SetMatrix(krigMatrix,
-            residual,
-            gamma);
+    SetMatrix(krigMatrix,
+              residual,
+              gamma,
+              block);
 
-  NRLib::SymmetricMatrix K(n);
+    NRLib::SymmetricMatrix K(n);
 
-  for (int j = 0 ; j < n ; j++) {
-    for (int i = 0 ; i <= j ; i++) {
-      K(i,j) = krigMatrix(i,j);
+    for (int j = 0 ; j < n ; j++) {
+      for (int i = 0 ; i <= j ; i++) {
+        K(i,j) = krigMatrix(i,j);
+      }
     }
+
+    // NBNB-PAL: Add try/catch loop around CholeskySolve call with a regularization term.
+    NRLib::CholeskySolve(K, residual, x);
+    stats.noCholeskyDecomp++;
+
+    AddCachedSolution(gamma, block, x);
   }
 
   FFTGrid * pGrid = 0;
@@ -336,43 +392,87 @@ void CKrigingAdmin::KrigBlock(Gamma gamma)
     Require(false, "switch failed");
   } // end switch
 
-  NRLib::Vector x(n);
-  // NBNB-PAL: Add try/catch loop around CholeskySolve call with a regularization term.
-  NRLib::CholeskySolve(K, residual, x);
-
   NRLib::Vector kVec(n);
 
-  for (k_ = kMin; k_ <= kMax; k_++) {
-    for (j_ = jMin; j_ <= jMax; j_++) {
-      for (i_ = iMin; i_ <= iMax; i_++) {
+  for (block.k = kMin; block.k <= kMax; block.k++) {
+    for (block.j = jMin; block.j <= jMax; block.j++) {
+      for (block.i = iMin; block.i <= iMax; block.i++) {
 
         // set kriging vector
-        SetKrigVector(kVec, gamma);
+        SetKrigVector(kVec, gamma, block);
 
         // kriging;
-        float result = pGrid->getRealValue(i_, j_, k_);
+        float result = pGrid->getRealValue(block.i, block.j, block.k);
         if (result == RMISSING) {
-          noRMissing_++;
+          stats.noRMissing++;
         }
         else {
           result += static_cast<float>(kVec * x);
 
-          if(pGrid->setRealValue(i_, j_, k_, result))
+          if(pGrid->setRealValue(block.i, block.j, block.k, result))
             Require(false, "pGrid->setRealValue failed"); // something is serious wrong...
 
-          noSolvedMatrixEq_++;
-        }
-
-        noKrigedCells_++;
-        // return result
-        if (noKrigedCells_%monitorSize_ == 0) {
-          printf("^");
-          fflush(stdout);
+          stats.noSolvedMatrixEq++;
         }
       } // end for i
     } // end for j
   } // end for k
 
+  UpdateProgress(cellsInBlock);
+
+}
+
+void CKrigingAdmin::UpdateProgress(int nCells)
+{
+#ifdef PARALLEL
+#pragma omp critical(kriging_progress)
+#endif
+  {
+    for (int i = 0; i < nCells; i++) {
+      noKrigedCells_++;
+      if (showProgress_ && noKrigedCells_%monitorSize_ == 0) {
+        printf("^");
+        fflush(stdout);
+      }
+    }
+  }
+}
+
+bool CKrigingAdmin::FindCachedSolution(Gamma gamma, BlockState & block, NRLib::Vector & x) const
+{
+  std::list<CachedSolution>::iterator it;
+  for (it = block.cache.begin(); it != block.cache.end(); ++it) {
+    if (it->gamma == gamma &&
+        static_cast<int>(it->indexAlpha.size()) == block.sizeAlpha &&
+        static_cast<int>(it->indexBeta.size())  == block.sizeBeta  &&
+        static_cast<int>(it->indexRho.size())   == block.sizeRho   &&
+        std::equal(it->indexAlpha.begin(), it->indexAlpha.end(), block.indexAlpha.begin()) &&
+        std::equal(it->indexBeta.begin(),  it->indexBeta.end(),  block.indexBeta.begin())  &&
+        std::equal(it->indexRho.begin(),   it->indexRho.end(),   block.indexRho.begin()))
+    {
+      for (int i = 0; i < x.length(); i++)
+        x(i) = it->x[i];
+      block.cache.splice(block.cache.begin(), block.cache, it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CKrigingAdmin::AddCachedSolution(Gamma gamma, BlockState & block, const NRLib::Vector & x) const
+{
+  if (block.cache.size() >= block.maxCacheSize)
+    block.cache.pop_back();
+
+  block.cache.push_front(CachedSolution());
+  CachedSolution & solution = block.cache.front();
+  solution.gamma = gamma;
+  solution.indexAlpha.assign(block.indexAlpha.begin(), block.indexAlpha.begin() + block.sizeAlpha);
+  solution.indexBeta.assign(block.indexBeta.begin(), block.indexBeta.begin() + block.sizeBeta);
+  solution.indexRho.assign(block.indexRho.begin(), block.indexRho.begin() + block.sizeRho);
+  solution.x.resize(x.length());
+  for (int i = 0; i < x.length(); i++)
+    solution.x[i] = x(i);
 }
 
 FFTGrid* CKrigingAdmin::CreateValidGrid() const
@@ -438,8 +538,8 @@ CKrigingAdmin::SubtractTrends(FFTGrid& trend_alpha, FFTGrid& trend_beta, FFTGrid
 }
 
 CKrigingAdmin::DataBoxSize
-CKrigingAdmin::FindDataInDataBlock(Gamma gamma, const CBox & dataBox) {
-  sizeAlpha_ = sizeBeta_ = sizeRho_ = totalNoDataInCurrKrigBlock_ = 0;
+CKrigingAdmin::FindDataInDataBlock(Gamma gamma, const CBox & dataBox, BlockState & block) const {
+  block.sizeAlpha = block.sizeBeta = block.sizeRho = block.totalNoDataInCurrKrigBlock = 0;
   const int countTotalMin = int(dataTarget_*(1.0f - maxDataTolerance_/100.0f));
   const int countTotalMax = int(dataTarget_*(1.0f + maxDataTolerance_/100.0f));
 
@@ -451,37 +551,37 @@ CKrigingAdmin::FindDataInDataBlock(Gamma gamma, const CBox & dataBox) {
       pBWellPt_[i]->IsValidObs(validA, validB, validR);
       switch (gamma) {
       case ALPHA_KRIG :
-        if (validA && ++totalNoDataInCurrKrigBlock_)
-          pIndexAlpha_[sizeAlpha_++] = i;
+        if (validA && ++block.totalNoDataInCurrKrigBlock)
+          block.indexAlpha[block.sizeAlpha++] = i;
         else {
-          if (validB && ++totalNoDataInCurrKrigBlock_)
-            pIndexBeta_[sizeBeta_++] = i;
+          if (validB && ++block.totalNoDataInCurrKrigBlock)
+            block.indexBeta[block.sizeBeta++] = i;
 
-          if (validR && ++totalNoDataInCurrKrigBlock_)
-            pIndexRho_[sizeRho_++] = i;
+          if (validR && ++block.totalNoDataInCurrKrigBlock)
+            block.indexRho[block.sizeRho++] = i;
         }
         break;
 
       case BETA_KRIG :
-        if (validB && ++totalNoDataInCurrKrigBlock_)
-          pIndexBeta_[sizeBeta_++] = i;
+        if (validB && ++block.totalNoDataInCurrKrigBlock)
+          block.indexBeta[block.sizeBeta++] = i;
         else {
-          if (validA && ++totalNoDataInCurrKrigBlock_)
-            pIndexAlpha_[sizeAlpha_++] = i;
+          if (validA && ++block.totalNoDataInCurrKrigBlock)
+            block.indexAlpha[block.sizeAlpha++] = i;
 
-          if (validR && ++totalNoDataInCurrKrigBlock_)
-            pIndexRho_[sizeRho_++] = i;
+          if (validR && ++block.totalNoDataInCurrKrigBlock)
+            block.indexRho[block.sizeRho++] = i;
         }
         break;
       case RHO_KRIG :
-        if (validR && ++totalNoDataInCurrKrigBlock_)
-          pIndexRho_[sizeRho_++] = i;
+        if (validR && ++block.totalNoDataInCurrKrigBlock)
+          block.indexRho[block.sizeRho++] = i;
         else {
-          if (validA && ++totalNoDataInCurrKrigBlock_)
-            pIndexAlpha_[sizeAlpha_++] = i;
+          if (validA && ++block.totalNoDataInCurrKrigBlock)
+            block.indexAlpha[block.sizeAlpha++] = i;
 
-          if (validB && ++totalNoDataInCurrKrigBlock_)
-            pIndexBeta_[sizeBeta_++] = i;
+          if (validB && ++block.totalNoDataInCurrKrigBlock)
+            block.indexBeta[block.sizeBeta++] = i;
         }
         break;
 
@@ -492,28 +592,28 @@ CKrigingAdmin::FindDataInDataBlock(Gamma gamma, const CBox & dataBox) {
       // early exit
     } // end if
   } // end i
-  LogKit::LogFormatted(LogKit::DebugHigh,"Found %d data. (%d, %d)\n", totalNoDataInCurrKrigBlock_,
+  LogKit::LogFormatted(LogKit::DebugHigh,"Found %d data. (%d, %d)\n", block.totalNoDataInCurrKrigBlock,
     countTotalMin, countTotalMax);
-  if (totalNoDataInCurrKrigBlock_ <= countTotalMax && totalNoDataInCurrKrigBlock_ >= countTotalMin)
+  if (block.totalNoDataInCurrKrigBlock <= countTotalMax && block.totalNoDataInCurrKrigBlock >= countTotalMin)
     return DBS_RIGHT;
-  if (totalNoDataInCurrKrigBlock_ < countTotalMin)
+  if (block.totalNoDataInCurrKrigBlock < countTotalMin)
     return DBS_TOO_SMALL;
-  else {//(totalNoDataInCurrKrigBlock_ > countTotalMax)
+  else {//(block.totalNoDataInCurrKrigBlock > countTotalMax)
     return DBS_TOO_BIG;
   }
 }
 
 
-void CKrigingAdmin::FindDataInDataBlockLoop(Gamma gamma) {
+void CKrigingAdmin::FindDataInDataBlockLoop(Gamma gamma, BlockState & block) const {
   int counter = 0;
   DataBoxSize currDataBoxSize, startDataboxSize, testDataBoxSize;
-  currDataBoxSize = FindDataInDataBlock(gamma, currDataBox_);
+  currDataBoxSize = FindDataInDataBlock(gamma, block.currDataBox, block);
   startDataboxSize = currDataBoxSize;
-  //CBox minDataBox = currBlock_;
-  CBox minDataBox = currDataBox_;
+  //CBox minDataBox = block.currBlock;
+  CBox minDataBox = block.currDataBox;
   int iMin,iMax,jMin,jMax,kMin,kMax;
-  currBlock_.GetMin(iMin,jMin,kMin);
-  currBlock_.GetMax(iMax,jMax,kMax);
+  block.currBlock.GetMin(iMin,jMin,kMin);
+  block.currBlock.GetMax(iMax,jMax,kMax);
   CBox maxDataBox(iMin-int(rangeX_),jMin-int(rangeY_),kMin-int(rangeZ_),
     iMax+int(rangeX_),jMax+int(rangeY_),kMax+int(rangeZ_));
 
@@ -522,18 +622,18 @@ void CKrigingAdmin::FindDataInDataBlockLoop(Gamma gamma) {
     // NBNB-PAL: Nothing to do here? I put in this switch option to avoid a crash (CRA-75)
     break;
   case DBS_TOO_SMALL:
-    testDataBoxSize = FindDataInDataBlock(gamma, maxDataBox);
+    testDataBoxSize = FindDataInDataBlock(gamma, maxDataBox, block);
     if(testDataBoxSize != DBS_TOO_BIG)
     {
-      currDataBox_ = maxDataBox;
+      block.currDataBox = maxDataBox;
       currDataBoxSize = DBS_RIGHT;
     }
     break;
   case DBS_TOO_BIG:
-    testDataBoxSize = FindDataInDataBlock(gamma, minDataBox);
+    testDataBoxSize = FindDataInDataBlock(gamma, minDataBox, block);
     if(testDataBoxSize != DBS_TOO_SMALL)
     {
-      currDataBox_ = minDataBox;
+      block.currDataBox = minDataBox;
       currDataBoxSize = DBS_RIGHT;
     }
     break;
@@ -546,12 +646,12 @@ void CKrigingAdmin::FindDataInDataBlockLoop(Gamma gamma) {
   while (currDataBoxSize != DBS_RIGHT) {
     switch (currDataBoxSize) {
     case DBS_TOO_SMALL :
-      minDataBox = currDataBox_;
-      currDataBox_.ModifyBox(maxDataBox);
+      minDataBox = block.currDataBox;
+      block.currDataBox.ModifyBox(maxDataBox);
       break;
     case DBS_TOO_BIG :
-      maxDataBox = currDataBox_;
-      currDataBox_.ModifyBox(minDataBox);
+      maxDataBox = block.currDataBox;
+      block.currDataBox.ModifyBox(minDataBox);
       break;
     default :
       Require(false, "switch failed");
@@ -559,15 +659,15 @@ void CKrigingAdmin::FindDataInDataBlockLoop(Gamma gamma) {
 
     } // end switch
     counter++;
-    //if (currDataBoxSize != startDataboxSize || counter++ >= maxDataBlockLoopCounter_ || prevDataBox == currDataBox_)
-    //if (currDataBoxSize != startDataboxSize || prevDataBox == currDataBox_)
-    if(currDataBox_ == maxDataBox || currDataBox_ == minDataBox)
+    //if (currDataBoxSize != startDataboxSize || counter++ >= maxDataBlockLoopCounter_ || prevDataBox == block.currDataBox)
+    //if (currDataBoxSize != startDataboxSize || prevDataBox == block.currDataBox)
+    if(block.currDataBox == maxDataBox || block.currDataBox == minDataBox)
       break;
 
-    currDataBoxSize = FindDataInDataBlock(gamma, currDataBox_);
+    currDataBoxSize = FindDataInDataBlock(gamma, block.currDataBox, block);
 
   } // end while
-  currDataBox_.ModifyBox(currDataBox_, &simbox_); //Does not modify, only truncates.
+  block.currDataBox.ModifyBox(block.currDataBox, &simbox_); //Does not modify, only truncates.
 
   LogKit::LogFormatted(LogKit::DebugHigh,"FindDataInDataBlock iterations: %d\n", counter);
 }
@@ -580,11 +680,12 @@ int CKrigingAdmin::NBlocks(int dBlocks, int lSBox) const {
   return lSBox/dBlocks + 1;
 }
 
-void CKrigingAdmin::SetMatrix(NRLib::Matrix & krigMatrix,
-                              NRLib::Vector & residual,
-                              Gamma           gamma) {
+void CKrigingAdmin::SetMatrix(NRLib::Matrix    & krigMatrix,
+                              NRLib::Vector    & residual,
+                              Gamma              gamma,
+                              const BlockState & block) const {
   assert(gamma >= 0);
-  if (!totalNoDataInCurrKrigBlock_)
+  if (!block.totalNoDataInCurrKrigBlock)
     return;
   int a, b, r;
 
@@ -592,14 +693,14 @@ void CKrigingAdmin::SetMatrix(NRLib::Matrix & krigMatrix,
   // for alpha kriging
   int a2, b2, r2;
   // first row
-  for (a = 0; a < sizeAlpha_; a++) {
+  for (a = 0; a < block.sizeAlpha; a++) {
     int krigRowIndex = a;
-    int indexA = pIndexAlpha_[a];
+    int indexA = block.indexAlpha[a];
     int i,j,k;
     pBWellPt_[indexA]->GetIJK(i, j, k);
     // K_aa
-    for (a2 = 0; a2 < sizeAlpha_; a2++) {
-      int indexA2 = pIndexAlpha_[a2];
+    for (a2 = 0; a2 < block.sizeAlpha; a2++) {
+      int indexA2 = block.indexAlpha[a2];
       int i2, j2, k2;
       pBWellPt_[indexA2]->GetIJK(i2, j2, k2);
 
@@ -607,106 +708,107 @@ void CKrigingAdmin::SetMatrix(NRLib::Matrix & krigMatrix,
     } // end a2
 
     // K_ab
-    for (b2 = 0; b2 < sizeBeta_; b2++) {
-      int indexB2 = pIndexBeta_[b2];
+    for (b2 = 0; b2 < block.sizeBeta; b2++) {
+      int indexB2 = block.indexBeta[b2];
       int i2, j2, k2;
       pBWellPt_[indexB2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex, b2 + sizeAlpha_) = covCrAlphaBeta_.GetGamma2(i, j, k, i2, j2, k2);
+      krigMatrix(krigRowIndex, b2 + block.sizeAlpha) = covCrAlphaBeta_.GetGamma2(i, j, k, i2, j2, k2);
     } // end b2
 
     // K_ar
-    for (r2 = 0; r2 < sizeRho_; r2++) {
-      int indexR2 = pIndexRho_[r2];
+    for (r2 = 0; r2 < block.sizeRho; r2++) {
+      int indexR2 = block.indexRho[r2];
       int i2, j2, k2;
       pBWellPt_[indexR2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex, r2 + sizeAlpha_ + sizeBeta_) = covCrAlphaRho_.GetGamma2(i, j, k, i2, j2, k2);
+      krigMatrix(krigRowIndex, r2 + block.sizeAlpha + block.sizeBeta) = covCrAlphaRho_.GetGamma2(i, j, k, i2, j2, k2);
     } // end r2
   }// end a
 
   // second row
-  for (b = 0; b < sizeBeta_; b++) {
-    int krigRowIndex = b + sizeAlpha_;
-    int indexB = pIndexBeta_[b];
+  for (b = 0; b < block.sizeBeta; b++) {
+    int krigRowIndex = b + block.sizeAlpha;
+    int indexB = block.indexBeta[b];
     int i,j,k;
     pBWellPt_[indexB]->GetIJK(i, j, k);
     // K_ba
-    for (a2 = 0; a2 < sizeAlpha_; a2++) {
-      int indexA2 = pIndexAlpha_[a2];
+    for (a2 = 0; a2 < block.sizeAlpha; a2++) {
+      int indexA2 = block.indexAlpha[a2];
       int i2, j2, k2;
       pBWellPt_[indexA2]->GetIJK(i2, j2, k2);
       krigMatrix(krigRowIndex,a2) = covCrAlphaBeta_.GetGamma2(i2, j2, k2, i, j, k); // flip
     } // end a2
 
     // K_bb
-    for (b2 = 0; b2 < sizeBeta_; b2++) {
-      int indexB2 = pIndexBeta_[b2];
+    for (b2 = 0; b2 < block.sizeBeta; b2++) {
+      int indexB2 = block.indexBeta[b2];
       int i2, j2, k2;
       pBWellPt_[indexB2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex, b2 + sizeAlpha_) = covBeta_.GetGamma2(i, j, k, i2, j2, k2);
+      krigMatrix(krigRowIndex, b2 + block.sizeAlpha) = covBeta_.GetGamma2(i, j, k, i2, j2, k2);
     } // end b2
 
     // K_br
-    for (r2 = 0; r2 < sizeRho_; r2++) {
-      int indexR2 = pIndexRho_[r2];
+    for (r2 = 0; r2 < block.sizeRho; r2++) {
+      int indexR2 = block.indexRho[r2];
       int i2, j2, k2;
       pBWellPt_[indexR2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex,r2 + sizeAlpha_ + sizeBeta_) = covCrBetaRho_.GetGamma2(i, j, k, i2, j2, k2);
+      krigMatrix(krigRowIndex,r2 + block.sizeAlpha + block.sizeBeta) = covCrBetaRho_.GetGamma2(i, j, k, i2, j2, k2);
     } // end r2
   }// end b
   // third row
-  for (r = 0; r < sizeRho_; r++) {
-    int krigRowIndex = r + sizeAlpha_ + sizeBeta_;
-    int indexR = pIndexRho_[r];
+  for (r = 0; r < block.sizeRho; r++) {
+    int krigRowIndex = r + block.sizeAlpha + block.sizeBeta;
+    int indexR = block.indexRho[r];
     int i,j,k;
     pBWellPt_[indexR]->GetIJK(i, j, k);
     // K_ra
-    for (a2 = 0; a2 < sizeAlpha_; a2++) {
-      int indexA2 = pIndexAlpha_[a2];
+    for (a2 = 0; a2 < block.sizeAlpha; a2++) {
+      int indexA2 = block.indexAlpha[a2];
       int i2, j2, k2;
       pBWellPt_[indexA2]->GetIJK(i2, j2, k2);
       krigMatrix(krigRowIndex, a2) = covCrAlphaRho_.GetGamma2(i2, j2, k2, i, j, k); // flip
     } // end a2
 
     // K_rb
-    for (b2 = 0; b2 < sizeBeta_; b2++) {
-      int indexB2 = pIndexBeta_[b2];
+    for (b2 = 0; b2 < block.sizeBeta; b2++) {
+      int indexB2 = block.indexBeta[b2];
       int i2, j2, k2;
       pBWellPt_[indexB2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex, b2  + sizeAlpha_) = covCrBetaRho_.GetGamma2(i2, j2, k2, i, j, k); // flip
+      krigMatrix(krigRowIndex, b2  + block.sizeAlpha) = covCrBetaRho_.GetGamma2(i2, j2, k2, i, j, k); // flip
     } // end b2
 
     // K_rr
-    for (r2 = 0; r2 < sizeRho_; r2++) {
-      int indexR2 = pIndexRho_[r2];
+    for (r2 = 0; r2 < block.sizeRho; r2++) {
+      int indexR2 = block.indexRho[r2];
       int i2, j2, k2;
       pBWellPt_[indexR2]->GetIJK(i2, j2, k2);
-      krigMatrix(krigRowIndex, r2 + sizeAlpha_ + sizeBeta_) = covRho_.GetGamma2(i, j, k, i2, j2, k2);
+      krigMatrix(krigRowIndex, r2 + block.sizeAlpha + block.sizeBeta) = covRho_.GetGamma2(i, j, k, i2, j2, k2);
     } // end r2
   }// end r
 
   // Also calulates the kriging data vector
-  for (a = 0; a < sizeAlpha_; a++) {
-    int indexA = pIndexAlpha_[a];
+  for (a = 0; a < block.sizeAlpha; a++) {
+    int indexA = block.indexAlpha[a];
     residual(a) = pBWellPt_[indexA]->GetAlpha();
   } // end a
 
-  for (b = 0; b < sizeBeta_; b++) {
-    int indexB = pIndexBeta_[b];
-    residual(sizeAlpha_ + b) = pBWellPt_[indexB]->GetBeta();
+  for (b = 0; b < block.sizeBeta; b++) {
+    int indexB = block.indexBeta[b];
+    residual(block.sizeAlpha + b) = pBWellPt_[indexB]->GetBeta();
   } // end b
 
-  for (r = 0; r < sizeRho_; r++) {
-    int indexR = pIndexRho_[r];
-    residual(sizeAlpha_ + sizeBeta_ + r) = pBWellPt_[indexR]->GetRho();
+  for (r = 0; r < block.sizeRho; r++) {
+    int indexR = block.indexRho[r];
+    residual(block.sizeAlpha + block.sizeBeta + r) = pBWellPt_[indexR]->GetRho();
   } // end r
 
 }
 
-void CKrigingAdmin::SetKrigVector(NRLib::Vector & k,
-                                  Gamma           gamma)
+void CKrigingAdmin::SetKrigVector(NRLib::Vector    & k,
+                                  Gamma              gamma,
+                                  const BlockState & block) const
 {
   int offsetB1, offsetR1;
-  offsetB1 = sizeAlpha_; offsetR1 = sizeAlpha_ + sizeBeta_;
+  offsetB1 = block.sizeAlpha; offsetR1 = block.sizeAlpha + block.sizeBeta;
   const CovGridSeparated *pA = NULL, *pB = NULL, *pR = NULL;
   bool flipA = false, flipB = false, flipR = false;
   switch(gamma) {
@@ -735,29 +837,29 @@ void CKrigingAdmin::SetKrigVector(NRLib::Vector & k,
 
   // k_a
   int a2;
-  for (a2 = 0; a2 < sizeAlpha_; a2++) {
-    int indexA2 = pIndexAlpha_[a2];
+  for (a2 = 0; a2 < block.sizeAlpha; a2++) {
+    int indexA2 = block.indexAlpha[a2];
     int i2, j2, k2;
     pBWellPt_[indexA2]->GetIJK(i2, j2, k2);
-    k(a2) = (!flipA ? pA->GetGamma2(i_, j_, k_, i2, j2, k2) : pA->GetGamma2(i2, j2, k2, i_, j_, k_));
+    k(a2) = (!flipA ? pA->GetGamma2(block.i, block.j, block.k, i2, j2, k2) : pA->GetGamma2(i2, j2, k2, block.i, block.j, block.k));
   } // end a2
 
   // k_b
   int b2;
-  for (b2 = 0; b2 < sizeBeta_; b2++) {
-    int indexB2 = pIndexBeta_[b2];
+  for (b2 = 0; b2 < block.sizeBeta; b2++) {
+    int indexB2 = block.indexBeta[b2];
     int i2, j2, k2;
     pBWellPt_[indexB2]->GetIJK(i2, j2, k2);
-    k(b2 + offsetB1) = (!flipB ? pB->GetGamma2(i_, j_, k_, i2, j2, k2) : pB->GetGamma2(i2, j2, k2, i_, j_, k_));
+    k(b2 + offsetB1) = (!flipB ? pB->GetGamma2(block.i, block.j, block.k, i2, j2, k2) : pB->GetGamma2(i2, j2, k2, block.i, block.j, block.k));
   } // end b2
 
   // k_r
   int r2;
-  for (r2 = 0; r2 < sizeRho_; r2++) {
-    int indexR2 = pIndexRho_[r2];
+  for (r2 = 0; r2 < block.sizeRho; r2++) {
+    int indexR2 = block.indexRho[r2];
     int i2, j2, k2;
     pBWellPt_[indexR2]->GetIJK(i2, j2, k2);
-    k(r2 + offsetR1) = (!flipR ? pR->GetGamma2(i_, j_, k_, i2, j2, k2) : pR->GetGamma2(i2, j2, k2, i_, j_, k_));
+    k(r2 + offsetR1) = (!flipR ? pR->GetGamma2(block.i, block.j, block.k, i2, j2, k2) : pR->GetGamma2(i2, j2, k2, block.i, block.j, block.k));
   } // end r2
 }
 
@@ -797,13 +899,18 @@ void CKrigingAdmin::EstimateSizeOfBlock() {
   rangeZ_ = static_cast<float>(std::max(rangeAlphaZ_, rangeBetaZ_));
   rangeZ_ = static_cast<float>(std::max(static_cast<float>(rangeRhoZ_), rangeZ_));
 
-  LogKit::LogFormatted(LogKit::Low,"Estimated ranges(grid cells) from covariance cubes:\n");
-  LogKit::LogFormatted(LogKit::Low,"             rangeX     rangeY     rangeZ\n");
-  LogKit::LogFormatted(LogKit::Low,"-----------------------------------------\n");
-  LogKit::LogFormatted(LogKit::Low,"Vp   :     %8d   %8d   %8d\n", rangeAlphaX_, rangeAlphaY_, rangeAlphaZ_);
-  LogKit::LogFormatted(LogKit::Low,"Vs   :     %8d   %8d   %8d\n", rangeBetaX_, rangeBetaY_, rangeBetaZ_);
-  LogKit::LogFormatted(LogKit::Low,"Rho  :     %8d   %8d   %8d\n", rangeRhoX_, rangeRhoY_, rangeRhoZ_);
-  LogKit::LogFormatted(LogKit::Low,"Used :     %8.0f   %8.0f   %8.0f\n", rangeX_, rangeY_, rangeZ_);
+  // One call, so that tables from kriging of concurrent realisations are not mixed.
+  LogKit::LogFormatted(LogKit::Low,"Estimated ranges(grid cells) from covariance cubes:\n"
+                                   "             rangeX     rangeY     rangeZ\n"
+                                   "-----------------------------------------\n"
+                                   "Vp   :     %8d   %8d   %8d\n"
+                                   "Vs   :     %8d   %8d   %8d\n"
+                                   "Rho  :     %8d   %8d   %8d\n"
+                                   "Used :     %8.0f   %8.0f   %8.0f\n",
+                       rangeAlphaX_, rangeAlphaY_, rangeAlphaZ_,
+                       rangeBetaX_, rangeBetaY_, rangeBetaZ_,
+                       rangeRhoX_, rangeRhoY_, rangeRhoZ_,
+                       rangeX_, rangeY_, rangeZ_);
 
   if (noData_ <= dataTarget_) {
      dxBlock_ = simbox_.getnx();
@@ -1502,6 +1609,7 @@ void CKrigingAdmin::WriteDebugOutput2() const {
   LogKit::LogFormatted(LogKit::DebugHigh,"noEmptyDataBlocks_: %d\n", noEmptyDataBlocks_);
   LogKit::LogFormatted(LogKit::DebugHigh,"noKrigedVariables_: %d\n", noKrigedVariables_);
   LogKit::LogFormatted(LogKit::DebugHigh,"noCholeskyDecomp_: %d\n", noCholeskyDecomp_);
+  LogKit::LogFormatted(LogKit::DebugHigh,"noReusedSolutions_: %d\n", noReusedSolutions_);
   LogKit::LogFormatted(LogKit::DebugHigh,"noSolvedMatrixEq_: %d\n", noSolvedMatrixEq_);
   LogKit::LogFormatted(LogKit::DebugHigh,"noRMissing_: %d\n", noRMissing_);
 }
@@ -11,6 +11,9 @@ class CBWellPt;
 class Simbox;
 class CovGridSeparated;
 
+#include <list>
+#include <vector>
+
 #include "nrlib/flens/nrlib_flens.hpp"
 
 #include "src/box.h"
@@ -32,25 +35,62 @@ public:
   ~CKrigingAdmin(void);
   enum Gamma {ALPHA_KRIG, BETA_KRIG, RHO_KRIG};
   void KrigAll(FFTGrid& trendAlpha, FFTGrid& trendBeta, FFTGrid& trendRho, SeismicParametersHolder & seismicParameters,
-               bool trendsAlreadySubtracted = false, int debugFlag = 0, bool doSmoothing = false);
+               bool trendsAlreadySubtracted = false, int debugFlag = 0, bool doSmoothing = false, int nThreads = 1,
+               bool showProgress = true);
 
 private:
+  // Solution x = K^{-1}d of the kriging equations for one data neighbourhood.
+  // Blocks that find the same data reuse it instead of setting up and factorising K.
+  struct CachedSolution
+  {
+    Gamma               gamma;
+    std::vector<int>    indexAlpha, indexBeta, indexRho;         // the data neighbourhood
+    std::vector<double> x;
+  };
+
+  // Working variables for the kriging block being processed. Each thread has its own.
+  struct BlockState
+  {
+    CBox             currDataBox, currBlock;                     // current data neightbourhood and kriging area
+    int              i, j, k;                                    // current kriging indexes
+    std::vector<int> indexAlpha, indexBeta, indexRho;            // indexes into pBWellPt_
+    int              sizeAlpha, sizeBeta, sizeRho;               // current sizes
+    int              totalNoDataInCurrKrigBlock;                 // total number of data in current kriging block
+    std::list<CachedSolution> cache;                             // most recently used first
+    size_t           maxCacheSize;
+  };
+
+  // Statistics for one kriged variable. Counted per thread and summed.
+  struct KrigingStats
+  {
+    KrigingStats() : noEmptyDataBlocks(0), noCholeskyDecomp(0), noSolvedMatrixEq(0), noRMissing(0), noReusedSolutions(0) {}
+    void Add(const KrigingStats & s) { noEmptyDataBlocks += s.noEmptyDataBlocks; noCholeskyDecomp  += s.noCholeskyDecomp;
+                                       noSolvedMatrixEq  += s.noSolvedMatrixEq;  noRMissing        += s.noRMissing;
+                                       noReusedSolutions += s.noReusedSolutions; }
+    int              noEmptyDataBlocks, noCholeskyDecomp, noSolvedMatrixEq, noRMissing, noReusedSolutions;
+  };
+
   void            Init();
-  void            KrigAll(Gamma gamma, bool doSmoothing = false);
-  void            KrigBlock(Gamma gamma);
+  void            KrigAll(const std::vector<Gamma> & gammas, int nThreads, bool doSmoothing);
+  void            KrigBlock(Gamma gamma, BlockState & block, KrigingStats & stats);
+  void            UpdateProgress(int nCells);
+  bool            FindCachedSolution(Gamma gamma, BlockState & block, NRLib::Vector & x) const;
+  void            AddCachedSolution(Gamma gamma, BlockState & block, const NRLib::Vector & x) const;
   /* Finds the data by using the following rule: Cokriging 3 variables X,Y,Z.
   If you are doing kriging on X. Then for each well obs: if you have info on X use it and
   ignore the two others Y,Z. Else use info on Y and Z.
   */
   void            SubtractTrends(FFTGrid& trend_alpha, FFTGrid& trend_beta, FFTGrid& trend_rho);
-  void            FindDataInDataBlockLoop(Gamma gamma);
-  DataBoxSize     FindDataInDataBlock(Gamma gamma, const CBox & dataBlock);
+  void            FindDataInDataBlockLoop(Gamma gamma, BlockState & block) const;
+  DataBoxSize     FindDataInDataBlock(Gamma gamma, const CBox & dataBlock, BlockState & block) const;
   int             NBlocks(int dBlocks, int lSBox) const;
-  void            SetMatrix(NRLib::Matrix & krigMatrix,
-                            NRLib::Vector & residual,
-                            Gamma           gamma);
-  void            SetKrigVector(NRLib::Vector & k,
-                                Gamma           gamma);
+  void            SetMatrix(NRLib::Matrix    & krigMatrix,
+                            NRLib::Vector    & residual,
+                            Gamma              gamma,
+                            const BlockState & block) const;
+  void            SetKrigVector(NRLib::Vector    & k,
+                                Gamma              gamma,
+                                const BlockState & block) const;
   void            EstimateSizeOfBlock();
   void            EstimateSizeOfBlock2();
   float           CalcCPUTime(float dxBlock, float dyBlockExt, float& nd, bool& rapidInc);
@@ -75,12 +115,9 @@ private:
   CovGridSeparated &covAlpha_, &covBeta_, &covRho_, &covCrAlphaBeta_, &covCrAlphaRho_, &covCrBetaRho_;
   FFTGrid       * pBWellGrid_; // a "bool" grid that says "true" (1.0f), (or NOT -1.0f) if there is at least one blocked valid well data in the cell
   CBWellPt     ** pBWellPt_;
-  CBox            currDataBox_, currBlock_;                  // current data neightbourhood and kriging area
   int             dxBlock_, dyBlock_, dzBlock_;              // number of cells to define a kriging block
   int             dxBlockExt_, dyBlockExt_, dzBlockExt_;     // number of additional cells to reach data neighbourhood
-  int             i_, j_, k_;                                // current kriging indexes
-  int           * pIndexAlpha_, *pIndexBeta_, *pIndexRho_;  // holds an array of indexes into pBWells_
-  int             sizeAlpha_, sizeBeta_, sizeRho_;           // current sizes
+  int             maxAlphaData_, maxBetaData_, maxRhoData_; // max number of a, b og r data in a data neighbourhood
   int             noValidAlpha_, noValidBeta_, noValidRho_;  // number of valid a, b og r data
   int             noValid_;                                  // total number of valid data
   int             noData_;                                   // number kriging data (blocks)
@@ -89,7 +126,9 @@ private:
   int             noEmptyDataBlocks_;                        // number of empty datablocks
   int             noKrigedVariables_;                        // number of kriged variables so far
   int             noCholeskyDecomp_;                         // number of cholesky decompositions
+  int             noReusedSolutions_;                        // number of blocks reusing the solution of another block
   int             monitorSize_;                              // for progress monitor
+  bool            showProgress_;                             // draw progress monitor
 
   int             rangeAlphaX_, rangeAlphaY_, rangeAlphaZ_;
   int             rangeBetaX_, rangeBetaY_, rangeBetaZ_;
@@ -100,7 +139,6 @@ private:
                     maxCholeskyLoopCounter_   = 20,          // max number of attempts to cholesky decomposition
                     switchFailed_             =  1};         // assert flag
 
-  int             totalNoDataInCurrKrigBlock_;               // total number of data in current kriging block
   int             noSolvedMatrixEq_;                         // total number of times we have actually solved the matrix eq, for debug
   int              noRMissing_;                               // total number of times we have missing real values
   bool            failed2EstimateRange_, failed2EstimateDefaultDataBoxAndBlock_;             // bool flags if we failed 2 estimate true
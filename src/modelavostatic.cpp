@@ -52,8 +52,11 @@ ModelAVOStatic::ModelAVOStatic(ModelSettings        *& model_settings,
     //
     // INVERSION/ESTIMATION
     //
-    CheckAvailableMemory(simbox, model_settings, input_files);
     bool estimationMode = model_settings->getEstimationMode();
+    int  n_parallel     = 1;
+    if (estimationMode == false)
+      n_parallel = std::min(model_settings->getNumberOfParallelIntervals(), common_data->GetMultipleIntervalGrid()->GetNIntervals());
+    CheckAvailableMemory(simbox, model_settings, input_files, n_parallel);
     if (estimationMode == false)
       facies_estim_interval_ = common_data->GetFaciesEstimInterval(); //Read in in CommonData under SetupPriorFaciesProb based on estimation_simbox. Should this have been per interval?
 
@@ -80,7 +83,7 @@ ModelAVOStatic::ModelAVOStatic(ModelSettings        *& model_settings,
     err_corr_->fillInErrCorr(common_data->GetPriorCorrXY(i_interval), corr_grad_I, corr_grad_J);
   }
   else // forward modeling
-    CheckAvailableMemory(simbox, model_settings, input_files);
+    CheckAvailableMemory(simbox, model_settings, input_files, 1);
 }
 
 ModelAVOStatic::~ModelAVOStatic(void)
@@ -96,7 +99,8 @@ ModelAVOStatic::~ModelAVOStatic(void)
 void
 ModelAVOStatic::CheckAvailableMemory(const Simbox     * time_simbox,
                                      ModelSettings    * model_settings,
-                                     const InputFiles * input_files)
+                                     const InputFiles * input_files,
+                                     int                n_parallel_intervals)
 {
   LogKit::WriteHeader("Estimating amount of memory needed");
   //
@@ -214,6 +218,14 @@ ModelAVOStatic::CheckAvailableMemory(const Simbox     * time_simbox,
       grid_mem = peak_grid_mem;
     }
   }
+  //
+  // Intervals that are inverted at the same time each need their own grids.
+  //
+  if (n_parallel_intervals > 1) {
+    LogKit::LogFormatted(LogKit::Low,"\nMemory is estimated for %d intervals inverted in parallel.\n",n_parallel_intervals);
+    n_grids  *= n_parallel_intervals;
+    grid_mem *= n_parallel_intervals;
+  }
   FFTGrid::setMaxAllowedGrids(n_grids);
   //if (model_settings->getDebugFlag()>0)
   //    FFTGrid::setTerminateOnMaxGrid(true); NBNB Ragnar: Temporary until count is ok.
@@ -50,7 +50,8 @@ private:
 
   void             CheckAvailableMemory(const Simbox              * time_simbox,
                                         ModelSettings       * model_settings,
-                                        const InputFiles    * input_files);
+                                        const InputFiles    * input_files,
+                                        int                   n_parallel_intervals);
 
   bool                      forward_modeling_;
 
@@ -162,6 +162,8 @@ ModelSettings::ModelSettings(void)
   otherFlag_               =        0;
   debugFlag_               =        0;
   fileGrid_                =    false;
+  compressTmpGrids_        =    false;
+  tmpGridMaxRelError_      =     0.0f;
   waveletFormatManual_     =    false;
   useVerticalVariogram_    =    false;
   do4DInversion_           =    false;
@@ -192,6 +194,8 @@ ModelSettings::ModelSettings(void)
   snapGridToSeismicData_   =    false;
   wellGradientFromSeismic_ =    false;
   writeAsciiSurfaces_      =    false;
+  fftWisdomFile_           =    "";
+  useSegyTraceIndex_       =    false;
 
   priorFaciesProbGiven_    = ModelSettings::FACIES_FROM_WELLS;
 
@@ -210,6 +214,7 @@ ModelSettings::ModelSettings(void)
 
   seed_                    =        0;
   number_of_threads_       =        0;
+  number_of_parallel_intervals_ =   1;
 
   erosion_priority_top_surface_ = 1;
 
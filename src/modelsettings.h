@@ -43,6 +43,7 @@ public:
   TraceHeaderFormat              * getTraceHeaderFormatBackground(int i)const { return traceHeaderFormatBackground_[i]            ;}
   TraceHeaderFormat              * getTraceHeaderFormat(int i, int j)   const { return timeLapseLocalTHF_[i][j]                   ;}
   int                              getNumberOfThreads(void)             const { return number_of_threads_                         ;}
+  int                              getNumberOfParallelIntervals(void)   const { return number_of_parallel_intervals_              ;}
   int                              getNumberOfTraceHeaderFormats(int i) const { return static_cast<int>(timeLapseLocalTHF_[i].size());}
   int                              getKrigingParameter(void)            const { return krigingParameter_                          ;}
   float                            getConstBackValue(int i)             const { return constBackValue_[i]                         ;}
@@ -184,6 +185,8 @@ public:
   int                              getDebugFlag(void)                   const { return debugFlag_                                 ;}
   static int                       getDebugLevel(void)                        { return debugFlag_                                 ;}
   bool                             getFileGrid(void)                    const { return fileGrid_                                  ;}
+  bool                             getCompressTmpGrids(void)            const { return compressTmpGrids_                          ;}
+  float                            getTmpGridMaxRelError(void)          const { return tmpGridMaxRelError_                        ;}
   bool                             getEstimationMode(void)              const { return estimationMode_                            ;}
   bool                             getForwardModeling(void)             const { return forwardModeling_                           ;}
   bool                             getGenerateSeismicAfterInv(void)     const { return generateSeismicAfterInv_                   ;}
@@ -214,6 +217,8 @@ public:
   double                           getGradientSmoothingRange(void)      const { return gradientSmoothingRange_                    ;}
   bool                             getEstimateWellGradientFromSeismic() const { return wellGradientFromSeismic_                   ;}
   bool                             getWriteAsciiSurfaces(void)          const { return writeAsciiSurfaces_                        ;}
+  const std::string              & getFFTWisdomFile(void)               const { return fftWisdomFile_                             ;}
+  bool                             getUseSegyTraceIndex(void)           const { return useSegyTraceIndex_                         ;}
   int                              getLogLevel(void)                    const { return logLevel_                                  ;}
   bool                             getErrorFileFlag()                   const { return ((otherFlag_ & IO::ERROR_FILE)>0)          ;}
   bool                             getTaskFileFlag()                    const { return ((otherFlag_ & IO::TASK_FILE)>0)           ;}
@@ -350,6 +355,7 @@ public:
   void addWellRelativeCoord(bool relative)                { wellRelativeCoord_.push_back(relative)               ;}
 
   void setNumberOfThreads(int n_threads)                  { number_of_threads_        = n_threads                ;}
+  void setNumberOfParallelIntervals(int n_intervals)      { number_of_parallel_intervals_ = n_intervals          ;}
   void setNumberOfWells(int nWells)                       { nWells_                   = nWells                   ;}
   void setNumberOfSimulations(int nSimulations)           { nSimulations_             = nSimulations             ;}
   void setVpMin(float vp_min)                             { vp_min_                   = vp_min                   ;}
@@ -430,6 +436,8 @@ public:
   void setOtherOutputFlag(int otherFlag)                  { otherFlag_                = otherFlag                ;}
   void setDebugFlag(int debugFlag)                        { debugFlag_                = debugFlag                ;}
   void setFileGrid(bool fileGrid)                         { fileGrid_                 = fileGrid                 ;}
+  void setCompressTmpGrids(bool compress)                 { compressTmpGrids_         = compress                 ;}
+  void setTmpGridMaxRelError(float maxRelError)           { tmpGridMaxRelError_       = maxRelError              ;}
   void setEstimationMode(bool estimationMode)             { estimationMode_           = estimationMode           ;}
   void setForwardModeling(bool forwardModeling)           { forwardModeling_          = forwardModeling          ;}
   void setGenerateSeismicAfterInv( bool generateSeismic)  { generateSeismicAfterInv_  = generateSeismic          ;}
@@ -547,6 +555,8 @@ public:
   void setGradientSmoothingRange(double smoothingRange)   { gradientSmoothingRange_   = smoothingRange           ;}
   void setEstimateWellGradientFromSeismic(bool estimate)  { wellGradientFromSeismic_  = estimate                 ;}
   void setWriteAsciiSurfaces(bool write_ascii)            { writeAsciiSurfaces_       = write_ascii              ;}
+  void setFFTWisdomFile(const std::string & fileName)     { fftWisdomFile_            = fileName                 ;}
+  void setUseSegyTraceIndex(bool useIndex)                { useSegyTraceIndex_        = useIndex                 ;}
 
   void MakeSureDzIsSetIfNeeded(InputFiles & input_files,
                                std::string & err_txt);
@@ -711,6 +721,7 @@ private:
   std::map<std::string, std::map<std::string, float> > volumeFraction_;  ///< map interval map facies name
 
   int                               number_of_threads_;
+  int                               number_of_parallel_intervals_; ///< Maximum number of intervals inverted at the same time
   int                               nWells_;
   int                               nSimulations_;
 
@@ -807,6 +818,8 @@ private:
   int                               waveletFormatFlag_;          ///< Decides wavelet output format
   int                               otherFlag_;                  ///< Decides output beyond grids and wells.
   bool                              fileGrid_;                   ///< Indicator telling if grids are to be kept on file
+  bool                              compressTmpGrids_;           ///< Compress grids kept on file
+  float                             tmpGridMaxRelError_;         ///< Allowed relative error when compressing grids kept on file. Lossless if zero.
   bool                              outputGridsDefault_;         ///< Indicator telling if grid output has been actively controlled
   bool                              waveletFormatManual_;        ///< True if wavelet format is decided in the model file
   bool                              useVerticalVariogram_;       ///< True if a vertical variogram is used to estimate temporal correlation
@@ -843,6 +856,8 @@ private:
   float                             seismicQualityGridRange_;    ///< Radius value from well-points where wells are used in Seismic Quality Grids
   float                             seismicQualityGridValue_;    ///< Value between wells if range is used.
   bool                              writeAsciiSurfaces_;         ///< If true, ascii format will be added when surfaces are written
+  std::string                       fftWisdomFile_;              ///< File for storing measured FFT plans between runs. Empty if not used.
+  bool                              useSegyTraceIndex_;          ///< Keep SegY geometry and trace positions in index files between runs
 
   std::map<std::string, bool>       topConformCorrelation_;      ///< Should top correlation direction be equal to the top inversion surface per interval
   std::map<std::string, bool>       baseConformCorrelation_;     ///< Should base correlation direction be equal to the base inversion surface per interval
@@ -11,6 +11,7 @@
 #include "src/io.h"
 #include "lib/utils.h"
 #include "fft/include/fftw.h"
+#include "fft/include/rfftw.h"
 
 void
 ParameterOutput::WriteParameters(const Simbox        * simbox,
@@ -25,7 +26,6 @@ ParameterOutput::WriteParameters(const Simbox        * simbox,
 {
   std::string prefix;
   std::string suffix;
-  std::string file_name;
 
   if(sim_num >= 0) {
     prefix = IO::PrefixSimulations();
@@ -39,339 +39,165 @@ ParameterOutput::WriteParameters(const Simbox        * simbox,
   if(kriged)
     suffix = "_Kriged"+suffix;
 
-  if((output_flag & IO::MURHO) > 0) {
-    file_name = prefix+"MuRho"+suffix;
-    ComputeMuRho(simbox, time_depth_mapping, model_settings, vp, vs, rho, file_name);
+  int n_threads = std::max(model_settings->getNumberOfThreads(), 1);
+
+  //Derived parameters are computed from vp, vs and rho on log scale, so they are all
+  //written before the grids themselves are transformed. Up to n_threads parameters are
+  //computed in one pass over vp, vs and rho, and then written at once.
+  //
+  //Each parameter in a batch needs its own unpadded grid, and a resampled grid if it
+  //is written in depth. Larger batches write faster but need more memory. The memory
+  //estimate in ModelAVOStatic::CheckAvailableMemory() allows for one padded computation
+  //grid here, so a batch holds as many parameters as fit in one padded grid, and at
+  //most n_threads. When grids are stored on file, memory is known to be tight, and the
+  //parameters are computed and written one at a time.
+  const int all_derived[8] = {IO::MURHO, IO::LAMBDARHO, IO::LAMELAMBDA, IO::LAMEMU,
+                              IO::POISSONRATIO, IO::AI, IO::SI, IO::VPVSRATIO};
+  std::vector<int> derived;
+  for(int d = 0 ; d < 8 ; d++) {
+    if((output_flag & all_derived[d]) > 0)
+      derived.push_back(all_derived[d]);
   }
-  if((output_flag & IO::LAMBDARHO) > 0) {
-    file_name = prefix+"LambdaRho"+suffix;
-    ComputeLambdaRho(simbox, time_depth_mapping, model_settings, vp, vs, rho, file_name);
-  }
-  if((output_flag & IO::LAMELAMBDA) > 0) {
-    file_name = prefix+"LameLambda"+suffix;
-    ComputeLameLambda(simbox, time_depth_mapping, model_settings, vp, vs, rho, file_name);
-  }
-  if((output_flag & IO::LAMEMU) > 0) {
-    file_name = prefix+"LameMu"+suffix;
-    ComputeLameMu(simbox, time_depth_mapping,  model_settings, vs, rho, file_name);
-  }
-  if((output_flag & IO::POISSONRATIO) > 0) {
-    file_name = prefix+"PoissonRatio"+suffix;
-    ComputePoissonRatio(simbox, time_depth_mapping, model_settings, vp, vs, file_name);
-  }
-  if((output_flag & IO::AI) > 0) {
-    file_name = prefix+"AI"+suffix;
-    ComputeAcousticImpedance(simbox, time_depth_mapping, model_settings, vp, rho, file_name);
-  }
-  if((output_flag & IO::SI) > 0) {
-    file_name = prefix+"SI"+suffix;
-    ComputeShearImpedance(simbox, time_depth_mapping, model_settings, vs, rho, file_name);
-  }
-  if((output_flag & IO::VPVSRATIO) > 0) {
-    file_name = prefix+"VpVsRatio"+suffix;
-    ComputeVpVsRatio(simbox, time_depth_mapping, model_settings, vp, vs, file_name);
-  }
-  if((output_flag & IO::VP) > 0) {
-    file_name = prefix+"Vp"+suffix;
-
-    ExpTransf(vp);
-    WriteToFile(simbox, time_depth_mapping, model_settings, vp, file_name, "Inverted Vp");
-    //if (sim_num < 0) //prediction, need grid unharmed.
-    //  vp->logTransf();
-
-  }
-  if((output_flag & IO::VS) > 0) {
-    file_name = prefix+"Vs"+suffix;
-
-    ExpTransf(vs);
-    WriteToFile(simbox, time_depth_mapping, model_settings, vs, file_name, "Inverted Vs");
-    //if (sim_num < 0) //prediction, need grid unharmed.
-    //  vs->logTransf();
-
-  }
-  if((output_flag & IO::RHO) > 0) {
-    file_name = prefix+"Rho"+suffix;
-
-    ExpTransf(rho);
-    WriteToFile(simbox, time_depth_mapping, model_settings, rho, file_name, "Inverted density");
-    //if (sim_num < 0) //prediction, need grid unharmed.
-    //  rho->logTransf();
 
+  size_t max_batch = 1;
+  if(model_settings->getFileGrid() == false) {
+    size_t padded_size    = static_cast<size_t>(2*(simbox->GetNXpad()/2+1))*simbox->GetNYpad()*simbox->GetNZpad();
+    size_t parameter_size = vp->GetNI()*vp->GetNJ()*vp->GetNK();
+    bool   in_depth       = (time_depth_mapping != NULL && time_depth_mapping->getMapping() != NULL &&
+                             (model_settings->getOutputGridDomain() & IO::DEPTHDOMAIN) > 0);
+    if(in_depth)
+      parameter_size += time_depth_mapping->getMapping()->GetN();
+    max_batch = std::max(padded_size/std::max(parameter_size, static_cast<size_t>(1)), static_cast<size_t>(1));
+    max_batch = std::min(max_batch, static_cast<size_t>(n_threads));
   }
-}
-
-void
-ParameterOutput::ComputeAcousticImpedance(const Simbox        * simbox,
-                                          GridMapping         * time_depth_mapping,
-                                          const ModelSettings * model_settings,
-                                          StormContGrid       * vp,
-                                          StormContGrid       * rho,
-                                          const std::string   & file_name)
-{
-  StormContGrid * pr_impedance = new StormContGrid(*vp);
-
-  float ijk_a    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
 
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
+  for(size_t first = 0 ; first < derived.size() ; first += max_batch) {
+    size_t           last = std::min(first + max_batch, derived.size());
+    std::vector<int> parameters(derived.begin() + first, derived.begin() + last);
 
-        ijk_a    = vp->GetValue(i, j, k);
-        ijk_r    = rho->GetValue(i, j, k);
-        comp_val = exp(ijk_a + ijk_r);
-
-        pr_impedance->SetValue(i, j, k, comp_val);
-
-      }
+    std::vector<StormContGrid *> grids(parameters.size());
+    for(size_t p = 0 ; p < parameters.size() ; p++) {
+      grids[p] = new StormContGrid(*vp, vp->GetNI(), vp->GetNJ(), vp->GetNK());
+      grids[p]->SetMissingCode(vp->GetMissingCode());
     }
-  }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, pr_impedance, file_name, "Acoustic Impedance");
-
-  delete pr_impedance;
-}
-
-
-void
-ParameterOutput::ComputeShearImpedance(const Simbox        * simbox,
-                                       GridMapping         * time_depth_mapping,
-                                       const ModelSettings * model_settings,
-                                       StormContGrid       * vs,
-                                       StormContGrid       * rho,
-                                       const std::string   & file_name)
-{
-  StormContGrid * sh_impedance = new StormContGrid(*vs);
-
-  float ijk_b    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
 
-  for (size_t i = 0; i < vs->GetNI(); i++) {
-    for (size_t j = 0; j < vs->GetNJ(); j++) {
-      for (size_t k = 0; k < vs->GetNK(); k++) {
+    ComputeDerivedParameters(vp, vs, rho, parameters, grids, n_threads);
 
-        ijk_b    = vs->GetValue(i, j, k);
-        ijk_r    = rho->GetValue(i, j, k);
-        comp_val = exp(ijk_b + ijk_r);
-
-        sh_impedance->SetValue(i, j, k, comp_val);
-
-      }
+    std::vector<OutputGrid> output;
+    for(size_t p = 0 ; p < parameters.size() ; p++) {
+      std::string name;
+      std::string label;
+      FindDerivedParameterName(parameters[p], name, label);
+      output.push_back(OutputGrid(grids[p], prefix+name+suffix, IO::PathToInversionResults(), false, label, time_depth_mapping));
     }
-  }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, sh_impedance, file_name, "Shear impedance");
+    WriteFiles(model_settings, simbox, output);
 
-  delete sh_impedance;
-}
-
-
-void
-ParameterOutput::ComputeVpVsRatio(const Simbox        * simbox,
-                                  GridMapping         * time_depth_mapping,
-                                  const ModelSettings * model_settings,
-                                  StormContGrid       * vp,
-                                  StormContGrid       * vs,
-                                  const std::string   & file_name)
-{
-  StormContGrid * ratio_vp_vs = new StormContGrid(*vp);
-
-  float ijk_a    = 0.0f;
-  float ijk_b    = 0.0f;
-  float comp_val = 0.0f;
-
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
-
-        ijk_a    = vp->GetValue(i, j, k);
-        ijk_b    = vs->GetValue(i, j, k);
-        comp_val = exp(ijk_a - ijk_b);
-
-        ratio_vp_vs->SetValue(i, j, k, comp_val);
-
-      }
-    }
+    for(size_t p = 0 ; p < grids.size() ; p++)
+      delete grids[p];
   }
 
-  WriteToFile(simbox, time_depth_mapping, model_settings, ratio_vp_vs, file_name, "Vp-Vs ratio");
-
-  delete ratio_vp_vs;
-}
-
-void
-ParameterOutput::ComputePoissonRatio(const Simbox        * simbox,
-                                     GridMapping         * time_depth_mapping,
-                                     const ModelSettings * model_settings,
-                                     StormContGrid       * vp,
-                                     StormContGrid       * vs,
-                                     const std::string   & file_name)
-{
-  StormContGrid * poi_rat = new StormContGrid(*vp);
-
-  float ijk_a      = 0.0f;
-  float ijk_b      = 0.0f;
-  float comp_val   = 0.0f;
-  float v_ratio_sq = 0.0f;
-
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
-
-        ijk_a      = vp->GetValue(i, j, k);
-        ijk_b      = vs->GetValue(i, j, k);
-        v_ratio_sq = exp(2*(ijk_a-ijk_b));
-        comp_val   = static_cast<float>(0.5*(v_ratio_sq - 2)/(v_ratio_sq - 1));
-
-        poi_rat->SetValue(i, j, k, comp_val);
-
-      }
-    }
+  std::vector<OutputGrid> output;
+  if((output_flag & IO::VP) > 0) {
+    ExpTransf(vp, n_threads);
+    output.push_back(OutputGrid(vp, prefix+"Vp"+suffix, IO::PathToInversionResults(), false, "Inverted Vp", time_depth_mapping));
   }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, poi_rat, file_name, "Poisson ratio");
-
-  delete poi_rat;
-}
-
-void
-ParameterOutput::ComputeLameMu(const Simbox        * simbox,
-                               GridMapping         * time_depth_mapping,
-                               const ModelSettings * model_settings,
-                               StormContGrid       * vs,
-                               StormContGrid       * rho,
-                               const std::string   & file_name)
-{
-  StormContGrid * mu = new StormContGrid(*vs);
-
-  float ijk_b    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
-
-  for (size_t i = 0; i < vs->GetNI(); i++) {
-    for (size_t j = 0; j < vs->GetNJ(); j++) {
-      for (size_t k = 0; k < vs->GetNK(); k++) {
-
-        ijk_b    = vs->GetValue(i, j, k);
-        ijk_r    = rho->GetValue(i, j, k);
-        comp_val = static_cast<float>(exp(ijk_r+2*ijk_b-13.81551)); // -13.81551 in the exponent divides by 1 000 000
-
-        mu->SetValue(i, j, k, comp_val);
-
-      }
-    }
+  if((output_flag & IO::VS) > 0) {
+    ExpTransf(vs, n_threads);
+    output.push_back(OutputGrid(vs, prefix+"Vs"+suffix, IO::PathToInversionResults(), false, "Inverted Vs", time_depth_mapping));
   }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, mu, file_name, "Lame mu");
-
-  delete mu;
-}
-
-void
-ParameterOutput::ComputeLameLambda(const Simbox        * simbox,
-                                   GridMapping         * time_depth_mapping,
-                                   const ModelSettings * model_settings,
-                                   StormContGrid       * vp,
-                                   StormContGrid       * vs,
-                                   StormContGrid       * rho,
-                                   const std::string   & file_name)
-{
-  StormContGrid * lambda = new StormContGrid(*vp);
-
-  float ijk_a    = 0.0f;
-  float ijk_b    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
-
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
-
-        ijk_a    = vp->GetValue(i, j, k);
-        ijk_b    = vs->GetValue(i, j, k);
-        ijk_r    = rho->GetValue(i, j, k);
-        comp_val = static_cast<float>(exp(ijk_r)*(exp(2*ijk_a-13.81551)-2*exp(2*ijk_b-13.81551))); // -13.81551 in the exponent divides by 1 000 000
-
-        lambda->SetValue(i, j, k, comp_val);
-      }
-    }
+  if((output_flag & IO::RHO) > 0) {
+    ExpTransf(rho, n_threads);
+    output.push_back(OutputGrid(rho, prefix+"Rho"+suffix, IO::PathToInversionResults(), false, "Inverted density", time_depth_mapping));
   }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, lambda, file_name, "Lame lambda");
-
-  delete lambda;
+  WriteFiles(model_settings, simbox, output);
 }
 
 void
-ParameterOutput::ComputeLambdaRho(const Simbox        * simbox,
-                                  GridMapping         * time_depth_mapping,
-                                  const ModelSettings * model_settings,
-                                  StormContGrid       * vp,
-                                  StormContGrid       * vs,
-                                  StormContGrid       * rho,
-                                  const std::string   & file_name)
+ParameterOutput::FindDerivedParameterName(int           parameter,
+                                          std::string & name,
+                                          std::string & label)
 {
-  StormContGrid * lambda_rho = new StormContGrid(*vp);
-
-  float ijk_a    = 0.0f;
-  float ijk_b    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
-
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
-
-        ijk_a    = vp->GetValue(i, j, k);
-        ijk_b    = vs->GetValue(i, j, k);
-        ijk_r    = rho->GetValue(i, j, k);
-        comp_val = static_cast<float>(exp(2.0*(ijk_a +ijk_r)-13.81551)-2.0*exp(2.0*(ijk_b +ijk_r)-13.81551)); // -13.81551 in the exponent divides by 1e6=(1 000 000)
-
-        lambda_rho->SetValue(i, j, k, comp_val);
-
-      }
-    }
+  switch(parameter) {
+  case IO::MURHO        : name = "MuRho";        label = "Mu rho";             break;
+  case IO::LAMBDARHO    : name = "LambdaRho";    label = "Lambda rho";         break;
+  case IO::LAMELAMBDA   : name = "LameLambda";   label = "Lame lambda";        break;
+  case IO::LAMEMU       : name = "LameMu";       label = "Lame mu";            break;
+  case IO::POISSONRATIO : name = "PoissonRatio"; label = "Poisson ratio";      break;
+  case IO::AI           : name = "AI";           label = "Acoustic Impedance"; break;
+  case IO::SI           : name = "SI";           label = "Shear impedance";    break;
+  case IO::VPVSRATIO    : name = "VpVsRatio";    label = "Vp-Vs ratio";        break;
+  default:
+    assert(false);
   }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, lambda_rho, file_name, "Lambda rho");
-
-  delete lambda_rho;
 }
 
 void
-ParameterOutput::ComputeMuRho(const Simbox        * simbox,
-                              GridMapping         * time_depth_mapping,
-                              const ModelSettings * model_settings,
-                              StormContGrid       * vp,
-                              StormContGrid       * vs,
-                              StormContGrid       * rho,
-                              const std::string   & file_name)
+ParameterOutput::ComputeDerivedParameters(const StormContGrid                * vp,
+                                          const StormContGrid                * vs,
+                                          const StormContGrid                * rho,
+                                          const std::vector<int>             & parameters,
+                                          const std::vector<StormContGrid *> & grids,
+                                          int                                  n_threads)
 {
-  StormContGrid * mu_rho;
-  mu_rho = new StormContGrid(*vp);
-
-  float ijk_b    = 0.0f;
-  float ijk_r    = 0.0f;
-  float comp_val = 0.0f;
-  for (size_t i = 0; i < vp->GetNI(); i++) {
-    for (size_t j = 0; j < vp->GetNJ(); j++) {
-      for (size_t k = 0; k < vp->GetNK(); k++) {
-
-        ijk_b    = vs->GetValue(i,j,k);
-        ijk_r    = rho->GetValue(i,j,k);
-        comp_val = static_cast<float>(exp(2.0*(ijk_b +ijk_r)-13.81551)); // -13.81551 in the exponent divides by 1e6=(1 000 000)
-
-        mu_rho->SetValue(i,j,k, comp_val);
-
+  int    nk         = static_cast<int>(vp->GetNK());
+  size_t layer_size = vp->GetNI()*vp->GetNJ();
+  int    n_par      = static_cast<int>(parameters.size());
+
+  //Layers of vp, vs and rho are read once and stay in cache while every parameter
+  //is computed. The formulas are those of the original one-parameter functions.
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(n_threads)
+#endif
+  for(int k = 0 ; k < nk ; k++) {
+    size_t        offset = k*layer_size;
+    const float * a      = &(*vp)(offset);
+    const float * b      = &(*vs)(offset);
+    const float * r      = &(*rho)(offset);
+
+    for(int p = 0 ; p < n_par ; p++) {
+      float * value = &(*grids[p])(offset);
+
+      switch(parameters[p]) {
+      case IO::AI:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = exp(a[l] + r[l]);
+        break;
+      case IO::SI:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = exp(b[l] + r[l]);
+        break;
+      case IO::VPVSRATIO:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = exp(a[l] - b[l]);
+        break;
+      case IO::POISSONRATIO:
+        for(size_t l = 0 ; l < layer_size ; l++) {
+          float v_ratio_sq = exp(2*(a[l]-b[l]));
+          value[l] = static_cast<float>(0.5*(v_ratio_sq - 2)/(v_ratio_sq - 1));
+        }
+        break;
+      case IO::LAMEMU: // -13.81551 in the exponent divides by 1 000 000
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = static_cast<float>(exp(r[l]+2*b[l]-13.81551));
+        break;
+      case IO::LAMELAMBDA:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = static_cast<float>(exp(r[l])*(exp(2*a[l]-13.81551)-2*exp(2*b[l]-13.81551)));
+        break;
+      case IO::LAMBDARHO:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = static_cast<float>(exp(2.0*(a[l]+r[l])-13.81551)-2.0*exp(2.0*(b[l]+r[l])-13.81551));
+        break;
+      case IO::MURHO:
+        for(size_t l = 0 ; l < layer_size ; l++)
+          value[l] = static_cast<float>(exp(2.0*(b[l]+r[l])-13.81551));
+        break;
       }
     }
   }
-
-  WriteToFile(simbox, time_depth_mapping, model_settings, mu_rho, file_name, "Mu rho");
-
-  delete mu_rho;
+#ifndef PARALLEL
+  (void) n_threads;
+#endif
 }
 
 void
@@ -381,7 +207,8 @@ ParameterOutput::WriteToFile(const Simbox        * simbox,
                              StormContGrid       * grid,
                              const std::string   & file_name,
                              const std::string   & sgri_label,
-                             bool                  padding)
+                             bool                  padding,
+                             int                   n_threads)
 {
   WriteFile(model_settings,
             grid,
@@ -391,27 +218,31 @@ ParameterOutput::WriteToFile(const Simbox        * simbox,
             false,
             sgri_label,
             time_depth_mapping,
-            padding);
+            padding,
+            0,
+            n_threads);
 }
 
 void
-ParameterOutput::ExpTransf(StormContGrid * grid)
+ParameterOutput::ExpTransf(StormContGrid * grid,
+                           int             n_threads)
 {
-  float value = 0.0f;
-  for (size_t i = 0; i < grid->GetNI(); i++) {
-    for (size_t j = 0; j < grid->GetNJ(); j++) {
-      for (size_t k = 0; k < grid->GetNK(); k++) {
-
-        value = grid->GetValue(i, j, k);
-
-        if (value != RMISSING) {
-          value = exp(value);
-          grid->SetValue(i, j, k, value);
-        }
-
-      }
+  int    nk         = static_cast<int>(grid->GetNK());
+  size_t layer_size = grid->GetNI()*grid->GetNJ();
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(static) num_threads(n_threads)
+#endif
+  for (int k = 0; k < nk; k++) {
+    float * value = &(*grid)(k*layer_size);
+    for (size_t l = 0; l < layer_size; l++) {
+      if (value[l] != RMISSING)
+        value[l] = exp(value[l]);
     }
   }
+#ifndef PARALLEL
+  (void) n_threads;
+#endif
 }
 
 void
@@ -424,7 +255,8 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
                            const std::string     label,
                            const GridMapping   * depth_map,
                            bool                  padding,
-                           double                offset)
+                           double                offset,
+                           int                   n_threads)
 {
   //All crava files are written out directly in CravaResult
   (void) padding;
@@ -449,18 +281,16 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
         const std::string header = simbox->getStormHeader(1, simbox->getnx(), simbox->getny(), simbox->getnz(), false, false);
         output->SetFormat(NRLib::StormContGrid::STORM_BINARY);
         std::string file_name_storm = file_name + IO::SuffixStormBinary();
-        LogKit::LogFormatted(LogKit::Low," Writing STORM file "+file_name_storm+"...");
         output->WriteToFile(file_name_storm, header, false);
-        LogKit::LogFormatted(LogKit::Low,"done\n");
+        LogKit::LogFormatted(LogKit::Low," Writing STORM file "+file_name_storm+"...done\n");
       }
 
       if ((format_flag & IO::ASCII) > 0) {
         output->SetFormat(NRLib::StormContGrid::STORM_ASCII);
         const std::string header = simbox->getStormHeader(1, simbox->getnx(), simbox->getny(), simbox->getnz(), false, true);
         std::string file_name_ascii = file_name + IO::SuffixGeneralData();
-        LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+file_name_ascii+"...");
         output->WriteToFile(file_name_ascii, header, true);
-        LogKit::LogFormatted(LogKit::Low,"done\n");
+        LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+file_name_ascii+"...done\n");
       }
 
       //SEGY, SGRI CRAVA are never resampled in time.
@@ -468,7 +298,6 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
         const TraceHeaderFormat * thf = model_settings->getTraceHeaderFormatOutput();
         float z0 = model_settings->getOutputOffset();
         std::string file_name_segy = file_name + IO::SuffixSegy();
-        LogKit::LogFormatted(LogKit::Low," Writing SEGY file "+file_name_segy+"...");
 
         //Take nz from segy if output_dz = segy_dz, otherwise a nz is calculated
         float output_dz = 0.0;
@@ -489,9 +318,10 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
                                true, //Write to file
                                *thf,
                                is_seismic,
-                               offset);
+                               offset,
+                               n_threads);
 
-        LogKit::LogFormatted(LogKit::Low,"done\n");
+        LogKit::LogFormatted(LogKit::Low," Writing SEGY file "+file_name_segy+"...done\n");
 
         delete segy;
       }
@@ -499,9 +329,8 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
         std::string file_name_sgri   = file_name + IO::SuffixSgri();
         std::string file_name_header = file_name + IO::SuffixSgriHeader();
 
-        LogKit::LogFormatted(LogKit::Low," Writing SGRI header file "+ file_name_header + "...");
         output->WriteToSgriFile(file_name_sgri, file_name_header, label, simbox->getdz());
-        LogKit::LogFormatted(LogKit::Low,"done\n");
+        LogKit::LogFormatted(LogKit::Low," Writing SGRI header file "+ file_name_header + "...done\n");
 
       }
     }
@@ -522,9 +351,8 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
           int ny = static_cast<int>(output->GetNJ());
           int nz = static_cast<int>(output->GetNK());
           std::string header = depth_map->getSimbox()->getStormHeader(FFTGrid::PARAMETER, nx, ny, nz, false, false);
-          LogKit::LogFormatted(LogKit::Low," Writing STORM file "+file_name_storm+"...");
           output->WriteToFile(file_name_storm, header, false);
-          LogKit::LogFormatted(LogKit::Low,"done\n");
+          LogKit::LogFormatted(LogKit::Low," Writing STORM file "+file_name_storm+"...done\n");
         }
         if ((format_flag & IO::ASCII) > 0) {
           output->SetFormat(NRLib::StormContGrid::STORM_ASCII);
@@ -532,10 +360,9 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
           int nx = static_cast<int>(output->GetNI());
           int ny = static_cast<int>(output->GetNJ());
           int nz = static_cast<int>(output->GetNK());
-          LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+file_name_ascii+"...");
           std::string header = depth_map->getSimbox()->getStormHeader(FFTGrid::PARAMETER, nx, ny, nz, false, true);
           output->WriteToFile(file_name_ascii, header, true);
-          LogKit::LogFormatted(LogKit::Low,"done\n");
+          LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+file_name_ascii+"...done\n");
         }
         /* Not supposed to be part of CRAVA.
         if ((format_flag & IO::SEGY) >0) {
@@ -574,7 +401,7 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
         }
         // Writes also segy in depth if required
         float z0 = model_settings->getOutputOffset();
-        WriteResampledStormCube(output, depth_map, model_settings, depth_name, simbox, format_flag, z0, true);
+        WriteResampledStormCube(output, depth_map, model_settings, depth_name, simbox, format_flag, z0, true, n_threads);
       }
     }
 
@@ -587,6 +414,85 @@ ParameterOutput::WriteFile(const ModelSettings * model_settings,
   }
 }
 
+void
+ParameterOutput::WriteFiles(const ModelSettings           * model_settings,
+                            const Simbox                  * simbox,
+                            const std::vector<OutputGrid> & grids)
+{
+  //
+  // Nested parallelism is not used, so the threads either write files
+  // concurrently or encode the SegY traces of one file at a time. Files are
+  // written one at a time when there are too few of them to keep at least
+  // half the threads busy. This is the rule used for reading seismic cubes.
+  //
+  // Seismic grids are copied before they are shifted, and grids written in depth are
+  // resampled into a new grid. The memory estimate in
+  // ModelAVOStatic::CheckAvailableMemory() allows for one padded computation grid,
+  // so concurrent writers may hold no more such temporary grids than fit in it.
+  //
+  int  n_jobs     = static_cast<int>(grids.size());
+  int  n_threads  = std::max(model_settings->getNumberOfThreads(), 1);
+  bool by_file    = 2*n_jobs > n_threads;
+  int  n_writers  = by_file ? std::max(std::min(n_threads, n_jobs), 1) : 1;
+
+  size_t temp_size = 0; //Largest size of the temporary grids of one writer
+  for (int j = 0; j < n_jobs; j++) {
+    size_t size = 0;
+    if (grids[j].is_seismic)
+      size += grids[j].grid->GetN();
+    if (grids[j].depth_map != NULL && grids[j].depth_map->getMapping() != NULL &&
+        (model_settings->getOutputGridDomain() & IO::DEPTHDOMAIN) > 0)
+      size += grids[j].depth_map->getMapping()->GetN();
+    temp_size = std::max(temp_size, size);
+  }
+  if (temp_size > 0 && n_writers > 1) {
+    size_t padded_size = static_cast<size_t>(2*(simbox->GetNXpad()/2+1))*simbox->GetNYpad()*simbox->GetNZpad();
+    size_t max_writers = model_settings->getFileGrid() ? 1 : std::max(padded_size/temp_size, static_cast<size_t>(1));
+    n_writers = static_cast<int>(std::min(static_cast<size_t>(n_writers), max_writers));
+  }
+  int  n_encoders = n_writers > 1 ? 1 : n_threads; //Threads encoding SegY traces within each file
+
+  std::vector<std::string> err_text(n_jobs, "");
+  std::vector<int>         out_of_memory(n_jobs, 0);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_writers) if(n_writers > 1)
+#endif
+  for (int j = 0; j < n_jobs; j++) {
+    const OutputGrid & output = grids[j];
+    try {
+      WriteFile(model_settings,
+                output.grid,
+                output.f_name,
+                output.sub_dir,
+                simbox,
+                output.is_seismic,
+                output.label,
+                output.depth_map,
+                false,
+                output.offset,
+                n_encoders);
+    }
+    // No exception may leave the parallel region, so they are rethrown below.
+    catch (NRLib::Exception & e) {
+      err_text[j] = e.what();
+    }
+    catch (std::bad_alloc &) {
+      out_of_memory[j] = 1;
+    }
+    catch (std::exception & e) {
+      err_text[j] = e.what();
+    }
+  }
+
+  for (int j = 0; j < n_jobs; j++) {
+    if (out_of_memory[j] == 1)
+      throw std::bad_alloc();
+    if (err_text[j] != "")
+      throw NRLib::Exception(err_text[j]);
+  }
+}
+
 void
 ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
                                          const GridMapping   * gridmapping,
@@ -595,7 +501,8 @@ ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
                                          const Simbox        * simbox,
                                          const int             format,
                                          float                 z0,
-                                         bool                  is_depth)
+                                         bool                  is_depth,
+                                         int                   n_threads)
 {
   // simbox is related to the cube we resample from. gridmapping contains simbox for the cube we resample to.
 
@@ -627,9 +534,8 @@ ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
     int ny = static_cast<int>(storm_grid->GetNJ());
     header = gridmapping->getSimbox()->getStormHeader(FFTGrid::PARAMETER, nx, ny, nz, 0, 1);
     outgrid->SetFormat(StormContGrid::STORM_ASCII);
-    LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+gf_name+"...");
     outgrid->WriteToFile(gf_name, header);
-    LogKit::LogFormatted(LogKit::Low,"done\n");
+    LogKit::LogFormatted(LogKit::Low," Writing ASCII file "+gf_name+"...done\n");
   }
 
   if ((format & IO::STORM) > 0) {
@@ -638,9 +544,8 @@ ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
     int ny = static_cast<int>(storm_grid->GetNJ());
     header = gridmapping->getSimbox()->getStormHeader(FFTGrid::PARAMETER, nx, ny, nz, 0, 0);
     outgrid->SetFormat(StormContGrid::STORM_BINARY);
-    LogKit::LogFormatted(LogKit::Low," Writing STORM file "+gf_name+"...");
     outgrid->WriteToFile(gf_name,header);
-    LogKit::LogFormatted(LogKit::Low,"done\n");
+    LogKit::LogFormatted(LogKit::Low," Writing STORM file "+gf_name+"...done\n");
   }
   if((format & IO::SEGY) > 0 && is_depth == false) {
     gf_name =  file_name + IO::SuffixSegy();
@@ -650,16 +555,17 @@ ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
                           simbox->getILStepX(), simbox->getILStepY(),
                           simbox->getXLStepX(), simbox->getXLStepY(),
                           simbox->getAngle());
-    LogKit::LogFormatted(LogKit::Low," Writing SEGY file "+gf_name+"...");
 
     //Take nz from segy if output_dz = segy_dz, otherwise a nz is calculated
     float dz_output = 0.0;
     int nz_output   = 0;
     FindOutputSegyDzNz(outgrid, model_settings, z0, dz_output, nz_output);
 
-    SegY * segy = new SegY(outgrid, &geometry, z0, dz_output, nz_output, gf_name, true);
+    SegY * segy = new SegY(outgrid, &geometry, z0, dz_output, nz_output, gf_name, true,
+                           TraceHeaderFormat(TraceHeaderFormat::SEISWORKS), false, 0,
+                           n_threads);
     delete segy;
-    LogKit::LogFormatted(LogKit::Low,"done\n");
+    LogKit::LogFormatted(LogKit::Low," Writing SEGY file "+gf_name+"...done\n");
 
   }
   delete outgrid;
@@ -669,16 +575,39 @@ ParameterOutput::WriteResampledStormCube(const StormContGrid * storm_grid,
 void
 ParameterOutput::SeismicShift(NRLib::Grid<float> * grid)
 {
+  //All traces have the same length, so the FFT plans are made once per grid and
+  //not once per trace. Plans are made in the fftw_planner critical section, as
+  //several grids may be shifted at once. Each plan is only used by this thread.
+  int          n_small = static_cast<int>(2*grid->GetNK());
+  int          n_large = 2*n_small;
+  rfftwnd_plan fft_plan;
+  rfftwnd_plan fft_inv_plan;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fft_plan     = rfftwnd_create_plan(1, &n_small, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    fft_inv_plan = rfftwnd_create_plan(1, &n_large, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  }
+
+  std::vector<fftw_real> trace(grid->GetNK());
   for(size_t i=0;i<grid->GetNI();i++) {
     for(size_t j=0;j<grid->GetNJ();j++) {
-      std::vector<fftw_real> trace(grid->GetNK());
       for(size_t k=0;k<grid->GetNK();k++)
         trace[k] = (*grid)(i,j,k);
-      Utils::ShiftTrace(trace);
+      Utils::ShiftTrace(&(trace[0]), trace.size(), fft_plan, fft_inv_plan);
       for(size_t k=0;k<grid->GetNK();k++)
         (*grid)(i,j,k) = trace[k];
     }
   }
+
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftwnd_destroy_plan(fft_plan);
+    fftwnd_destroy_plan(fft_inv_plan);
+  }
 }
 
 void
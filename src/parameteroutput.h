@@ -6,6 +6,7 @@
 #define PARAMETEROUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "src/definitions.h"
 #include "libs/fft/include/fftw.h"
@@ -17,9 +18,34 @@ class GridMapping;
 class ParameterOutput
 {
 public:
+  //A grid to be written by WriteFiles. The arguments are as for WriteFile.
+  struct OutputGrid
+  {
+    OutputGrid(StormContGrid       * grid,
+               const std::string   & f_name,
+               const std::string   & sub_dir,
+               bool                  is_seismic = false,
+               const std::string   & label      = "NO_LABEL",
+               const GridMapping   * depth_map  = NULL,
+               double                offset     = 0)
+      : grid(grid), f_name(f_name), sub_dir(sub_dir), is_seismic(is_seismic),
+        label(label), depth_map(depth_map), offset(offset) {}
+
+    StormContGrid       * grid;
+    std::string           f_name;
+    std::string           sub_dir;
+    bool                  is_seismic;
+    std::string           label;
+    const GridMapping   * depth_map;
+    double                offset;
+  };
+
   //Conventions for writeParameters:
   // simNum = -1 indicates prediction, otherwise filename ends with n+1.
   // All grids are in normal domain, and on log scale.
+  // Several files are written at once, see WriteFiles. Several derived parameters are
+  // computed at once when they fit in the memory of one padded grid, and one at a time
+  // when grids are stored on file.
   static void      WriteParameters(const Simbox        * simbox,
                                    GridMapping         * time_depth_mapping,
                                    const ModelSettings * model_settings,
@@ -36,7 +62,8 @@ public:
                                StormContGrid       * grid,
                                const std::string   & file_name,
                                const std::string   & sgri_label,
-                               bool                  padding = false);
+                               bool                  padding   = false,
+                               int                   n_threads = 1);
 
   static void     WriteFile(const ModelSettings * model_settings,
                             StormContGrid       * storm_grid,
@@ -49,70 +76,33 @@ public:
                             const std::string     label = "NO_LABEL",
                             const GridMapping   * depth_map = NULL,
                             bool                  padding = false,
-                            double                offset = 0);
+                            double                offset = 0,
+                            int                   n_threads = 1); //Threads encoding SegY traces
+
+  //Writes each grid with WriteFile. Several files are written at once when there are
+  //enough of them to keep the threads busy, and their temporary grids fit in memory.
+  //Otherwise the files are written one at a time, and all threads encode SegY traces.
+  //The grids must be distinct.
+  static void     WriteFiles(const ModelSettings           * model_settings,
+                             const Simbox                  * simbox,
+                             const std::vector<OutputGrid> & grids);
 
 private:
 
-  static void      ComputeAcousticImpedance(const Simbox        * simbox,
-                                            GridMapping         * time_depth_mapping,
-                                            const ModelSettings * model_settings,
-                                            StormContGrid       * vp,
-                                            StormContGrid       * rho,
-                                            const std::string   & file_name);
-
-  static void      ComputeShearImpedance(const Simbox        * simbox,
-                                         GridMapping         * time_depth_mapping,
-                                         const ModelSettings * model_settings,
-                                         StormContGrid       * vs,
-                                         StormContGrid       * rho,
-                                         const std::string   & file_name);
-
-  static void     ComputeVpVsRatio(const Simbox        * simbox,
-                                   GridMapping         * time_depth_mapping,
-                                   const ModelSettings * model_settings,
-                                   StormContGrid       * vp,
-                                   StormContGrid       * vs,
-                                   const std::string   & file_name);
+  static void      FindDerivedParameterName(int           parameter,
+                                            std::string & name,
+                                            std::string & label);
 
-  static void      ComputePoissonRatio(const Simbox        * simbox,
-                                       GridMapping         * time_depth_mapping,
-                                       const ModelSettings * model_settings,
-                                       StormContGrid       * vp,
-                                       StormContGrid       * vs,
-                                       const std::string   & file_name);
+  //Computes the derived parameters (IO::AI, IO::SI, ...) into grids, in one pass over vp, vs and rho.
+  static void      ComputeDerivedParameters(const StormContGrid                * vp,
+                                            const StormContGrid                * vs,
+                                            const StormContGrid                * rho,
+                                            const std::vector<int>             & parameters,
+                                            const std::vector<StormContGrid *> & grids,
+                                            int                                  n_threads);
 
-  static void      ComputeLameMu(const Simbox        * simbox,
-                                 GridMapping         * time_depth_mapping,
-                                 const ModelSettings * model_settings,
-                                 StormContGrid       * vs,
-                                 StormContGrid       * rho,
-                                 const std::string   & file_name);
-
-  static void      ComputeLameLambda(const Simbox        * simbox,
-                                     GridMapping         * time_depth_mapping,
-                                     const ModelSettings * model_settings,
-                                     StormContGrid       * vp,
-                                     StormContGrid       * vs,
-                                     StormContGrid       * rho,
-                                     const std::string   & file_name);
-
-  static void      ComputeMuRho(const Simbox        * simbox,
-                                GridMapping         * time_depth_mapping,
-                                const ModelSettings * model_settings,
-                                StormContGrid       * vp,
-                                StormContGrid       * vs,
-                                StormContGrid       * rho,
-                                const std::string   & file_name);
-
-  static void      ComputeLambdaRho(const Simbox        * simbox,
-                                    GridMapping         * time_depth_mapping,
-                                    const ModelSettings * model_settings,
-                                    StormContGrid       * vp,
-                                    StormContGrid       * vs,
-                                    StormContGrid       * rho,
-                                    const std::string   & file_name);
-
-  static void      ExpTransf(StormContGrid * grid);
+  static void      ExpTransf(StormContGrid * grid,
+                             int             n_threads);
 
   static void      WriteResampledStormCube(const StormContGrid * storm_grid,
                                            const GridMapping   * gridmapping,
@@ -121,7 +111,8 @@ private:
                                            const Simbox        * simbox,
                                            const int             format,
                                            float                 z0,
-                                           bool                  is_depth);
+                                           bool                  is_depth,
+                                           int                   n_threads);
 
   static void     SeismicShift(NRLib::Grid<float> * grid);
 
@@ -84,12 +84,12 @@ n2_(n2)
   smoother->fftInPlace();
 
   //multiply by normalizing constant for the PDF - dim is the total number of entries
-  histogram_->multiplyByScalar(float(1/(dim*dx_*dy_)));
+  histogram_->deferScale(float(1/(dim*dx_*dy_)));
   histogram_->fftInPlace();
   // Carry out multiplication of the smoother with the density grid (histogram) in the Fourier domain
   histogram_->multiply(smoother);
+  histogram_->deferScale(float(sqrt(double(n1_*n2_))));
   histogram_->invFFTInPlace();
-  histogram_->multiplyByScalar(float(sqrt(double(n1_*n2_))));
 
   delete smoother;
 
@@ -177,12 +177,12 @@ n2_(n2)
   smoother->fftInPlace();
 
   //multiply by normalizing constant for the PDF - dim is the total number of entries
-  histogram_->multiplyByScalar(float(1/(dim*dx_*dy_)));
+  histogram_->deferScale(float(1/(dim*dx_*dy_)));
   histogram_->fftInPlace();
   // Carry out multiplication of the smoother with the density grid (histogram) in the Fourier domain
   histogram_->multiply(smoother);
+  histogram_->deferScale(float(sqrt(double(n1_*n2_))));
   histogram_->invFFTInPlace();
-  histogram_->multiplyByScalar(float(sqrt(double(n1_*n2_))));
 
   delete smoother;
 }
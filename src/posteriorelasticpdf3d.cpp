@@ -130,8 +130,8 @@ z_max_(d3_max)
   // Carry out multiplication of the smoother with the density grid (histogram) in the Fourier domain
   smoother->fftInPlace();
   histogram_->multiply(smoother);
+  histogram_->deferScale(sqrt(float(n1_*n2_*n3_)));
   histogram_->invFFTInPlace();
-  histogram_->multiplyByScalar(sqrt(float(n1_*n2_*n3_)));
   histogram_->endAccess();
 
   delete smoother;
@@ -272,8 +272,8 @@ PosteriorElasticPDF3D::PosteriorElasticPDF3D(const std::vector<double>
   // Carry out multiplication of the smoother with the density grid (histogram) in the Fourier domain
   smoother->fftInPlace();
   histogram_->multiply(smoother);
+  histogram_->deferScale(sqrt(float(n1_*n2_*n3_)));
   histogram_->invFFTInPlace();
-  histogram_->multiplyByScalar(sqrt(float(n1_*n2_*n3_)));
   histogram_->endAccess();
 
   delete smoother;
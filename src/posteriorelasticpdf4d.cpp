@@ -149,8 +149,8 @@ t2_max_(t2_max)
       // Carry out multiplication of the smoother with the density grid (histogram) in the Fourier domain
       smoother->fftInPlace();
       histogram_(i,j)->multiply(smoother);
+      histogram_(i,j)->deferScale(sqrt(float(nx_*ny_*1)));
       histogram_(i,j)->invFFTInPlace();
-      histogram_(i,j)->multiplyByScalar(sqrt(float(nx_*ny_*1)));
       histogram_(i,j)->endAccess();
 
       delete smoother;
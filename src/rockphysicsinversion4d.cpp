@@ -20,8 +20,13 @@ RockPhysicsInversion4D::~RockPhysicsInversion4D()
     }
   }
 
- fftwnd_destroy_plan(fftplan1_);
- fftwnd_destroy_plan(fftplan2_);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+ {
+   fftwnd_destroy_plan(fftplan1_);
+   fftwnd_destroy_plan(fftplan2_);
+ }
 }
 
 RockPhysicsInversion4D::RockPhysicsInversion4D(NRLib::Vector                      priorMean,
@@ -36,8 +41,13 @@ RockPhysicsInversion4D::RockPhysicsInversion4D(NRLib::Vector
   nf_[3] = 60;
   nfp_= 135;
 
-  fftplan1_ = rfftwnd_create_plan(1, &nfp_, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
-  fftplan2_ = rfftwnd_create_plan(1, &nfp_, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
+  {
+    fftplan1_ = rfftwnd_create_plan(1, &nfp_, FFTW_REAL_TO_COMPLEX, FFTW_ESTIMATE | FFTW_IN_PLACE);
+    fftplan2_ = rfftwnd_create_plan(1, &nfp_, FFTW_COMPLEX_TO_REAL, FFTW_ESTIMATE | FFTW_IN_PLACE);
+  }
 
   v_.resize(4,6);
   SolveGEVProblem(priorCov,posteriorCov, v_);
@@ -484,7 +484,43 @@ SeismicParametersHolder::FFTCovGrids()
 void
 SeismicParametersHolder::getNextParameterCovariance(fftw_complex **& parVar) const
 {
+  fftw_complex iiTmp = covVp_     ->getNextComplex();
+  fftw_complex jjTmp = covVs_     ->getNextComplex();
+  fftw_complex kkTmp = covRho_    ->getNextComplex();
+  fftw_complex ijTmp = crCovVpVs_ ->getNextComplex();
+  fftw_complex ikTmp = crCovVpRho_->getNextComplex();
+  fftw_complex jkTmp = crCovVsRho_->getNextComplex();
 
+  setParameterCovariance(parVar, iiTmp, jjTmp, kkTmp, ijTmp, ikTmp, jkTmp);
+}
+
+//--------------------------------------------------------------------------------------------------
+void
+SeismicParametersHolder::getParameterCovariance(fftw_complex **& parVar,
+                                                size_t           index) const
+{
+  // Same as getNextParameterCovariance(), but without the sequential cursor
+  // of the grids, so that it may be called from several threads at once.
+  fftw_complex iiTmp = covVp_     ->getComplexValue(index);
+  fftw_complex jjTmp = covVs_     ->getComplexValue(index);
+  fftw_complex kkTmp = covRho_    ->getComplexValue(index);
+  fftw_complex ijTmp = crCovVpVs_ ->getComplexValue(index);
+  fftw_complex ikTmp = crCovVpRho_->getComplexValue(index);
+  fftw_complex jkTmp = crCovVsRho_->getComplexValue(index);
+
+  setParameterCovariance(parVar, iiTmp, jjTmp, kkTmp, ijTmp, ikTmp, jkTmp);
+}
+
+//--------------------------------------------------------------------------------------------------
+void
+SeismicParametersHolder::setParameterCovariance(fftw_complex **& parVar,
+                                                fftw_complex     iiTmp,
+                                                fftw_complex     jjTmp,
+                                                fftw_complex     kkTmp,
+                                                fftw_complex     ijTmp,
+                                                fftw_complex     ikTmp,
+                                                fftw_complex     jkTmp) const
+{
   fftw_complex ii;
   fftw_complex jj;
   fftw_complex kk;
@@ -492,13 +528,6 @@ SeismicParametersHolder::getNextParameterCovariance(fftw_complex **& parVar) con
   fftw_complex ik;
   fftw_complex jk;
 
-  fftw_complex iiTmp = covVp_     ->getNextComplex();
-  fftw_complex jjTmp = covVs_     ->getNextComplex();
-  fftw_complex kkTmp = covRho_    ->getNextComplex();
-  fftw_complex ijTmp = crCovVpVs_ ->getNextComplex();
-  fftw_complex ikTmp = crCovVpRho_->getNextComplex();
-  fftw_complex jkTmp = crCovVsRho_->getNextComplex();
-
   if(priorVar0_(0,0) != 0)
     iiTmp.re = iiTmp.re / static_cast<float>(priorVar0_(0,0));
 
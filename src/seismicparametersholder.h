@@ -163,6 +163,9 @@ public:
 
   void                          getNextParameterCovariance(fftw_complex **& parVar) const;
 
+  void                          getParameterCovariance(fftw_complex **& parVar,
+                                                       size_t           index) const; // In-memory grids only
+
   void                          findParameterVariances(fftw_complex **& parVar,
                                                        fftw_complex     ii,
                                                        fftw_complex     jj,
@@ -183,6 +186,14 @@ public:
   void                          releaseExpGrids() const;
 
 private:
+
+  void                          setParameterCovariance(fftw_complex **& parVar,
+                                                       fftw_complex     iiTmp,
+                                                       fftw_complex     jjTmp,
+                                                       fftw_complex     kkTmp,
+                                                       fftw_complex     ijTmp,
+                                                       fftw_complex     ikTmp,
+                                                       fftw_complex     jkTmp) const;
   void                          createCorrGrids(int nx, int ny, int nz, int nxp, int nyp, int nzp, bool fileGrid);
 
   void                          InitializeCorrelations(bool                                  cov_estimated,
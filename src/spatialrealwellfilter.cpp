@@ -2,6 +2,9 @@
 *      Copyright (C) 2008 by Norwegian Computing Center and Statoil        *
 ***************************************************************************/
 
+#include <new>
+#include <exception>
+
 #include "src/spatialwellfilter.h"
 #include "src/spatialrealwellfilter.h"
 #include "avoinversion.h"
@@ -124,12 +127,12 @@ SpatialRealWellFilter::fillValuesInSigmapost(double    ** sigmapost,
                                              const int *  ipos,
                                              const int *  jpos,
                                              const int *  kpos,
-                                             FFTGrid   *  covgrid,
+                                             const FFTGrid * covgrid,
                                              int          n,
                                              int          ni,
                                              int          nj)
 {
-  covgrid->setAccessMode(FFTGrid::RANDOMACCESS);
+  // covgrid must be in RANDOMACCESS mode. It is only read, so several wells may be filled at once.
   for (int l1=0 ; l1<n ; l1++) {
     int i1 = ipos[l1];
     int j1 = jpos[l1];
@@ -144,7 +147,6 @@ SpatialRealWellFilter::fillValuesInSigmapost(double    ** sigmapost,
 
     }
   }
-  covgrid->endAccess();
 }
 
 void SpatialRealWellFilter::setPriorSpatialCorr(FFTGrid             * parSpatialCorr,
@@ -185,7 +187,8 @@ void SpatialRealWellFilter::doFiltering(std::map<std::string, BlockedLogsCommon
                                         int                                        nAngles,
                                         const AVOInversion                       * avoInversionResult,
                                         const std::vector<Grid2D *>              & noiseScale,
-                                        SeismicParametersHolder                  & seismicParameters)
+                                        SeismicParametersHolder                  & seismicParameters,
+                                        int                                        nThreads)
 {
   LogKit::WriteHeader("Creating spatial multi-parameter filter");
 
@@ -194,11 +197,7 @@ void SpatialRealWellFilter::doFiltering(std::map<std::string, BlockedLogsCommon
 
   std::vector<NRLib::Matrix> sigmaeVpRho;
 
-  double ** sigmapost;
-  double ** sigmapri;
-
   int lastn = 0;
-  int n = 0;
   int nDim = 1;
   for(int i=0;i<nAngles;i++)
     nDim *= 2;
@@ -216,149 +215,95 @@ void SpatialRealWellFilter::doFiltering(std::map<std::string, BlockedLogsCommon
 
   NRLib::Matrix priorCov0 = avoInversionResult->getPriorVar0();
 
-  bool no_wells_filtered = true;
+  //
+  // The wells are independent, and are filtered in parallel. Their contributions
+  // to sigmae are added afterwards, in well order, and each well is logged then.
+  //
+  std::vector<BlockedLogsCommon *> wells;
+  std::vector<int>                 wellNumbers;
   int w1 = 0;
-
   for(std::map<std::string, BlockedLogsCommon *>::const_iterator it = blocked_logs.begin(); it != blocked_logs.end(); it++) {
-    std::map<std::string, BlockedLogsCommon *>::const_iterator iter = blocked_logs.find(it->first);
-    BlockedLogsCommon * blocked_log = iter->second;
-
-    n = blocked_log->GetNumberOfBlocks();
-
-    if (blocked_log->GetUseForFiltering() == true)
-    {
-      LogKit::LogFormatted(LogKit::Low,"\nFiltering well "+blocked_log->GetWellName());
-      no_wells_filtered = false;
-
-      sigmapost = new double * [3*n];
-      for(int i=0;i<3*n;i++)
-        sigmapost[i] = new double[3*n];
-
-      sigmapri = new double * [3*n];
-      for(int i=0;i<3*n;i++)
-        sigmapri[i] = new double[3*n];
-
-      const std::vector<int> & ipos = blocked_log->GetIposVector();
-      const std::vector<int> & jpos = blocked_log->GetJposVector();
-      const std::vector<int> & kpos = blocked_log->GetKposVector();
-
-      float regularization = Definitions::SpatialFilterRegularisationValue();
-
-      // Fill the upper triangular submatrices
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCovVp()     , n, 0  , 0   );
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCovVs()     , n, n  , n   );
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCovRho()    , n, 2*n, 2*n );
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCrCovVpVs() , n, 0  , n   );
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCrCovVpRho(), n, 0  , 2*n );
-      fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], seismicParameters.GetCrCovVsRho(), n, n, 2*n   );
-
-      for(int l1=0 ; l1 < n ; l1++) {
-        for(int l2=0 ; l2 < n ; l2++) {
-          //sigmapost[l2 + n  ][l1      ] = sigmapost[l1      ][l2 + n  ];
-          //sigmapost[l2 + 2*n][l1      ] = sigmapost[l1      ][l2 + 2*n];
-          //sigmapost[l2 + 2*n][l1 +   n] = sigmapost[l1 + n  ][l2 + 2*n];
-          sigmapri [l1      ][l2      ] = prior_cov_vp_[w1](l1,l2);//priorCov0(0,0)*priorSpatialCorr_[w1][l1][l2];
-          //sigmapri [l2      ][l1      ] = sigmapri [l1      ][l2      ];
-          sigmapri [l1 + n  ][l2 + n  ] = prior_cov_vs_[w1](l1,l2);//priorCov0(1,1)*priorSpatialCorr_[w1][l1][l2];
-          //sigmapri [l2 + n  ][l1 + n  ] = sigmapri [l1 + n  ][l2 + n  ];
-          sigmapri [l1 + 2*n][l2 + 2*n] = prior_cov_rho_[w1](l1,l2);//priorCov0(2,2)*priorSpatialCorr_[w1][l1][l2];
-          //sigmapri [l2 + 2*n][l1 + 2*n] = sigmapri [l1 + 2*n][l2 + 2*n];
-          if(l1==l2)
-          {
-            sigmapost[l1      ][l2      ] += regularization*sigmapost[l1      ][l2      ]/sigmapri[l1      ][l2      ];
-            sigmapost[l1 + n  ][l2 + n  ] += regularization*sigmapost[l1 + n  ][l2 + n  ]/sigmapri[l1 + n  ][l2 + n  ];
-            sigmapost[l1 + 2*n][l2 + 2*n] += regularization*sigmapost[l1 + 2*n][l2 + 2*n]/sigmapri[l1 + 2*n][l2 + 2*n];
-            sigmapri [l1      ][l2      ] += regularization;
-            sigmapri [l1 + n  ][l2 + n  ] += regularization;
-            sigmapri [l1 + 2*n][l2 + 2*n] += regularization;
-          }
-          // submat (0,1)
-          sigmapri[l1      ][l2 + n  ] = prior_cov_vpvs_[w1](l1,l2);
-          sigmapri[l2      ][l1 + n  ] = prior_cov_vpvs_[w1](l2,l1);
-          // submat(1,0)
-          //sigmapri[l1 + n  ][l2      ];//priorCov0(1,0)*priorSpatialCorr_[w1][l1][l2];
-          //sigmapri[l2 + n  ][l2      ];
-          // submat(0,2)
-          sigmapri[l1      ][l2+2*n  ]  = prior_cov_vprho_[w1](l1,l2);//priorCov0(2,0)*priorSpatialCorr_[w1][l1][l2];
-          sigmapri[l2      ][l1+2*n  ]  = prior_cov_vprho_[w1](l2,l1);//priorCov0(2,0)*priorSpatialCorr_[w1][l1][l2];
-          // submat(2,0)
-          //sigmapri[l1 + 2*n][l2      ] = sigmapri[l2][l1+2*n];
-          //sigmapri[l2 + 2*n][l1      ] = sigmapri[l1][l2+2*n];
-          // submat(1,2)
-          sigmapri[l1 + n  ][l2 + 2*n] = prior_cov_vsrho_[w1](l1,l2);//priorCov0(2,1)*priorSpatialCorr_[w1][l1][l2];
-          sigmapri[l2 + n  ][l1 + 2*n] = prior_cov_vsrho_[w1](l2,l1);//priorCov0(2,1)*priorSpatialCorr_[w1][l1][l2];
-          // submat(2,1)
-          //sigmapri[l2 + 2*n][l1 + n] = sigmapri[l1 + n  ][l2 + 2*n];
-          //sigmapri[l1 + 2*n][l2+n] = sigmapri[l2 + n  ][l1 + 2*n];
-        }
-      }
-
-      NRLib::SymmetricMatrix Sprior(3*n);
-      NRLib::SymmetricMatrix Spost(3*n);
-
-      for(int i = 0 ; i < 3*n ; i++)
-        for(int j = i ; j < 3*n ; j++)
-          Sprior(i,j) = sigmapri[i][j];
-
-      for(int i = 0 ; i < 3*n ; i++)
-        for(int j = i ; j < 3*n ; j++)
-          Spost(i,j) = sigmapost[i][j];
-
-      if(useVpRhoFilter == true) //Only additional
-        doVpRhoFiltering(sigmaeVpRho,
-                         sigmapri,
-                         sigmapost,
-                         n,
-                         blocked_log); //Must do before Cholesky of sigmapri.
-
-
-      //NRLib::WriteMatrixToFile("Sprior_2014.dat", Sprior);
-      //NRLib::WriteMatrixToFile("Spost_2014.dat", Spost);
-
-      //
-      // Filter = I - Sigma_post * inv(Sigma_prior)
-      //
-      NRLib::Matrix I = NRLib::IdentityMatrix(3*n);
-      NRLib::CholeskySolve(Sprior, I);
-
-      NRLib::Matrix Aw = Spost * I;
-      //NRLib::WriteMatrixToFile("SpostxSpriinv_2014.dat", Aw);
-      Aw = Aw * (-1);
-      for(int i=0 ; i<3*n ; i++) {
-        Aw(i,i) += 1.0;
-      }
-
-      if(useVpRhoFilter == false) { //Save time, since below is not needed then.
-        updateSigmaE(sigmae_[0],
-                     Aw,
-                     Spost,
-                     n);
-      }
-
-      //NRLib::WriteMatrixToFile("Aw_2014.dat", Aw);
+    BlockedLogsCommon * blocked_log = it->second;
+    if (blocked_log->GetUseForFiltering() == true) {
+      wells.push_back(blocked_log);
+      wellNumbers.push_back(w1);
+    }
+    w1++;
+  }
 
-      //NRLib::Vector eigenvalues(3*n);
-      //NRLib::Matrix eigenvectors(3*n, 3*n);
-      //NRLib::ComputeEigenVectors(Aw, eigenvalues, eigenvectors);
+  int nFiltered = static_cast<int>(wells.size());
+
+  std::vector<NRLib::Matrix> sigmaeW(nFiltered);
+  std::vector<NRLib::Matrix> sigmaeWVpRho(nFiltered);
+  std::vector<std::string>   errors(nFiltered);
+  std::vector<int>           outOfMemory(nFiltered, 0);
+
+  std::vector<FFTGrid *> covGrids(6);
+  covGrids[0] = seismicParameters.GetCovVp();
+  covGrids[1] = seismicParameters.GetCovVs();
+  covGrids[2] = seismicParameters.GetCovRho();
+  covGrids[3] = seismicParameters.GetCrCovVpVs();
+  covGrids[4] = seismicParameters.GetCrCovVpRho();
+  covGrids[5] = seismicParameters.GetCrCovVsRho();
+
+  for(size_t c=0 ; c<covGrids.size() ; c++)
+    covGrids[c]->setAccessMode(FFTGrid::RANDOMACCESS);
+
+#ifdef PARALLEL
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nThreads)
+#endif
+  for(int w=0 ; w<nFiltered ; w++) {
+    try {
+      filterSingleWell(wells[w],
+                       wellNumbers[w],
+                       useVpRhoFilter,
+                       covGrids,
+                       sigmaeW[w],
+                       sigmaeWVpRho[w]);
+    }
+    // No exception may leave the parallel region, so they are rethrown below.
+    catch (NRLib::Exception & e) {
+      errors[w] = e.what();
+    }
+    catch (std::bad_alloc &) {
+      outOfMemory[w] = 1;
+    }
+    catch (std::exception & e) {
+      errors[w] = e.what();
+    }
+  }
 
-      calculateFilteredLogs(Aw,
-                            blocked_log,
-                            n,
-                            true);
+  for(size_t c=0 ; c<covGrids.size() ; c++)
+    covGrids[c]->endAccess();
 
-      lastn += n;
+  for(int w=0 ; w<nFiltered ; w++) {
+    if (outOfMemory[w] == 1)
+      throw std::bad_alloc();
+    if (errors[w] != "")
+      throw NRLib::Exception(errors[w]);
+  }
 
-      for(int i=0;i<3*n;i++)
-      {
-        delete [] sigmapost[i];
-        delete [] sigmapri[i];
-      }
-      delete [] sigmapri;
-      delete [] sigmapost;
+  for(int w=0 ; w<nFiltered ; w++) {
+    LogKit::LogFormatted(LogKit::Low,"\nFiltering well "+wells[w]->GetWellName());
+    if(useVpRhoFilter == false) {
+      sigmae_[0](0,0) += sigmaeW[w](0,0);
+      sigmae_[0](1,0) += sigmaeW[w](1,0);
+      sigmae_[0](2,0) += sigmaeW[w](2,0);
+      sigmae_[0](1,1) += sigmaeW[w](1,1);
+      sigmae_[0](2,1) += sigmaeW[w](2,1);
+      sigmae_[0](2,2) += sigmaeW[w](2,2);
+      // sigmae Is normalized (1/n) in completeSigmaE, Here well by well is added.
     }
-    w1++;
+    else {
+      updateSigmaEVpRho(sigmaeVpRho,
+                        sigmaeWVpRho[w],
+                        static_cast<int>(sigmae_.size()));
+    }
+    lastn += wells[w]->GetNumberOfBlocks();
   }
 
+  bool no_wells_filtered = (nFiltered == 0);
+
   if(no_wells_filtered == false)
     completeSigmaE(sigmae_,
                    lastn,
@@ -377,3 +322,98 @@ void SpatialRealWellFilter::doFiltering(std::map<std::string, BlockedLogsCommon
 
   Timings::setTimeFiltering(wall,cpu);
 }
+
+//-------------------------------------------------------------------------------
+void SpatialRealWellFilter::filterSingleWell(BlockedLogsCommon            * blocked_log,
+                                             int                            w1,
+                                             bool                           useVpRhoFilter,
+                                             const std::vector<FFTGrid *> & covGrids,
+                                             NRLib::Matrix                & sigmaeW,
+                                             NRLib::Matrix                & sigmaeWVpRho)
+{
+  int n = blocked_log->GetNumberOfBlocks();
+
+  double ** sigmapost = new double * [3*n];
+  for(int i=0;i<3*n;i++)
+    sigmapost[i] = new double[3*n];
+
+  double ** sigmapri = new double * [3*n];
+  for(int i=0;i<3*n;i++)
+    sigmapri[i] = new double[3*n];
+
+  const std::vector<int> & ipos = blocked_log->GetIposVector();
+  const std::vector<int> & jpos = blocked_log->GetJposVector();
+  const std::vector<int> & kpos = blocked_log->GetKposVector();
+
+  float regularization = Definitions::SpatialFilterRegularisationValue();
+
+  // Fill the upper triangular submatrices
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[0], n, 0  , 0   );
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[1], n, n  , n   );
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[2], n, 2*n, 2*n );
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[3], n, 0  , n   );
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[4], n, 0  , 2*n );
+  fillValuesInSigmapost(sigmapost, &ipos[0], &jpos[0], &kpos[0], covGrids[5], n, n, 2*n   );
+
+  for(int l1=0 ; l1 < n ; l1++) {
+    for(int l2=0 ; l2 < n ; l2++) {
+      sigmapri [l1      ][l2      ] = prior_cov_vp_[w1](l1,l2);
+      sigmapri [l1 + n  ][l2 + n  ] = prior_cov_vs_[w1](l1,l2);
+      sigmapri [l1 + 2*n][l2 + 2*n] = prior_cov_rho_[w1](l1,l2);
+      if(l1==l2)
+      {
+        sigmapost[l1      ][l2      ] += regularization*sigmapost[l1      ][l2      ]/sigmapri[l1      ][l2      ];
+        sigmapost[l1 + n  ][l2 + n  ] += regularization*sigmapost[l1 + n  ][l2 + n  ]/sigmapri[l1 + n  ][l2 + n  ];
+        sigmapost[l1 + 2*n][l2 + 2*n] += regularization*sigmapost[l1 + 2*n][l2 + 2*n]/sigmapri[l1 + 2*n][l2 + 2*n];
+        sigmapri [l1      ][l2      ] += regularization;
+        sigmapri [l1 + n  ][l2 + n  ] += regularization;
+        sigmapri [l1 + 2*n][l2 + 2*n] += regularization;
+      }
+      // submat (0,1)
+      sigmapri[l1      ][l2 + n  ] = prior_cov_vpvs_[w1](l1,l2);
+      sigmapri[l2      ][l1 + n  ] = prior_cov_vpvs_[w1](l2,l1);
+      // submat(0,2)
+      sigmapri[l1      ][l2+2*n  ]  = prior_cov_vprho_[w1](l1,l2);
+      sigmapri[l2      ][l1+2*n  ]  = prior_cov_vprho_[w1](l2,l1);
+      // submat(1,2)
+      sigmapri[l1 + n  ][l2 + 2*n] = prior_cov_vsrho_[w1](l1,l2);
+      sigmapri[l2 + n  ][l1 + 2*n] = prior_cov_vsrho_[w1](l2,l1);
+    }
+  }
+
+  if(useVpRhoFilter == true) //Only additional
+    doVpRhoFiltering(sigmapri,
+                     sigmapost,
+                     n,
+                     blocked_log,
+                     sigmaeWVpRho);
+
+  NRLib::SymmetricMatrix Sprior(3*n);
+  NRLib::SymmetricMatrix Spost(3*n);
+
+  for(int i = 0 ; i < 3*n ; i++)
+    for(int j = i ; j < 3*n ; j++)
+      Sprior(i,j) = sigmapri[i][j];
+
+  for(int i = 0 ; i < 3*n ; i++)
+    for(int j = i ; j < 3*n ; j++)
+      Spost(i,j) = sigmapost[i][j];
+
+  for(int i=0;i<3*n;i++)
+  {
+    delete [] sigmapost[i];
+    delete [] sigmapri[i];
+  }
+  delete [] sigmapri;
+  delete [] sigmapost;
+
+  //
+  // Filter = I - Sigma_post * inv(Sigma_prior)
+  //
+  filterWell(Sprior,
+             Spost,
+             blocked_log,
+             n,
+             true,
+             sigmaeW);
+}
@@ -48,11 +48,19 @@ public:
                                       int                                        nAngles,
                                       const AVOInversion                       * avoInversionResult,
                                       const std::vector<Grid2D *>              & noiseScale,
-                                      SeismicParametersHolder                  & seismicParameters);
+                                      SeismicParametersHolder                  & seismicParameters,
+                                      int                                        nThreads);
 
 
 private:
 
+  void filterSingleWell(BlockedLogsCommon            * blocked_log,
+                        int                            w1,
+                        bool                           useVpRhoFilter,
+                        const std::vector<FFTGrid *> & covGrids,
+                        NRLib::Matrix                & sigmaeW,
+                        NRLib::Matrix                & sigmaeWVpRho);
+
   void adjustDiagSigma(NRLib::Matrix & sigmae);
 
   /*
@@ -73,7 +81,7 @@ private:
                              const int *  ipos,
                              const int *  jpos,
                              const int *  kpos,
-                             FFTGrid   *  covgrid,
+                             const FFTGrid * covgrid,
                              int          n,
                              int          ni,
                              int          nj);
@@ -240,67 +240,40 @@ SpatialWellFilter::computeSigmaEAdjusted(NRLib::Matrix & sigmae,
   sigmaEAdj = T1 * T2;                             // sigmaEAdj = sqrt(sigmaETmp*sigmaE0^-1)*sigmae*sqrt(sigmaE0^-1*sigmaETmp)
 }
 
-void SpatialWellFilter::doVpRhoFiltering(std::vector<NRLib::Matrix> &  sigmaeVpRho,
-                                         double                     ** sigmapri,
+void SpatialWellFilter::doVpRhoFiltering(double                     ** sigmapri,
                                          double                     ** sigmapost,
                                          const int                     n,
-                                         BlockedLogsCommon          *  blockedLogs)
+                                         BlockedLogsCommon          *  blockedLogs,
+                                         NRLib::Matrix              &  sigmaeW)
 //---------------------------------------------------------------------------------
 {
   int m = 2*n;
 
-  NRLib::Matrix tmp1(m,m);
-  NRLib::Matrix tmp2(m,m);
+  // Vp and Rho parts of the covariances. Only the upper triangles are filled.
+  NRLib::SymmetricMatrix Sprior2(m);
+  NRLib::SymmetricMatrix Spost2(m);
 
   for (int j=0 ; j<n ; j++) {
+    for (int i=0 ; i<=j ; i++) {
+      Sprior2(i,   j  ) = sigmapri [i  ][j  ];
+      Sprior2(i+n, j+n) = sigmapri [i+m][j+m];
+
+      Spost2 (i,   j  ) = sigmapost[i  ][j  ];
+      Spost2 (i+n, j+n) = sigmapost[i+m][j+m];
+    }
     for (int i=0 ; i<n ; i++) {
-      tmp1(i,   j  ) = sigmapri [i  ][j  ];
-      tmp1(i+n, j  ) = sigmapri [i+m][j  ];
-      tmp1(i  , j+n) = sigmapri [i  ][j+m];
-      tmp1(i+n, j+n) = sigmapri [i+m][j+m];
-
-      tmp2(i,   j  ) = sigmapost[i  ][j  ];
-      tmp2(i+n, j  ) = sigmapost[i+m][j  ];
-      tmp2(i,   j+n) = sigmapost[i  ][j+m];
-      tmp2(i+n, j+n) = sigmapost[i+m][j+m];
+      Sprior2(i,   j+n) = sigmapri [i  ][j+m];
+      Spost2 (i,   j+n) = sigmapost[i  ][j+m];
     }
   }
 
-  NRLib::SymmetricMatrix Sprior2(m);
-  NRLib::SymmetricMatrix Spost2(m);
-
-  for(int j = 0 ; j < m ; j++)
-    for(int i = 0 ; i <= j ; i++)
-      Sprior2(i,j) = tmp1(i,j);
-
-  for(int j = 0 ; j < m ; j++)
-    for(int i = 0 ; i <= j ; i++)
-      Spost2(i,j) = tmp2(i,j);
-
-  NRLib::Matrix Aw;
-  NRLib::Matrix I = NRLib::IdentityMatrix(m);
-  NRLib::CholeskySolve(Sprior2, I);
-  Aw = Spost2 * I;
-  Aw = Aw * (-1);
-  for(int i=0 ; i<m ; i++) {
-    Aw(i,i) += 1.0;
-  }
-
-  calculateFilteredLogs(Aw, blockedLogs, n, false);
-
-  updateSigmaEVpRho(sigmaeVpRho,
-                    Aw,
-                    Spost2,
-                    static_cast<int>(sigmae_.size()),
-                    n);
+  filterWell(Sprior2, Spost2, blockedLogs, n, false, sigmaeW);
 }
 
 //---------------------------------------------------------------------------------
 void SpatialWellFilter::updateSigmaEVpRho(std::vector<NRLib::Matrix> & sigmaeVpRho,
-                                          const NRLib::Matrix        & Aw,
-                                          const NRLib::Matrix        & Spost,
-                                          int                          nDim,
-                                          int                          n)
+                                          const NRLib::Matrix        & sigmaeW,
+                                          int                          nDim)
 //---------------------------------------------------------------------------------
 {
   if (sigmaeVpRho.size() == 0) { // then first time alocate memory
@@ -314,17 +287,13 @@ void SpatialWellFilter::updateSigmaEVpRho(std::vector<NRLib::Matrix> & sigmaeVpR
     }
   }
 
-  NRLib::Matrix sigma = Aw * Spost;
-
   //
   // NBNB-PAL: Bug? frsteindeksen p sigmaeVpRho[0][0][0] str
   // stille hele tiden. Det er ingen n-avhengighet.
   //
-  for(int i=0 ; i < n ; i++) {
-    sigmaeVpRho[0](0,0) += sigma(i    , i    );
-    sigmaeVpRho[0](1,0) += sigma(i + n, i    );
-    sigmaeVpRho[0](1,1) += sigma(i + n, i + n);
-  }
+  sigmaeVpRho[0](0,0) += sigmaeW(0,0);
+  sigmaeVpRho[0](1,0) += sigmaeW(1,0);
+  sigmaeVpRho[0](1,1) += sigmaeW(1,1);
 }
 
 //------------------------------------------------------------------------------------
@@ -422,35 +391,108 @@ void SpatialWellFilter::completeSigmaEVpRho(std::vector<NRLib::Matrix>  & sigmae
   }
 }
 
-void SpatialWellFilter::calculateFilteredLogs(const NRLib::Matrix & Aw,
-                                              BlockedLogsCommon   * blockedlogs,
-                                              int                   n,
-                                              bool                  useVs)
+void SpatialWellFilter::filterWell(NRLib::SymmetricMatrix       & Sprior,
+                                   const NRLib::SymmetricMatrix & Spost,
+                                   BlockedLogsCommon            * blockedlogs,
+                                   int                            n,
+                                   bool                           useVs,
+                                   NRLib::Matrix                & sigmaeW)
 //------------------------------------------------------------------------------
 {
   int nLogs = 2;
   if(useVs == true)
     nLogs++;
 
-  NRLib::Vector residuals(nLogs*n);
+  int m = nLogs*n;
+
+  NRLib::Vector residuals(m);
+  makeResiduals(blockedlogs, n, useVs, residuals);
 
+  //
+  // The filter is Aw = I - Spost*inv(Sprior). With Sprior = U^T*U and X = inv(U^T)*Spost
+  // we have Aw*r = r - X^T*inv(U^T)*r and Aw*Spost = Spost - X^T*X, so one factorisation
+  // and one triangular solve replace the inverse and the two dense matrix products.
+  //
+  NRLib::CholeskyFactorize(Sprior);
+
+  NRLib::Matrix X(m, m+1);
+  for(int j=0 ; j<m ; j++) {
+    for(int i=0 ; i<=j ; i++) {
+      X(i,j) = Spost(i,j);
+      X(j,i) = Spost(i,j);
+    }
+    X(j,m) = residuals(j);
+  }
+  NRLib::CholeskyForwardSolve(Sprior, X);
+
+  NRLib::Vector filteredVal(m);
+  for(int p=0 ; p<m ; p++) {
+    double sum = 0.0;
+    for(int r=0 ; r<m ; r++)
+      sum += X(r,p)*X(r,m);
+    filteredVal(p) = residuals(p) - sum;
+  }
+
+  setFilteredLogs(filteredVal, blockedlogs, n, useVs);
+
+  //
+  // Sum over the diagonals of the blocks of Aw*Spost, as used for sigmae
+  //
+  sigmaeW.resize(nLogs, nLogs);
+  NRLib::InitializeMatrix(sigmaeW, 0.0);
+  for(int a=0 ; a<nLogs ; a++) {
+    for(int b=0 ; b<=a ; b++) {
+      double sum = 0.0;
+      for(int i=0 ; i<n ; i++) {
+        int p = i + a*n;
+        int q = i + b*n;
+        double xx = 0.0;
+        for(int r=0 ; r<m ; r++)
+          xx += X(r,p)*X(r,q);
+        sum += Spost(q,p) - xx;
+      }
+      sigmaeW(a,b) = sum;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void SpatialWellFilter::makeResiduals(BlockedLogsCommon * blockedlogs,
+                                      int                 n,
+                                      bool                useVs,
+                                      NRLib::Vector     & residuals)
+//------------------------------------------------------------------------------
+{
   int currentEnd = 0;
   const std::vector<double> & vp    = blockedlogs->GetVpBlocked();
   const std::vector<double> & bg_vp = blockedlogs->GetVpHighCutBackground();
   MakeInterpolatedResiduals(vp, bg_vp, n, currentEnd, residuals);
   currentEnd += n;
 
-  const std::vector<double> & vs    = blockedlogs->GetVsBlocked();
-  const std::vector<double> & bg_vs = blockedlogs->GetVsHighCutBackground();
   if(useVs == true) {
+    const std::vector<double> & vs    = blockedlogs->GetVsBlocked();
+    const std::vector<double> & bg_vs = blockedlogs->GetVsHighCutBackground();
     MakeInterpolatedResiduals(vs, bg_vs, n, currentEnd, residuals);
     currentEnd += n;
   }
   const std::vector<double> & rho    = blockedlogs->GetRhoBlocked();
   const std::vector<double> & bg_rho = blockedlogs->GetRhoHighCutBackground();
   MakeInterpolatedResiduals(rho, bg_rho, n, currentEnd, residuals);
+}
 
-  NRLib::Vector filteredVal = Aw * residuals;
+//------------------------------------------------------------------------------
+void SpatialWellFilter::setFilteredLogs(const NRLib::Vector & filteredVal,
+                                        BlockedLogsCommon   * blockedlogs,
+                                        int                   n,
+                                        bool                  useVs)
+//------------------------------------------------------------------------------
+{
+  const std::vector<double> & vp     = blockedlogs->GetVpBlocked();
+  const std::vector<double> & bg_vp  = blockedlogs->GetVpHighCutBackground();
+  const std::vector<double> & vs     = blockedlogs->GetVsBlocked();
+  const std::vector<double> & bg_vs  = blockedlogs->GetVsHighCutBackground();
+  const std::vector<double> & rho    = blockedlogs->GetRhoBlocked();
+  const std::vector<double> & bg_rho = blockedlogs->GetRhoHighCutBackground();
 
   std::vector<double> vpFiltered(n);
   std::vector<double> vsFiltered(n);
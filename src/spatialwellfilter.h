@@ -30,11 +30,11 @@ public:
 
 protected:
 
-  void doVpRhoFiltering(std::vector<NRLib::Matrix>      & sigmaeVpRho,
-                        double                         ** sigmapri,
+  void doVpRhoFiltering(double                         ** sigmapri,
                         double                         ** sigmapost,
                         const int                         n,
-                        BlockedLogsCommon               * blockedLogs);
+                        BlockedLogsCommon               * blockedLogs,
+                        NRLib::Matrix                   & sigmaeW);
 
   void completeSigmaE(std::vector<NRLib::Matrix>        & sigmae,
                       int                                 lastn,
@@ -47,10 +47,8 @@ protected:
                     int                                   n);
 
   void updateSigmaEVpRho(std::vector<NRLib::Matrix>     & sigmaeVpRho,
-                         const NRLib::Matrix            & Aw,
-                         const NRLib::Matrix            & Spost,
-                         int                              nDim,
-                         int                              n);
+                         const NRLib::Matrix            & sigmaeW,
+                         int                              nDim);
 
   void completeSigmaEVpRho(std::vector<NRLib::Matrix>   & sigmaeVpRho,
                            int                            lastn,
@@ -64,10 +62,25 @@ protected:
 
   void adjustDiagSigma(NRLib::Matrix                    & sigmae);
 
-  void calculateFilteredLogs(const NRLib::Matrix        & Aw,
-                             BlockedLogsCommon          * blockedlogs,
-                             int                          n,
-                             bool                         useVs);
+  // Filters the logs of one well with Aw = I - Spost*inv(Sprior), and returns the
+  // sums over the block diagonals of Aw*Spost in the lower triangle of sigmaeW.
+  // Sprior is overwritten by its Cholesky factor.
+  void filterWell(NRLib::SymmetricMatrix             & Sprior,
+                  const NRLib::SymmetricMatrix       & Spost,
+                  BlockedLogsCommon                  * blockedlogs,
+                  int                                  n,
+                  bool                                 useVs,
+                  NRLib::Matrix                      & sigmaeW);
+
+  void makeResiduals(BlockedLogsCommon                * blockedlogs,
+                     int                                n,
+                     bool                               useVs,
+                     NRLib::Vector                    & residuals);
+
+  void setFilteredLogs(const NRLib::Vector            & filteredVal,
+                       BlockedLogsCommon              * blockedlogs,
+                       int                              n,
+                       bool                             useVs);
 
   void MakeInterpolatedResiduals(const std::vector<double>  & bwLog,
                                  const std::vector<double>  & bwLogBG,
@@ -12,6 +12,14 @@
 
 std::vector<std::string> TaskList::task_(0);
 
+void TaskList::addTask(std::string task)
+{
+#ifdef PARALLEL
+#pragma omp critical(task_list)
+#endif
+  task_.push_back(task);
+}
+
 void TaskList::viewAllTasks(bool useFile)
 {
   size_t i;
@@ -142,8 +142,13 @@ void
 Timings::addTimeResamplingSeismic(double& wall, double& cpu)
 {
   TimeKit::getTime(wall,cpu);
-  w_resamplingSeismic_ += wall; // Sum times used to resample each cube
-  c_resamplingSeismic_ += cpu;
+#ifdef PARALLEL
+#pragma omp critical(timings)
+#endif
+  {
+    w_resamplingSeismic_ += wall; // Sum times used to resample each cube
+    c_resamplingSeismic_ += cpu;
+  }
 }
 
 void
@@ -182,24 +187,39 @@ void
 Timings::addTimeStochasticModel(double& wall, double& cpu)
 {
   TimeKit::getTime(wall,cpu);
-  w_stochasticModel_ += wall;
-  c_stochasticModel_ += cpu;
+#ifdef PARALLEL
+#pragma omp critical(timings)
+#endif
+  {
+    w_stochasticModel_ += wall;
+    c_stochasticModel_ += cpu;
+  }
 }
 
 void
 Timings::addTimeInversion(double& wall, double& cpu)
 {
   TimeKit::getTime(wall,cpu);
-  w_inversion_ += wall;
-  c_inversion_ += cpu;
+#ifdef PARALLEL
+#pragma omp critical(timings)
+#endif
+  {
+    w_inversion_ += wall;
+    c_inversion_ += cpu;
+  }
 }
 
 void
 Timings::addTimeSimulation(double& wall, double& cpu)
 {
   TimeKit::getTime(wall,cpu);
-  w_simulation_ += wall;
-  c_simulation_ += cpu;
+#ifdef PARALLEL
+#pragma omp critical(timings)
+#endif
+  {
+    w_simulation_ += wall;
+    c_simulation_ += cpu;
+  }
 }
 
 void
@@ -230,8 +250,13 @@ void
 Timings::addToTimeKrigingSim(double& wall, double& cpu)
 {
   TimeKit::getTime(wall,cpu);
-  w_kriging_sim_ += wall;
-  c_kriging_sim_ += cpu;
+#ifdef PARALLEL
+#pragma omp critical(timings)
+#endif
+  {
+    w_kriging_sim_ += wall;
+    c_kriging_sim_ += cpu;
+  }
 }
 
 void
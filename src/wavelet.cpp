@@ -259,11 +259,17 @@ void Wavelet::fft1DInPlace()
     int flag;
     rfftwnd_plan plan;
     flag    = FFTW_ESTIMATE | FFTW_IN_PLACE;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     plan    = rfftwnd_create_plan(1, &nzp_ ,FFTW_REAL_TO_COMPLEX,flag);
     //
     // NBNB-PAL: The call rfftwnd_on_real_to_complex is causing UMRs in Purify.
     //
     rfftwnd_one_real_to_complex(plan,rAmp_,cAmp_);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     fftwnd_destroy_plan(plan);
     isReal_ = false;
   }
@@ -278,8 +284,14 @@ void Wavelet::invFFT1DInPlace()
     rfftwnd_plan plan;
 
     flag = FFTW_ESTIMATE | FFTW_IN_PLACE;
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     plan= rfftwnd_create_plan(1,&nzp_,FFTW_COMPLEX_TO_REAL,flag);
     rfftwnd_one_complex_to_real(plan,cAmp_,rAmp_);
+#ifdef PARALLEL
+#pragma omp critical(fftw_planner)
+#endif
     fftwnd_destroy_plan(plan);
     isReal_=true;
     double scale= static_cast<double>(1.0/static_cast<double>(nzp_));
@@ -5731,11 +5731,14 @@ XmlModelFile::parseAdvancedSettings(TiXmlNode * node, std::string & errTxt)
   std::vector<std::string> legalCommands;
 #ifdef PARALLEL
   legalCommands.push_back("number-of-threads");
+  legalCommands.push_back("number-of-parallel-intervals");
 #endif
   legalCommands.push_back("fft-grid-padding");
   legalCommands.push_back("vp-vs-ratio");
   legalCommands.push_back("vp-vs-ratio-from-wells");
   legalCommands.push_back("use-intermediate-disk-storage");
+  legalCommands.push_back("compress-intermediate-disk-storage");
+  legalCommands.push_back("intermediate-disk-storage-max-relative-error");
   legalCommands.push_back("maximum-relative-thickness-difference");
   legalCommands.push_back("frequency-band");
   legalCommands.push_back("energy-threshold");
@@ -5756,11 +5759,21 @@ XmlModelFile::parseAdvancedSettings(TiXmlNode * node, std::string & errTxt)
   legalCommands.push_back("gradient-smoothing-range");
   legalCommands.push_back("estimate-well-gradient-from-seismic");
   legalCommands.push_back("write-ascii-surfaces");
+  legalCommands.push_back("fft-wisdom-file");
+  legalCommands.push_back("use-segy-trace-index");
 
 #ifdef PARALLEL
   int n_thread = 0;
   if (parseValue(root, "number-of-threads", n_thread, errTxt) == true)
     modelSettings_->setNumberOfThreads(n_thread);
+
+  int n_parallel_intervals = 1;
+  if (parseValue(root, "number-of-parallel-intervals", n_parallel_intervals, errTxt) == true) {
+    if (n_parallel_intervals < 1)
+      errTxt += "Error in <number-of-parallel-intervals>: Value must be at least 1, found "+NRLib::ToString(n_parallel_intervals)+".\n";
+    else
+      modelSettings_->setNumberOfParallelIntervals(n_parallel_intervals);
+  }
 #endif
 
   parseFFTGridPadding(root, errTxt);
@@ -5782,6 +5795,18 @@ XmlModelFile::parseAdvancedSettings(TiXmlNode * node, std::string & errTxt)
   if(parseBool(root, "use-intermediate-disk-storage", fileGrid, errTxt) == true)
     modelSettings_->setFileGrid(fileGrid);
 
+  bool compress;
+  if(parseBool(root, "compress-intermediate-disk-storage", compress, errTxt) == true)
+    modelSettings_->setCompressTmpGrids(compress);
+
+  float max_error;
+  if(parseValue(root, "intermediate-disk-storage-max-relative-error", max_error, errTxt) == true) {
+    if(max_error != 0.0f && (max_error < 1.0e-6f || max_error > 0.01f))
+      errTxt += "Error in <intermediate-disk-storage-max-relative-error>: Value must be 0 or between 1e-6 and 0.01, found "+NRLib::ToString(max_error)+".\n";
+    else
+      modelSettings_->setTmpGridMaxRelError(max_error);
+  }
+
   double limit;
   if(parseValue(root,"maximum-relative-thickness-difference", limit, errTxt) == true)
     modelSettings_->setLzLimit(limit);
@@ -5866,6 +5891,14 @@ XmlModelFile::parseAdvancedSettings(TiXmlNode * node, std::string & errTxt)
   if(parseBool(root, "write-ascii-surfaces", ascii_surfaces, errTxt) == true)
     modelSettings_->setWriteAsciiSurfaces(ascii_surfaces);
 
+  std::string wisdom_file;
+  if(parseValue(root, "fft-wisdom-file", wisdom_file, errTxt) == true)
+    modelSettings_->setFFTWisdomFile(wisdom_file);
+
+  bool segy_index = false;
+  if(parseBool(root, "use-segy-trace-index", segy_index, errTxt) == true)
+    modelSettings_->setUseSegyTraceIndex(segy_index);
+
   checkForJunk(root, errTxt, legalCommands);
   return(true);
 }
@@ -6426,6 +6459,7 @@ XmlModelFile::checkConsistency(std::string & errTxt)
       n_threads  = std::min(n_threads, n_processors);
     }
     modelSettings_->setNumberOfThreads(n_threads);
+    modelSettings_->setNumberOfParallelIntervals(std::min(modelSettings_->getNumberOfParallelIntervals(), n_threads));
   }
 #endif
 }